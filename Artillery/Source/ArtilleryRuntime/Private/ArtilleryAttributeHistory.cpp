@@ -0,0 +1,156 @@
+#include "ArtilleryAttributeHistory.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Algo/BinarySearch.h"
+
+static int32 GArtilleryAttributesKeyframeInterval = 32;
+static FAutoConsoleVariableRef CVarArtilleryAttributesKeyframeInterval(
+	TEXT("artillery.Attributes.KeyframeInterval"),
+	GArtilleryAttributesKeyframeInterval,
+	TEXT("How many attribute commits between full keyframes. Lower is faster to reconstruct from and costs more memory. Clamped to 4..128."));
+
+void FArtilleryAttributeHistory::BeginCommit(uint64 Tick)
+{
+	++Commits;
+	FDeltaSlot& Slot = Slots[Commits % DeltaSlots];
+	Slot.Commit = Commits;
+	Slot.Tick = Tick;
+	//keeps the allocation, which after a few laps is about as big as a busy tick needs.
+	Slot.Deltas.Reset();
+}
+
+void FArtilleryAttributeHistory::AddDelta(uint32 Row, uint32 Generation, uint8 Attrib, EAttributeValue Which, float Value)
+{
+	FDelta& Delta = Slots[Commits % DeltaSlots].Deltas.AddDefaulted_GetRef();
+	Delta.Row = Row;
+	Delta.Generation = Generation;
+	Delta.Attrib = Attrib;
+	Delta.Which = Which;
+	Delta.Value = Value;
+}
+
+bool FArtilleryAttributeHistory::WantsKeyframe() const
+{
+	const uint64 Interval = FMath::Clamp<uint64>(GArtilleryAttributesKeyframeInterval, MinKeyframeInterval, WindowTicks);
+	return LastKeyframeCommit == 0 || Commits - LastKeyframeCommit >= Interval;
+}
+
+void FArtilleryAttributeHistory::BeginKeyframe()
+{
+	FKeyframe& Keyframe = Keyframes[NextKeyframe];
+	NextKeyframe = (NextKeyframe + 1) % KeyframeSlots;
+	Keyframe.Commit = Commits;
+	Keyframe.Tick = Slots[Commits % DeltaSlots].Tick;
+	Keyframe.bValid = true;
+	Keyframe.Rows.Reset();
+	Keyframe.Values.Reset();
+	LastKeyframeCommit = Commits;
+}
+
+void FArtilleryAttributeHistory::AddKeyframeRow(uint32 Row, uint32 Generation, uint32 Present, TConstArrayView<float> Values)
+{
+	FKeyframe& Keyframe = Keyframes[(NextKeyframe + KeyframeSlots - 1) % KeyframeSlots];
+	FKeyframeRow& Entry = Keyframe.Rows.AddDefaulted_GetRef();
+	Entry.Row = Row;
+	Entry.Generation = Generation;
+	Entry.Present = Present;
+	Entry.FirstValue = Keyframe.Values.Num();
+	Keyframe.Values.Append(Values.GetData(), Values.Num());
+}
+
+bool FArtilleryAttributeHistory::StillHasDeltasAfter(uint64 Commit) const
+{
+	//the slot after Commit mustn't have been lapped.
+	return Commit + DeltaSlots > Commits;
+}
+
+const FArtilleryAttributeHistory::FKeyframe* FArtilleryAttributeHistory::NewestKeyframeAtOrBefore(uint64 Tick) const
+{
+	const FKeyframe* Best = nullptr;
+	for (const FKeyframe& Keyframe : Keyframes)
+	{
+		if (Keyframe.bValid && Keyframe.Tick <= Tick && StillHasDeltasAfter(Keyframe.Commit)
+			&& (!Best || Keyframe.Commit > Best->Commit))
+		{
+			Best = &Keyframe;
+		}
+	}
+	return Best;
+}
+
+bool FArtilleryAttributeHistory::Reconstruct(uint32 Row, uint32 Generation, uint8 Attrib, EAttributeValue Which,
+                                             uint64 Tick, float& Out) const
+{
+	const FKeyframe* Keyframe = NewestKeyframeAtOrBefore(Tick);
+	if (!Keyframe)
+	{
+		return false;
+	}
+
+	bool bFound = false;
+	const int32 RowIndex = Algo::LowerBoundBy(Keyframe->Rows, Row, &FKeyframeRow::Row);
+	if (Keyframe->Rows.IsValidIndex(RowIndex))
+	{
+		const FKeyframeRow& Entry = Keyframe->Rows[RowIndex];
+		const uint32 Bit = 1u << Attrib;
+		if (Entry.Row == Row && Entry.Generation == Generation && (Entry.Present & Bit))
+		{
+			const int32 Before = FMath::CountBits(Entry.Present & (Bit - 1));
+			Out = Keyframe->Values[Entry.FirstValue + Before * NUM_ATTRIBUTE_VALUES + static_cast<int32>(Which)];
+			bFound = true;
+		}
+	}
+
+	//then forward through every commit after the keyframe, up to and including Tick. the last one to touch it wins.
+	for (uint64 Commit = Keyframe->Commit + 1; Commit <= Commits; ++Commit)
+	{
+		const FDeltaSlot& Slot = Slots[Commit % DeltaSlots];
+		if (Slot.Tick > Tick)
+		{
+			break;
+		}
+		int32 Index = Algo::LowerBoundBy(Slot.Deltas, Row, &FDelta::Row);
+		for (; Index < Slot.Deltas.Num() && Slot.Deltas[Index].Row == Row; ++Index)
+		{
+			const FDelta& Delta = Slot.Deltas[Index];
+			if (Delta.Generation == Generation && Delta.Attrib == Attrib && Delta.Which == Which)
+			{
+				Out = Delta.Value;
+				bFound = true;
+			}
+		}
+	}
+	return bFound;
+}
+
+FArtilleryAttributeHistoryStats FArtilleryAttributeHistory::GetStats() const
+{
+	FArtilleryAttributeHistoryStats Stats;
+	Stats.Commits = Commits;
+	Stats.NewestTick = Commits ? Slots[Commits % DeltaSlots].Tick : 0;
+	Stats.DeltasLastCommit = Commits ? Slots[Commits % DeltaSlots].Deltas.Num() : 0;
+	uint64 OldestCommit = ~0ull;
+	for (const FKeyframe& Keyframe : Keyframes)
+	{
+		Stats.Bytes += Keyframe.Rows.GetAllocatedSize() + Keyframe.Values.GetAllocatedSize();
+		if (Keyframe.bValid && StillHasDeltasAfter(Keyframe.Commit))
+		{
+			++Stats.Keyframes;
+			Stats.KeyframeRows += Keyframe.Rows.Num();
+			if (Keyframe.Commit < OldestCommit)
+			{
+				OldestCommit = Keyframe.Commit;
+				Stats.OldestTick = Keyframe.Tick;
+			}
+		}
+	}
+	for (const FDeltaSlot& Slot : Slots)
+	{
+		Stats.Bytes += Slot.Deltas.GetAllocatedSize();
+		if (Slot.Commit && Slot.Commit + WindowTicks > Commits)
+		{
+			Stats.DeltasInWindow += Slot.Deltas.Num();
+		}
+	}
+	return Stats;
+}
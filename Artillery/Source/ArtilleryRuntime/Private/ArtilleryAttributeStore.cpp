@@ -0,0 +1,351 @@
+#include "ArtilleryAttributeStore.h"
+
+FArtilleryAttributeStore::FPage::FPage()
+{
+	FMemory::Memzero(Current);
+	FMemory::Memzero(Base);
+	FMemory::Memzero(Remote);
+	for (uint32 Index = 0; Index < PageSize; ++Index)
+	{
+		for (int32 Which = 0; Which < NUM_ATTRIBUTE_VALUES; ++Which)
+		{
+			Dirty[Which][Index].store(0, std::memory_order_relaxed);
+		}
+		Present[Index].store(0, std::memory_order_relaxed);
+		Generation[Index].store(0, std::memory_order_relaxed);
+		State[Index].store(Free, std::memory_order_relaxed);
+	}
+}
+
+FArtilleryAttributeStore::FArtilleryAttributeStore()
+{
+}
+
+FArtilleryAttributeStore::~FArtilleryAttributeStore()
+{
+	for (std::atomic<FPage*>& Page : Pages)
+	{
+		delete Page.exchange(nullptr);
+	}
+}
+
+FArtilleryAttributeStore::FPage* FArtilleryAttributeStore::EnsurePage(uint32 Row)
+{
+	std::atomic<FPage*>& PageRef = Pages[Row / PageSize];
+	FPage* Page = PageRef.load(std::memory_order_acquire);
+	if (!Page)
+	{
+		FPage* Fresh = new FPage();
+		if (PageRef.compare_exchange_strong(Page, Fresh, std::memory_order_acq_rel))
+		{
+			Page = Fresh;
+		}
+		else
+		{
+			//someone beat us to it, and Page now holds theirs.
+			delete Fresh;
+		}
+	}
+	return Page;
+}
+
+uint32 FArtilleryAttributeStore::Claim(FSkeletonKey Owner)
+{
+	//the hint can race past a row that was freed at the same time, so if the top end is full, look below it too.
+	const uint32 Hint = FMath::Min(FirstMaybeFree.load(std::memory_order_relaxed), PageSize * MaxPages);
+	//every row's been handed out and nothing's been given back since, so the walk below would visit all of them,
+	//and make every page that's missing, just to find nothing.
+	if (Hint == PageSize * MaxPages && HighWater.load(std::memory_order_relaxed) >= PageSize * MaxPages)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Artillery:Attributes: out of attribute rows. All %u are claimed."), PageSize * MaxPages);
+		return InvalidRow;
+	}
+	for (uint32 Step = 0; Step < PageSize * MaxPages; ++Step)
+	{
+		const uint32 Row = (Hint + Step) % (PageSize * MaxPages);
+		FPage* Page = EnsurePage(Row);
+		const uint32 InPage = Row % PageSize;
+		uint8 Expected = Free;
+		if (Page->State[InPage].compare_exchange_strong(Expected, Claimed, std::memory_order_acquire))
+		{
+			FirstMaybeFree.store(Row + 1, std::memory_order_relaxed);
+			uint32 High = HighWater.load(std::memory_order_relaxed);
+			while (High <= Row && !HighWater.compare_exchange_weak(High, Row + 1, std::memory_order_relaxed))
+			{
+			}
+			Page->Owner[InPage] = Owner;
+			for (int32 Attrib = 0; Attrib < MaxAttribs; ++Attrib)
+			{
+				Page->Current[Attrib][InPage] = 0;
+				Page->Base[Attrib][InPage] = 0;
+				Page->Remote[Attrib][InPage] = 0;
+			}
+			return Row;
+		}
+	}
+	UE_LOG(LogTemp, Error, TEXT("Artillery:Attributes: out of attribute rows."));
+	return InvalidRow;
+}
+
+void FArtilleryAttributeStore::Init(uint32 Row, uint8 Attrib, float Value)
+{
+	FPage* Page = PageOf(Row);
+	if (!Page || Attrib >= MaxAttribs)
+	{
+		return;
+	}
+	const uint32 InPage = Row % PageSize;
+	Page->Base[Attrib][InPage] = Value;
+	Page->Current[Attrib][InPage] = Value;
+	Page->Present[InPage].fetch_or(1u << Attrib, std::memory_order_relaxed);
+	//so the first commit after it goes live records where it started.
+	for (int32 Which = 0; Which < NUM_ATTRIBUTE_VALUES; ++Which)
+	{
+		Page->Dirty[Which][InPage].fetch_or(1u << Attrib, std::memory_order_release);
+	}
+}
+
+void FArtilleryAttributeStore::Bind(FSkeletonKey Owner, uint32 Row)
+{
+	FPage* Page = PageOf(Row);
+	if (!Page)
+	{
+		return;
+	}
+	//live before it's findable, so anyone who finds it gets a live row.
+	Page->State[Row % PageSize].store(Live, std::memory_order_release);
+	LiveCount.fetch_add(1, std::memory_order_relaxed);
+	uint32 Replaced = InvalidRow;
+	KeyToRow.upsert(Owner, [Row, &Replaced](uint32& Existing)
+	{
+		Replaced = Existing;
+		Existing = Row;
+	}, Row);
+	//registering twice used to replace the whole map, and leave the old one to whoever still held it.
+	if (Replaced != InvalidRow && Replaced != Row)
+	{
+		Release(Replaced);
+	}
+}
+
+bool FArtilleryAttributeStore::Deregister(FSkeletonKey Owner)
+{
+	uint32 Row = InvalidRow;
+	//only one deregister gets the row, so only one releases it.
+	KeyToRow.erase_fn(Owner, [&Row](uint32& Found)
+	{
+		Row = Found;
+		return true;
+	});
+	if (Row == InvalidRow)
+	{
+		return false;
+	}
+	Release(Row);
+	return true;
+}
+
+void FArtilleryAttributeStore::Release(uint32 Row)
+{
+	FPage* Page = PageOf(Row);
+	if (!Page)
+	{
+		return;
+	}
+	const uint32 InPage = Row % PageSize;
+	//generation goes first, so every handle to the row is stale before the row can be claimed again.
+	Page->Generation[InPage].fetch_add(1, std::memory_order_acq_rel);
+	Page->Present[InPage].store(0, std::memory_order_relaxed);
+	for (int32 Which = 0; Which < NUM_ATTRIBUTE_VALUES; ++Which)
+	{
+		Page->Dirty[Which][InPage].store(0, std::memory_order_relaxed);
+	}
+	Page->State[InPage].store(Free, std::memory_order_release);
+	LiveCount.fetch_sub(1, std::memory_order_relaxed);
+	uint32 Hint = FirstMaybeFree.load(std::memory_order_relaxed);
+	while (Row < Hint && !FirstMaybeFree.compare_exchange_weak(Hint, Row, std::memory_order_relaxed))
+	{
+	}
+}
+
+void FArtilleryAttributeStore::Commit(uint64 InTick)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Artillery:Attributes:Commit");
+	Tick.store(InTick, std::memory_order_relaxed);
+	History.BeginCommit(InTick);
+	const bool bKeyframe = History.WantsKeyframe();
+	const uint32 End = HighWater.load(std::memory_order_acquire);
+
+	//rows in order, so each commit's deltas come out sorted by row for free.
+	for (uint32 Row = 0; Row < End; ++Row)
+	{
+		FPage* Page = PageOf(Row);
+		if (!Page)
+		{
+			Row += PageSize - 1 - Row % PageSize;
+			continue;
+		}
+		const uint32 InPage = Row % PageSize;
+		//claimed but not bound yet keeps its bits, and gets them recorded once it's live.
+		if (Page->State[InPage].load(std::memory_order_acquire) != Live)
+		{
+			continue;
+		}
+		const uint32 Generation = Page->Generation[InPage].load(std::memory_order_acquire);
+		for (int32 Which = 0; Which < NUM_ATTRIBUTE_VALUES; ++Which)
+		{
+			//anything written after the exchange sets the bit again, and goes in next commit.
+			uint32 Bits = Page->Dirty[Which][InPage].exchange(0, std::memory_order_acquire);
+			while (Bits)
+			{
+				const uint8 Attrib = static_cast<uint8>(FMath::CountTrailingZeros(Bits));
+				Bits &= Bits - 1;
+				const EAttributeValue Value = static_cast<EAttributeValue>(Which);
+				History.AddDelta(Row, Generation, Attrib, Value, Page->Column(Value, Attrib, InPage));
+			}
+		}
+	}
+
+	if (bKeyframe)
+	{
+		History.BeginKeyframe();
+		TArray<float, TInlineAllocator<MaxAttribs * NUM_ATTRIBUTE_VALUES>> Values;
+		for (uint32 Row = 0; Row < End; ++Row)
+		{
+			FPage* Page = PageOf(Row);
+			if (!Page)
+			{
+				Row += PageSize - 1 - Row % PageSize;
+				continue;
+			}
+			const uint32 InPage = Row % PageSize;
+			if (Page->State[InPage].load(std::memory_order_acquire) != Live)
+			{
+				continue;
+			}
+			const uint32 Present = Page->Present[InPage].load(std::memory_order_acquire);
+			Values.Reset();
+			for (uint32 Bits = Present; Bits; Bits &= Bits - 1)
+			{
+				const uint8 Attrib = static_cast<uint8>(FMath::CountTrailingZeros(Bits));
+				Values.Add(Page->Current[Attrib][InPage]);
+				Values.Add(Page->Base[Attrib][InPage]);
+				Values.Add(Page->Remote[Attrib][InPage]);
+			}
+			History.AddKeyframeRow(Row, Page->Generation[InPage].load(std::memory_order_acquire), Present, Values);
+		}
+	}
+}
+
+bool FArtilleryAttributeStore::ValueAt(FSkeletonKey Owner, uint8 Attrib, EAttributeValue Which, uint64 AtTick,
+                                       float& Out) const
+{
+	const uint32 Row = FindRow(Owner);
+	const FPage* Page = PageOf(Row);
+	if (!Page || Attrib >= MaxAttribs)
+	{
+		return false;
+	}
+	const uint32 Generation = Page->Generation[Row % PageSize].load(std::memory_order_acquire);
+	return History.Reconstruct(Row, Generation, Attrib, Which, AtTick, Out);
+}
+
+bool FArtilleryAttributeStore::SwapBits(float& Value, int32 From, int32 To)
+{
+	return FPlatformAtomics::InterlockedCompareExchange(reinterpret_cast<int32*>(&Value), To, From) == From;
+}
+
+void FArtilleryAttributeStore::BeginReplay()
+{
+	Replaying.Reset();
+	bReplaying = true;
+}
+
+void FArtilleryAttributeStore::ReplayTick(uint64 AtTick)
+{
+	if (!bReplaying || AtTick == 0)
+	{
+		return;
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Artillery:Attributes:ReplayTick");
+	//the first replayed tick is where we find out what's live. rows that come along mid replay are the replay's own.
+	if (Replaying.Num() == 0)
+	{
+		const uint32 End = HighWater.load(std::memory_order_acquire);
+		for (uint32 Row = 0; Row < End; ++Row)
+		{
+			FPage* Page = PageOf(Row);
+			if (!Page)
+			{
+				Row += PageSize - 1 - Row % PageSize;
+				continue;
+			}
+			const uint32 InPage = Row % PageSize;
+			if (Page->State[InPage].load(std::memory_order_acquire) != Live)
+			{
+				continue;
+			}
+			const uint32 Generation = Page->Generation[InPage].load(std::memory_order_acquire);
+			for (uint32 Bits = Page->Present[InPage].load(std::memory_order_acquire); Bits; Bits &= Bits - 1)
+			{
+				FReplayed& Entry = Replaying.AddDefaulted_GetRef();
+				Entry.Row = Row;
+				Entry.Generation = Generation;
+				Entry.Attrib = static_cast<uint8>(FMath::CountTrailingZeros(Bits));
+				Entry.Live = FPlatformAtomics::AtomicRead(reinterpret_cast<int32*>(&Page->Current[Entry.Attrib][InPage]));
+				Entry.Replayed = Entry.Live;
+			}
+		}
+	}
+
+	for (FReplayed& Entry : Replaying)
+	{
+		FPage* Page = PageOf(Entry.Row);
+		const uint32 InPage = Entry.Row % PageSize;
+		if (Entry.bWritten || Page->Generation[InPage].load(std::memory_order_acquire) != Entry.Generation)
+		{
+			continue;
+		}
+		float Then;
+		if (!History.Reconstruct(Entry.Row, Entry.Generation, Entry.Attrib, EAttributeValue::Current, AtTick - 1, Then))
+		{
+			continue;
+		}
+		int32 ThenBits;
+		FMemory::Memcpy(&ThenBits, &Then, sizeof(ThenBits));
+		if (SwapBits(Page->Current[Entry.Attrib][InPage], Entry.Replayed, ThenBits))
+		{
+			Entry.Replayed = ThenBits;
+		}
+		else
+		{
+			Entry.bWritten = true;
+		}
+	}
+}
+
+void FArtilleryAttributeStore::EndReplay()
+{
+	for (const FReplayed& Entry : Replaying)
+	{
+		FPage* Page = PageOf(Entry.Row);
+		const uint32 InPage = Entry.Row % PageSize;
+		if (!Entry.bWritten && Page->Generation[InPage].load(std::memory_order_acquire) == Entry.Generation)
+		{
+			//if something wrote it since the last replayed tick, that write stands.
+			SwapBits(Page->Current[Entry.Attrib][InPage], Entry.Replayed, Entry.Live);
+		}
+	}
+	Replaying.Reset();
+	bReplaying = false;
+}
+
+uint32 FArtilleryAttributeStore::PagesInUse() const
+{
+	uint32 InUse = 0;
+	for (const std::atomic<FPage*>& Page : Pages)
+	{
+		InUse += Page.load(std::memory_order_relaxed) ? 1 : 0;
+	}
+	return InUse;
+}
@@ -9,16 +9,82 @@
 #include "FTProjectileFinalTickResolver.h"
 #include "ModularGameplayTags.h"
 #include "NiagaraParticleDispatch.h"
+#include "ArtilleryProjectileDispatch.h"
 #include "StaticAssetLoader.h"
 #include "Threads/FArtilleryStateTreesThread.h"
 #include "Threads/FArtilleryTicklitesThread.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommand GArtilleryTickliteCadenceLoad(
+	TEXT("artillery.Ticklites.CadenceLoad"),
+	TEXT("Logs how many ticklites are live and how many ran last tick, per cadence."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (!UArtilleryDispatch::SelfPtr)
+		{
+			return;
+		}
+		static const TCHAR* Names[FTickliteLanes::CadenceCount] = {TEXT("Critical"), TEXT("Tick"), TEXT("Lite"), TEXT("Slow")};
+		const FTickliteCadenceLoad Load = UArtilleryDispatch::SelfPtr->GetTickliteCadenceLoad();
+		for (int32 CadenceIndex = 0; CadenceIndex < FTickliteLanes::CadenceCount; ++CadenceIndex)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Artillery: ticklites %-8s live %6d  ran %6d  busiest lane %6d"),
+				Names[CadenceIndex], Load.Live[CadenceIndex], Load.Ran[CadenceIndex], Load.BusiestLane[CadenceIndex]);
+		}
+	}));
+
+static FAutoConsoleCommand GArtilleryAttributesReport(
+	TEXT("artillery.Attributes.Report"),
+	TEXT("Logs how many entities hold attributes, how many pages of the attribute store that takes, and how busy its history is."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (!UArtilleryDispatch::SelfPtr)
+		{
+			return;
+		}
+		TSharedPtr<FArtilleryAttributeStore> Store = UArtilleryDispatch::SelfPtr->GetAttributeStore();
+		if (Store)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Artillery: attributes for %d entities in %u pages of %u."),
+				Store->Num(), Store->PagesInUse(), FArtilleryAttributeStore::MaxPages);
+			//history isn't safe to read off the busy worker, but this is only counting, and only a debug command.
+			const FArtilleryAttributeHistoryStats Stats = Store->GetHistoryStats();
+			UE_LOG(LogTemp, Display, TEXT("Artillery: attribute history covers ticks %llu to %llu over %llu commits. %d deltas last commit, %d in the window, %d keyframes of %d rows, %llu KB."),
+				Stats.OldestTick, Stats.NewestTick, Stats.Commits, Stats.DeltasLastCommit, Stats.DeltasInWindow,
+				Stats.Keyframes, Stats.KeyframeRows, static_cast<uint64>(Stats.Bytes / 1024));
+		}
+	}));
+
+static FAutoConsoleCommand GArtilleryPacerReport(
+	TEXT("artillery.Pacer.Report"),
+	TEXT("Logs the busy worker's tick jitter histogram, and how many slots it has caught up on or skipped."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (!UArtilleryDispatch::SelfPtr)
+		{
+			return;
+		}
+		const FArtilleryPacerStats Stats = UArtilleryDispatch::SelfPtr->GetTickPacerStats();
+		UE_LOG(LogTemp, Display, TEXT("Artillery: pacer on %s. %llu slots, %llu caught up, %llu skipped, worst %lluus late."),
+			Stats.Primitive, Stats.Slots, Stats.CaughtUp, Stats.Skipped, Stats.MaxLateMicros);
+		for (int32 Bucket = 0; Bucket < FArtilleryPacerStats::Buckets; ++Bucket)
+		{
+			if (Stats.Late[Bucket])
+			{
+				const uint64 Below = 1ull << Bucket;
+				UE_LOG(LogTemp, Display, TEXT("Artillery: pacer  %s%6lluus late  %10llu"),
+					Bucket == FArtilleryPacerStats::Buckets - 1 ? TEXT(">=") : TEXT(" <"),
+					Bucket == FArtilleryPacerStats::Buckets - 1 ? Below >> 1 : Below, Stats.Late[Bucket]);
+			}
+		}
+	}));
 
 bool UArtilleryDispatch::RegistrationImplementation()
 {
 	
 	GameplayTagContainerToDataMapping->Empty();//it's oddly safest to do this here. isn't that fun?
 	UE_LOG(LogTemp, Warning, TEXT("ArtilleryDispatch:Subsystem: Online"));
-	AttributeSetToDataMapping = MakeShareable(new AttrCuckoo());
+	AttributeStore = MakeShareable(new FArtilleryAttributeStore());
 	RequestRouter = MakeShareable(new F_INeedA());
 	TL_ThreadedImpl::ADispatch = &ArtilleryTicklitesWorker_LockstepToWorldSim;
 	UBarrageDispatch* PhysicsECS = GetWorld()->GetSubsystem<UBarrageDispatch>();
@@ -72,26 +138,26 @@ bool UArtilleryDispatch::RegistrationImplementation()
 void UArtilleryDispatch::REGISTER_ENTITY_FINAL_TICK_RESOLVER(const ActorKey& Self)
 {
 	TLEntityFinalTickResolver temp = TLEntityFinalTickResolver(Self); //this semantic sucks. gotta fix it.
-	this->RequestAddTicklite(MakeShareable(new EntityFinalTickResolver(temp)), FINAL_TICK_RESOLVE);
+	this->RequestAddPooledTicklite(EntityFinalTickResolver(temp), FINAL_TICK_RESOLVE);
 }
 
 void UArtilleryDispatch::REGISTER_PROJECTILE_FINAL_TICK_RESOLVER(uint32 MaximumLifespanInTicks,
                                                                  const FSkeletonKey& Self)
 {
 	TLProjectileFinalTickResolver temp = TLProjectileFinalTickResolver(MaximumLifespanInTicks, Self);
-	this->RequestAddTicklite(MakeShareable(new ProjectileFinalTickResolver(temp)), FINAL_TICK_RESOLVE);
+	this->RequestAddPooledTicklite(ProjectileFinalTickResolver(temp), FINAL_TICK_RESOLVE);
 }
 
 void UArtilleryDispatch::REGISTER_GUN_FINAL_TICK_RESOLVER(const FGunKey& Self, const FArtilleryGun* ExistCheck)
 {
 	TLGunFinalTickResolver temp = TLGunFinalTickResolver(Self, ExistCheck); //this semantic sucks. gotta fix it.
-	this->RequestAddTicklite(MakeShareable(new GunFinalTickResolver(temp)), FINAL_TICK_RESOLVE);
+	this->RequestAddPooledTicklite(GunFinalTickResolver(temp), FINAL_TICK_RESOLVE);
 }
 
 void UArtilleryDispatch::INITIATE_JUMP_TIMER(const FSkeletonKey& Self)
 {
 	FTJumpTimer JumpTimer = FTJumpTimer(Self);
-	this->RequestAddTicklite(MakeShareable(new TL_JumpTimer(JumpTimer)), Normal);
+	this->RequestAddPooledTicklite(TL_JumpTimer(JumpTimer), Normal);
 }
 
 //legit, it can't. ffs. you can get sliced ANYWHERE in here and lose your reffed memory.
@@ -170,7 +236,7 @@ void UArtilleryDispatch::Deinitialize()
 		WorldSim_Thread->Kill(true);
 		WorldSim_Thread.Reset();
 	}
-	AttributeSetToDataMapping = nullptr;
+	AttributeStore = nullptr;
 	IdentSetToDataMapping->Empty();
 	KeyToControlliteMapping->Empty();
 	VectorSetToDataMapping->Empty();
@@ -182,9 +248,7 @@ void UArtilleryDispatch::Deinitialize()
 AttrMapPtr UArtilleryDispatch::GetAttribSetShadowByObjectKey(const FSkeletonKey& Target,
                                                              ArtilleryTime Now) const
 {
-	AttrMapPtr In;
-	AttributeSetToDataMapping->find(Target, In);
-	return In ? In : nullptr;
+	return GetAttribMap(Target);
 }
 
 IdMapPtr UArtilleryDispatch::GetIdSetShadowByObjectKey(const FSkeletonKey& Target,
@@ -205,6 +269,41 @@ void UArtilleryDispatch::ProcessRequestRouterGameThread()
 {
 	if (RequestRouter)
 	{
+		//a volley or a wave arrives as a run of mesh spawns. they're held back until something else comes up, or the
+		//queue runs dry, and then made together, so their bodies go into barrage as one batch instead of one by one.
+		TArray<FProjectileInstanceSpawn> Volley;
+		auto SpawnVolley = [this, &Volley]()
+		{
+			if (Volley.IsEmpty())
+			{
+				return;
+			}
+			UArtilleryProjectileDispatch* ProjectileDispatch = GetWorld()->GetSubsystem<UArtilleryProjectileDispatch>();
+			//the keys come back filled in, and invalid where it failed. the tags go on the requested key either way.
+			TArray<FSkeletonKey, TInlineAllocator<32>> Requested;
+			for (const FProjectileInstanceSpawn& Spawn : Volley)
+			{
+				Requested.Add(Spawn.Instance.Key);
+			}
+			ProjectileDispatch->CreateProjectileInstances(Volley);
+			for (const FSkeletonKey Key : Requested)
+			{
+				GameplayTagContainerPtr TagContainer = this->GetGameplayTagContainerAndAddIfNotExists(Key);
+				if (TagContainer.IsValid())
+				{
+					TagContainer->AddTag(InitState_GameplayReady);
+				}
+				else
+				{
+					UE_LOG(LogTemp, Warning, TEXT(
+						       "ArtilleryRequestType::SpawnStaticMesh: Could not get tag container for [%lld]"
+					       ), Key.Obj);
+					throw;
+				}
+			}
+			Volley.Reset();
+		};
+
 		for (F_INeedA::GameFeedMap& FeedMap : RequestRouter->GameThreadAcc)
 		{
 			TSharedPtr<F_INeedA::GameThreadRequestQ> HoldOpenQueue;
@@ -214,6 +313,11 @@ void UArtilleryDispatch::ProcessRequestRouterGameThread()
 				FRequestGameThreadThing Request;
 				while (HoldOpen && HoldOpenQueue->Dequeue(Request))
 				{
+					//anything else might want the volley to exist already.
+					if (Request.GetType() != ArtilleryRequestType::SpawnStaticMesh)
+					{
+						SpawnVolley();
+					}
 					//PINPOINT: YAGAMETHREADBOYRUNNETHREQUESTSHERE
 					switch (Request.GetType())
 					{
@@ -346,33 +450,16 @@ void UArtilleryDispatch::ProcessRequestRouterGameThread()
 					// *****************
 					case ArtilleryRequestType::SpawnStaticMesh:
 						{
-							UArtilleryProjectileDispatch* ProjectileDispatch = GetWorld()->GetSubsystem<
-								UArtilleryProjectileDispatch>();
-							ProjectileDispatch->CreateProjectileInstance(
-								Request.SourceOrSelf,
-								Request.Gun,
-								Request.ThingName,
-								FTransform(Request.ThingVector),
-								Request.ThingVector3,
-								Request.ThingVector2.X,
-								true,
-								true,
-								Request.Layer,
-								Request.CanExpire,
-								Request.TicksDuration);
-							GameplayTagContainerPtr TagContainer = this->GetGameplayTagContainerAndAddIfNotExists(
-								Request.SourceOrSelf);
-							if (TagContainer.IsValid())
-							{
-								TagContainer->AddTag(InitState_GameplayReady);
-							}
-							else
-							{
-								UE_LOG(LogTemp, Warning, TEXT(
-									       "ArtilleryRequestType::SpawnStaticMesh: Could not get tag container for [%lld]"
-								       ), Request.SourceOrSelf.Obj);
-								throw;
-							}
+							FProjectileInstanceSpawn& Spawn = Volley.AddDefaulted_GetRef();
+							Spawn.ProjectileDefinitionId = Request.ThingName;
+							Spawn.Gun = Request.Gun;
+							Spawn.Instance.Key = Request.SourceOrSelf;
+							Spawn.Instance.WorldTransform = FTransform(Request.ThingVector);
+							Spawn.Instance.MuzzleVelocity = Request.ThingVector3;
+							Spawn.Instance.Layer = static_cast<uint16>(Request.Layer);
+							Spawn.Instance.Scale = Request.ThingVector2.X;
+							Spawn.CanExpire = Request.CanExpire;
+							Spawn.LifeInTicks = Request.TicksDuration;
 						}
 						break;
 					default:
@@ -388,6 +475,7 @@ void UArtilleryDispatch::ProcessRequestRouterGameThread()
 				}
 			}
 		}
+		SpawnVolley();
 	}
 }
 
@@ -518,11 +606,37 @@ void UArtilleryDispatch::QueueResim(FGunKey Key, ArtilleryTime Time) const
 	}
 }
 
+void UArtilleryDispatch::RunQueryBatch(FBQueryBatch& Batch) const
+{
+	UBarrageDispatch* Physics = GetWorld()->GetSubsystem<UBarrageDispatch>();
+	if (Physics)
+	{
+		Physics->RunQueryBatch(Batch);
+	}
+}
+
 AttrMapPtr UArtilleryDispatch::GetAttribMap(const FSkeletonKey Owner) const
 {
-	AttrMapPtr result;
-	bool found = AttributeSetToDataMapping->find(Owner, result);
-	return found ? result : nullptr;
+	TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore;
+	const uint32 Row = HoldOpenStore ? HoldOpenStore->FindRow(Owner) : FArtilleryAttributeStore::InvalidRow;
+	if (Row == FArtilleryAttributeStore::InvalidRow)
+	{
+		return nullptr;
+	}
+	AttrMapPtr Result = MakeShareable(new AttributeMap());
+	const uint32 Present = HoldOpenStore->PresentMask(Row);
+	for (int32 Attrib = 0; Attrib < NUM_ATTRIB_KEYS; ++Attrib)
+	{
+		if (Present & (1u << Attrib))
+		{
+			AttrPtr Handle = HoldOpenStore->At(Row, static_cast<uint8>(Attrib));
+			if (Handle)
+			{
+				Result->Add(static_cast<AttribKey>(Attrib), Handle);
+			}
+		}
+	}
+	return Result;
 }
 
 //Do not swap this to a ref, because a ref is a ref. If you want a no copy op, first off,
@@ -530,14 +644,9 @@ AttrMapPtr UArtilleryDispatch::GetAttribMap(const FSkeletonKey Owner) const
 //not more efficient and may be less efficient. second, use GetAttribRequired. it's for that.
 AttrPtr UArtilleryDispatch::GetAttrib(const FSkeletonKey Owner, AttribKey Attrib) const
 {
-	AttrMapPtr AttributeMap;
-	AttributeSetToDataMapping->find(Owner, AttributeMap);
-	if (AttributeMap != nullptr)
-	{
-		TSharedPtr<FConservedAttributeData>* AttributeData = AttributeMap->Find(Attrib);
-		return AttributeData != nullptr ? *AttributeData : nullptr;
-	}
-	return nullptr;
+	//one cuckoo find for the row, then it's indexing.
+	TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore;
+	return HoldOpenStore ? HoldOpenStore->Find(Owner, static_cast<uint8>(Attrib)) : nullptr;
 }
 
 //GetAttribRequired should ONLY be used where the lifecycle of the key's owner will not cause the ref'd mem
@@ -545,15 +654,14 @@ AttrPtr UArtilleryDispatch::GetAttrib(const FSkeletonKey Owner, AttribKey Attrib
 //yet guaranteed to be set.
 AttrPtr inline UArtilleryDispatch::GetAttribRequired(const FSkeletonKey& Owner, AttribKey Attrib) const
 {
-	AttrMapPtr AttributeMap;
-	AttributeSetToDataMapping->find(Owner, AttributeMap);
-	if (AttributeMap != nullptr)
+	TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore;
+	if (HoldOpenStore && HoldOpenStore->FindRow(Owner) != FArtilleryAttributeStore::InvalidRow)
 	{
-		TSharedPtr<FConservedAttributeData>* AttributeData = AttributeMap->Find(Attrib);
-		checkf(AttributeData != nullptr,
+		AttrPtr AttributeData = HoldOpenStore->Find(Owner, static_cast<uint8>(Attrib));
+		checkf(AttributeData.IsValid(),
 		       TEXT("UArtilleryDispatch::GetAttribRequired: Required Attribute [%d] for key [%lld] was not found."),
 		       Attrib, Owner.Obj);
-		return *AttributeData;
+		return AttributeData;
 	}
 	return nullptr;
 }
@@ -757,9 +865,27 @@ void UArtilleryDispatch::RERunGuns()
 	}
 }
 
+//the same locomotions again, for a tick being replayed. they've all run once, so nothing cosmetic goes out twice.
 void UArtilleryDispatch::RERunLocomotions()
 {
-	throw;
+	if (RequestorQueue_Locomos)
+	{
+		for (LocomotionParams& Params : *RequestorQueue_Locomos)
+		{
+			IArtilleryControllite** SpanningLinkage = KeyToControlliteMapping->Find(Params.parent);
+			if (SpanningLinkage != nullptr)
+			{
+				(*SpanningLinkage)->ArtilleryTick(Params.previousIndex, Params.currentIndex, true, false);
+			}
+		}
+		RequestorQueue_Locomos->Empty();
+	}
+}
+
+void UArtilleryDispatch::QueueRollback(uint64 Tick)
+{
+	ArtilleryTicklitesWorker_LockstepToWorldSim.QueueRollback(Tick);
+	ArtilleryAIWorker_LockstepToWorldSim.QueueRollback(Tick);
 }
 
 void UArtilleryDispatch::LoadGunData()
@@ -0,0 +1,171 @@
+#include "ArtilleryPatternTable.h"
+
+#include "AtypicalDistances.h"
+#include "MatchableTagTypes.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 GArtilleryPatternsVerify = 0;
+static FAutoConsoleVariableRef CVarArtilleryPatternsVerify(
+	TEXT("artillery.Patterns.Verify"),
+	GArtilleryPatternsVerify,
+	TEXT("Also run every pattern the old way, through the virtual patterns, and log any frame where the two disagree. Slow."));
+
+bool FArtilleryPatternTable::ShouldVerify()
+{
+	return GArtilleryPatternsVerify != 0;
+}
+
+void FArtilleryPatternTable::Compile(const FBinds& InBinds, const FPatterns& Patterns)
+{
+	Kinds.Reset();
+	Binds.Reset();
+	bNeedsFlick = false;
+	for (const TPair<ArtIPMKey, TSharedPtr<TSet<FActionPatternParams>>>& Pair : InBinds)
+	{
+		const IPM::CanonPattern* Pattern = Patterns.Find(Pair.Key);
+		if (!Pair.Value || Pair.Value->Num() == 0 || !Pattern || !*Pattern)
+		{
+			continue;
+		}
+		FCompiledKind Kind;
+		Kind.Name = Pair.Key;
+		Kind.Pattern = *Pattern;
+		Kind.FirstBind = Binds.Num();
+		for (const FActionPatternParams& Elem : *Pair.Value)
+		{
+			const uint32 Mask = static_cast<uint32>(Elem.ToSeek.buttons.to_ulong());
+			Kind.Union |= Mask;
+			//an empty mask never matched anything.
+			if (Mask != 0)
+			{
+				FCompiledBind& Bind = Binds.AddDefaulted_GetRef();
+				Bind.Mask = Mask;
+				Bind.ToFire = Elem.ToFire;
+			}
+		}
+		Kind.NumBinds = Binds.Num() - Kind.FirstBind;
+		if (Kind.NumBinds > 0)
+		{
+			bNeedsFlick |= Kind.Name == ArtIPMKey::StickFlick;
+			Kinds.Add(Kind);
+		}
+	}
+}
+
+bool FArtilleryPatternTable::DetectFlick(const TCircularBuffer<FArtilleryShell>& Ring, uint64 Frame)
+{
+	//same as MatchingTools::FlickDetect, minus the optional copies.
+	const FArtilleryShell& Current = Ring[Frame];
+	const int32 CurX = Current.GetStickLeftXAsACSN();
+	const int32 CurY = Current.GetStickLeftYAsACSN();
+	if (static_cast<uint32>(FMath::Max(FMath::Abs(CurX), FMath::Abs(CurY))) <= MatchingTools::ArtilleryMagicFlickBoundary)
+	{
+		return false;
+	}
+	for (uint64 Index = Frame - 1; Frame - ArtilleryFlickSweepBack <= Index; --Index)
+	{
+		const FArtilleryShell& Then = Ring[Index];
+		if (AtypicalDistances::OctagonalApproximateDistance(Then.GetStickLeftXAsACSN(), Then.GetStickLeftYAsACSN(), CurX, CurY)
+			>= static_cast<uint32>(MatchingTools::ArtilleryMagicMinimumFlickDistanceRequired))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FArtilleryPatternTable::Evaluate(const TCircularBuffer<FArtilleryShell>& Ring,
+                                      uint64 Frame,
+                                      TArray<TPair<ArtilleryTime, EventBufferInfo>>& Out,
+                                      FFallback Fallback) const
+{
+	if (Kinds.IsEmpty())
+	{
+		return;
+	}
+
+	//Window[Depth - 1] is Frame. frames from before the stream started read as nothing pressed. the old patterns
+	//wrapped their unsigned start index there and either skipped the sweep or read garbage.
+	uint32 Window[Depth];
+	for (int32 Back = 0; Back < Depth; ++Back)
+	{
+		Window[Depth - 1 - Back] = static_cast<uint64>(Back) <= Frame ? Ring[Frame - Back].GetButtonsAndEventsFlat() : 0;
+	}
+
+	//every pattern we ship is a few bit ops on these. the hold family sweeps the current frame and the
+	//ArtilleryHoldSweepBack before it. release asks about the same span, one frame earlier.
+	constexpr int32 Now = Depth - 1;
+	constexpr int32 HoldStart = Now - ArtilleryHoldSweepBack;
+	const uint32 Current = Window[Now];
+	uint32 Held = ~0u;
+	uint32 HeldBefore = ~0u;
+	uint32 PressedBefore = 0;
+	//the allow-one-miss fold is per bit, so running it with every bit sought and masking after gives the same answer.
+	uint32 MissSeek = ~0u;
+	uint32 MissTracker = ~0u;
+	uint32 HeldAllowingOneMiss = 0;
+	for (int32 Index = HoldStart; Index <= Now; ++Index)
+	{
+		const uint32 Buttons = Window[Index];
+		Held &= Buttons;
+		HeldBefore &= Window[Index - 1];
+		PressedBefore |= Index < Now ? Buttons : 0;
+		HeldAllowingOneMiss = MissSeek & Buttons;
+		MissSeek = MissTracker | HeldAllowingOneMiss;
+		MissTracker &= HeldAllowingOneMiss;
+	}
+	//the old flick bailed before it had two sweeps of history, and so do we.
+	const bool bFlick = bNeedsFlick && Frame >= 2 * ArtilleryFlickSweepBack && DetectFlick(Ring, Frame);
+
+	for (const FCompiledKind& Kind : Kinds)
+	{
+		const uint32 Union = Kind.Union;
+		uint32 Result = 0;
+		switch (Kind.Name)
+		{
+		case ArtIPMKey::SingleFrameFire:
+			Result = Current & Union;
+			break;
+		case ArtIPMKey::ButtonHold:
+			Result = Held & Union;
+			break;
+		case ArtIPMKey::ButtonHoldAllowOneMiss:
+			Result = HeldAllowingOneMiss & Union;
+			break;
+		case ArtIPMKey::OnPress:
+			Result = Union & ~PressedBefore & Current;
+			break;
+		//these two answer for the whole union at once, which couples their binds. that's how they've always worked.
+		case ArtIPMKey::ButtonReleaseNoDelay:
+			Result = (HeldBefore & Union) == Union && (Current & Union) == 0 ? Union : 0;
+			break;
+		case ArtIPMKey::StickFlick:
+			Result = bFlick ? Union : 0;
+			break;
+		default:
+			{
+				FActionBitMask Seek;
+				Seek.buttons = Union;
+				Result = Fallback(Kind.Pattern, Seek);
+			}
+			break;
+		}
+		if (Result == 0)
+		{
+			continue;
+		}
+
+		const ArtilleryTime SentAt = Ring[Frame].SentAt;
+		for (int32 Index = Kind.FirstBind; Index < Kind.FirstBind + Kind.NumBinds; ++Index)
+		{
+			const FCompiledBind& Bind = Binds[Index];
+			if ((Bind.Mask & Result) == Bind.Mask)
+			{
+				EventBufferInfo EventInfo;
+				EventInfo.GunKey = Bind.ToFire;
+				EventInfo.Action = Kind.Name;
+				Out.Add(TPair<ArtilleryTime, EventBufferInfo>(SentAt, EventInfo));
+			}
+		}
+	}
+}
@@ -96,8 +96,11 @@ bool UArtilleryProjectileDispatch::RegistrationImplementation()
 	MyDispatch = GetWorld()->GetSubsystem<UArtilleryDispatch>();
 	check(MyDispatch);
 	UBarrageDispatch* BarrageDispatch = GetWorld()->GetSubsystem<UBarrageDispatch>();
-	BarrageDispatch->OnBarrageContactAddedDelegate.AddUObject(
-		this, &UArtilleryProjectileDispatch::OnBarrageContactAdded);
+	FBContactFilter ProjectileContacts;
+	ProjectileContacts.LayersA = FBContactFilter::Layer(Layers::PROJECTILE) | FBContactFilter::Layer(Layers::ENEMYPROJECTILE);
+	ProjectileContacts.EventTypes = FBContactFilter::Added;
+	ContactSubscription = BarrageDispatch->SubscribeToContacts(ProjectileContacts,
+		FOnBarrageContactBatch::CreateUObject(this, &UArtilleryProjectileDispatch::OnBarrageContactsAdded));
 	UArtilleryDispatch::SelfPtr->SetProjectileDispatch(this);
 	SelfPtr = this;
 	return true;
@@ -121,6 +124,12 @@ void UArtilleryProjectileDispatch::OnWorldBeginPlay(UWorld& InWorld)
 
 void UArtilleryProjectileDispatch::Deinitialize()
 {
+	UBarrageDispatch* BarrageDispatch = GetWorld() ? GetWorld()->GetSubsystem<UBarrageDispatch>() : nullptr;
+	if (BarrageDispatch)
+	{
+		BarrageDispatch->UnsubscribeFromContacts(ContactSubscription);
+	}
+	ContactSubscription = FBarrageContactRouter::InvalidSubscription;
 	TSharedPtr<KeyToItemCuckooMap> HoldOpen = ProjectileKeyToMeshManagerMapping;
 	TSharedPtr<TMap<FString, TWeakObjectPtr<AInstancedMeshManager>>> HoldOpenManagers = MeshAssetToMeshManagerMapping;
 	ManagerKeyToMeshManagerMapping->Empty();
@@ -239,32 +248,7 @@ FSkeletonKey UArtilleryProjectileDispatch::CreateProjectileInstance(FSkeletonKey
 			{
 				FSkeletonKey NewProjectileKey = MeshManager->CreateNewInstance(
 					WorldTransform, MuzzleVelocity, Layer, Scale, ProjectileKey, IsSensor, IsDynamic);
-				ProjectileKeyToMeshManagerMapping->insert_or_assign(NewProjectileKey, *MeshManagerPtr);
-				ProjectileToGunMapping->insert_or_assign(NewProjectileKey, Gun);
-				UNiagaraParticleDispatch* NPD = GetWorld()->GetSubsystem<UNiagaraParticleDispatch>();
-				check(NPD);
-				TWeakObjectPtr<UNiagaraDataChannelAsset> ProjectileNDCAssetPtr = NPD->GetNDCAssetForProjectileDefinition(
-					ProjectileDefinitionId.ToString());
-				if (ProjectileNDCAssetPtr.IsValid())
-				{
-					ParticleRecord& NewParticleRecord = NPD->RegisterKeyForProcessing(NewProjectileKey);
-					NewParticleRecord.NDCAssetPtr = ProjectileNDCAssetPtr;
-					NewParticleRecord.NDCIndex = -1;
-				}
-				if (CanExpire)
-				{
-					//TODO: revisit to provide rollback support. it'll be exactly like tombstones.
-					int ExpireTicks = LifeInTicks == -1 ? DEFAULT_LIFE_OF_PROJECTILE : LifeInTicks;
-					TArray<FSkeletonKey>* ArrayIfAny = ExpirationDeadliner->Find(ExpirationCounter + ExpireTicks);
-					if (ArrayIfAny != nullptr)
-					{
-						ArrayIfAny->Add(NewProjectileKey);
-					}
-					else
-					{
-						ExpirationDeadliner->Add(ExpirationCounter + ExpireTicks, {NewProjectileKey});
-					}
-				}
+				RegisterProjectileInstance(NewProjectileKey, *MeshManagerPtr, Gun, ProjectileDefinitionId, CanExpire, LifeInTicks);
 				return NewProjectileKey;
 			}
 		}
@@ -272,6 +256,90 @@ FSkeletonKey UArtilleryProjectileDispatch::CreateProjectileInstance(FSkeletonKey
 	return FSkeletonKey();
 }
 
+void UArtilleryProjectileDispatch::CreateProjectileInstances(TArrayView<FProjectileInstanceSpawn> Spawns)
+{
+	if (!IsReady)
+	{
+		for (FProjectileInstanceSpawn& Spawn : Spawns)
+		{
+			Spawn.Instance.Key = FSkeletonKey();
+		}
+		return;
+	}
+	//grouped by definition, since that's what picks the mesh manager. a volley is nearly always one definition.
+	TArray<FName, TInlineAllocator<4>> Definitions;
+	for (const FProjectileInstanceSpawn& Spawn : Spawns)
+	{
+		Definitions.AddUnique(Spawn.ProjectileDefinitionId);
+	}
+	TArray<FInstancedMeshSpawn> Instances;
+	TArray<int32> Indices;
+	for (const FName Definition : Definitions)
+	{
+		TWeakObjectPtr<AInstancedMeshManager>* MeshManagerPtr = ProjectileNameToMeshManagerMapping->Find(Definition);
+		//game thread, so nothing collects it out from under us before we're done.
+		AInstancedMeshManager* MeshManager = MeshManagerPtr && MeshManagerPtr->IsValid() ? MeshManagerPtr->Get() : nullptr;
+		Instances.Reset();
+		Indices.Reset();
+		for (int32 Index = 0; Index < Spawns.Num(); ++Index)
+		{
+			if (Spawns[Index].ProjectileDefinitionId == Definition)
+			{
+				Instances.Add(Spawns[Index].Instance);
+				Indices.Add(Index);
+			}
+		}
+		if (MeshManager)
+		{
+			MeshManager->CreateNewInstances(Instances);
+		}
+		for (int32 Made = 0; Made < Indices.Num(); ++Made)
+		{
+			FProjectileInstanceSpawn& Spawn = Spawns[Indices[Made]];
+			Spawn.Instance.Key = MeshManager ? Instances[Made].Key : FSkeletonKey();
+			if (MeshManager)
+			{
+				RegisterProjectileInstance(Spawn.Instance.Key, *MeshManagerPtr, Spawn.Gun, Definition, Spawn.CanExpire, Spawn.LifeInTicks);
+			}
+		}
+	}
+}
+
+void UArtilleryProjectileDispatch::RegisterProjectileInstance(FSkeletonKey NewProjectileKey,
+                                                              const TWeakObjectPtr<AInstancedMeshManager>& MeshManager,
+                                                              FGunKey Gun,
+                                                              const FName ProjectileDefinitionId,
+                                                              const bool CanExpire,
+                                                              const int LifeInTicks)
+{
+	ProjectileKeyToMeshManagerMapping->insert_or_assign(NewProjectileKey, MeshManager);
+	ProjectileToGunMapping->insert_or_assign(NewProjectileKey, Gun);
+	UNiagaraParticleDispatch* NPD = GetWorld()->GetSubsystem<UNiagaraParticleDispatch>();
+	check(NPD);
+	TWeakObjectPtr<UNiagaraDataChannelAsset> ProjectileNDCAssetPtr = NPD->GetNDCAssetForProjectileDefinition(
+		ProjectileDefinitionId.ToString());
+	if (ProjectileNDCAssetPtr.IsValid())
+	{
+		ParticleRecord& NewParticleRecord = NPD->RegisterKeyForProcessing(NewProjectileKey);
+		NewParticleRecord.NDCAssetPtr = ProjectileNDCAssetPtr;
+		NewParticleRecord.NDCIndex = -1;
+	}
+	if (CanExpire)
+	{
+		//TODO: revisit to provide rollback support. it'll be exactly like tombstones.
+		int ExpireTicks = LifeInTicks == -1 ? DEFAULT_LIFE_OF_PROJECTILE : LifeInTicks;
+		TArray<FSkeletonKey>* ArrayIfAny = ExpirationDeadliner->Find(ExpirationCounter + ExpireTicks);
+		if (ArrayIfAny != nullptr)
+		{
+			ArrayIfAny->Add(NewProjectileKey);
+		}
+		else
+		{
+			ExpirationDeadliner->Add(ExpirationCounter + ExpireTicks, {NewProjectileKey});
+		}
+	}
+}
+
 bool UArtilleryProjectileDispatch::IsArtilleryProjectile(const FSkeletonKey MaybeProjectile)
 {
 	return ProjectileKeyToMeshManagerMapping->contains(MaybeProjectile);
@@ -314,6 +382,14 @@ TWeakObjectPtr<USceneComponent> UArtilleryProjectileDispatch::GetSceneComponentF
 	return ManagerRef.IsValid() ? ManagerRef->GetSceneComponentForInstance(ProjectileKey) : nullptr;
 }
 
+void UArtilleryProjectileDispatch::OnBarrageContactsAdded(TArrayView<const BarrageContactEvent> ContactEvents)
+{
+	for (const BarrageContactEvent& ContactEvent : ContactEvents)
+	{
+		OnBarrageContactAdded(ContactEvent);
+	}
+}
+
 void UArtilleryProjectileDispatch::OnBarrageContactAdded(const BarrageContactEvent& ContactEvent)
 {
 	// We only care if one of the entities is a projectile
@@ -1,53 +1,49 @@
 #include "ArtilleryShell.h"
 
-float FArtilleryShell::GetStickLeftX()
+float FArtilleryShell::GetStickLeftX() const
 {
     return FCableInputPacker::UnpackStick(MyInputActions >> 53);
 }
-int32_t FArtilleryShell::GetStickLeftXAsACSN()
+int32_t FArtilleryShell::GetStickLeftXAsACSN() const
 {
     return FCableInputPacker::DebiasStick(MyInputActions >> 53);
 }
 
 
-float FArtilleryShell::GetStickLeftY()
+float FArtilleryShell::GetStickLeftY() const
 {
     return FCableInputPacker::UnpackStick((MyInputActions >> 42) & 0b11111111111);
 }
-int32_t FArtilleryShell::GetStickLeftYAsACSN()
+int32_t FArtilleryShell::GetStickLeftYAsACSN() const
 {
     return FCableInputPacker::DebiasStick((MyInputActions >> 42) & 0b11111111111);
 }
 
-float FArtilleryShell::GetStickRightX()
+float FArtilleryShell::GetStickRightX() const
 {
     return FCableInputPacker::UnpackStick((MyInputActions >> 31) & 0b11111111111);
 }
-int32_t FArtilleryShell::GetStickRightXAsACSN()
+int32_t FArtilleryShell::GetStickRightXAsACSN() const
 {
     return FCableInputPacker::FCableInputPacker::DebiasStick((MyInputActions >> 31) & 0b11111111111);
 }
 
-float FArtilleryShell::GetStickRightY()
+float FArtilleryShell::GetStickRightY() const
 {
     return FCableInputPacker::UnpackStick((MyInputActions >> 20) & 0b11111111111);
 }
 
-int32_t FArtilleryShell::GetStickRightYAsACSN()
+int32_t FArtilleryShell::GetStickRightYAsACSN() const
 {
     return FCableInputPacker::FCableInputPacker::DebiasStick((MyInputActions >> 20) & 0b11111111111);
 }
 
 // index is 0 - 19
-bool FArtilleryShell::GetInputAction(uint8 inputActionIndex)
+bool FArtilleryShell::GetInputAction(uint8 inputActionIndex) const
 {
     return (MyInputActions >> inputActionIndex) & 0b1;
 }
 
-uint32 FArtilleryShell::GetButtonsAndEventsFlat()
-{                         //0b1111 1111 1111 1111 1111 is 20 bits.
-    return MyInputActions & 0b11111111111111111111;
-}
 /**
 * 	std::bitset<11> lx;
 	std::bitset<11> ly;
@@ -0,0 +1,239 @@
+#include "ArtilleryTickPacer.h"
+
+#include "HAL/IConsoleManager.h"
+#include <chrono>
+#include <thread>
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include <timeapi.h>
+//older sdks don't have it. windows versions that don't support it fail the create, and we fall back.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+#include <errno.h>
+#include <time.h>
+#include <sys/prctl.h>
+#endif
+
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+//clock_nanosleep on an absolute deadline, with timer slack turned down, usually lands within tens of microseconds.
+static constexpr int32 DefaultSpinMicroseconds = 50;
+#else
+static constexpr int32 DefaultSpinMicroseconds = 200;
+#endif
+
+static int32 GArtilleryPacerSpinMicroseconds = DefaultSpinMicroseconds;
+static FAutoConsoleVariableRef CVarArtilleryPacerSpinMicroseconds(
+	TEXT("artillery.Pacer.SpinMicroseconds"),
+	GArtilleryPacerSpinMicroseconds,
+	TEXT("How long before each busy worker slot the pacer stops sleeping and yields instead. Higher is more precise and burns more core."));
+
+static int32 GArtilleryPacerMaxCatchUpSlots = 8;
+static FAutoConsoleVariableRef CVarArtilleryPacerMaxCatchUpSlots(
+	TEXT("artillery.Pacer.MaxCatchUpSlots"),
+	GArtilleryPacerMaxCatchUpSlots,
+	TEXT("How many overdue slots the busy worker runs back to back to catch up. Past that, they're skipped and the pacer resyncs."));
+
+static int32 GArtilleryPacerWakeCheckMicroseconds = 100;
+static FAutoConsoleVariableRef CVarArtilleryPacerWakeCheckMicroseconds(
+	TEXT("artillery.Pacer.WakeCheckMicroseconds"),
+	GArtilleryPacerWakeCheckMicroseconds,
+	TEXT("Longest the busy worker sleeps between checks for input that should run the sim before the next slot. 0 only checks while yielding."));
+
+FArtilleryTickPacer::FArtilleryTickPacer()
+{
+}
+
+FArtilleryTickPacer::~FArtilleryTickPacer()
+{
+	Finish();
+}
+
+int64 FArtilleryTickPacer::NowNanos()
+{
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+	timespec Now;
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return static_cast<int64>(Now.tv_sec) * 1000000000ll + Now.tv_nsec;
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+int64 FArtilleryTickPacer::NetworkNowNanos()
+{
+	const uint32 Micros = NetworkClock();
+	//signed, so the wall clock stepping back a little reads as time standing still rather than an hour going by.
+	NetworkMicros += FMath::Max<int32>(static_cast<int32>(Micros - LastNetworkMicros), 0);
+	LastNetworkMicros = Micros;
+	return NetworkMicros * 1000;
+}
+
+void FArtilleryTickPacer::Start(uint64 InPeriodNanos, TFunction<uint32()> InNetworkClock)
+{
+	PeriodNanos = static_cast<int64>(FMath::Max<uint64>(InPeriodNanos, 1));
+	NetworkClock = MoveTemp(InNetworkClock);
+	LastNetworkMicros = NetworkClock();
+	NetworkMicros = LastNetworkMicros;
+#if PLATFORM_WINDOWS
+	Timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (Timer)
+	{
+		Primitive = TEXT("high resolution waitable timer");
+	}
+	else
+	{
+		//pre-1803 windows. this is what we always used to do.
+		timeBeginPeriod(1);
+		bRaisedTimerResolution = true;
+		Primitive = TEXT("Sleep with timeBeginPeriod(1)");
+	}
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+	//the default slack is 50us, which the kernel is free to add to every wake. this only affects the calling thread.
+	prctl(PR_SET_TIMERSLACK, 1, 0, 0, 0);
+	Primitive = TEXT("clock_nanosleep");
+#else
+	Primitive = TEXT("sleep_for");
+#endif
+	const int64 Now = NetworkNowNanos();
+	NextDeadline = (Now / PeriodNanos + 1) * PeriodNanos;
+}
+
+void FArtilleryTickPacer::Finish()
+{
+#if PLATFORM_WINDOWS
+	if (Timer)
+	{
+		CloseHandle(Timer);
+		Timer = nullptr;
+	}
+	if (bRaisedTimerResolution)
+	{
+		timeEndPeriod(1);
+		bRaisedTimerResolution = false;
+	}
+#endif
+}
+
+void FArtilleryTickPacer::SleepUntil(int64 DeadlineNanos)
+{
+#if PLATFORM_WINDOWS
+	const int64 Remaining = DeadlineNanos - NowNanos();
+	if (Remaining <= 0)
+	{
+		return;
+	}
+	if (Timer)
+	{
+		//negative is relative, in 100ns units. the timer can't take our clock as an absolute, but the deadline still is.
+		LARGE_INTEGER Due;
+		Due.QuadPart = -static_cast<LONGLONG>(Remaining / 100);
+		if (Due.QuadPart < 0 && SetWaitableTimer(Timer, &Due, 0, nullptr, nullptr, false))
+		{
+			WaitForSingleObject(Timer, INFINITE);
+		}
+	}
+	else if (Remaining >= 1000000)
+	{
+		::Sleep(static_cast<DWORD>(Remaining / 1000000));
+	}
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+	timespec Deadline;
+	Deadline.tv_sec = static_cast<time_t>(DeadlineNanos / 1000000000ll);
+	Deadline.tv_nsec = static_cast<long>(DeadlineNanos % 1000000000ll);
+	//absolute, so being interrupted and going back to sleep doesn't stretch anything.
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Deadline, nullptr) == EINTR)
+	{
+	}
+#else
+	const int64 Remaining = DeadlineNanos - NowNanos();
+	if (Remaining > 0)
+	{
+		std::this_thread::sleep_for(std::chrono::nanoseconds(Remaining));
+	}
+#endif
+}
+
+int32 FArtilleryTickPacer::WaitForNextSlot(TFunctionRef<bool()> WakeEarly)
+{
+	int64 Now = NetworkNowNanos();
+	if (Now < NextDeadline)
+	{
+		const int64 Spin = static_cast<int64>(FMath::Max(GArtilleryPacerSpinMicroseconds, 0)) * 1000;
+		const int64 WakeCheck = static_cast<int64>(FMath::Max(GArtilleryPacerWakeCheckMicroseconds, 0)) * 1000;
+		while (NextDeadline - Now > Spin)
+		{
+			if (WakeEarly())
+			{
+				return 0;
+			}
+			//the sleep is on the local clock, so it's only ever told how long, never when.
+			const int64 Remaining = NextDeadline - Spin - Now;
+			SleepUntil(NowNanos() + (WakeCheck > 0 ? FMath::Min(Remaining, WakeCheck) : Remaining));
+			Now = NetworkNowNanos();
+		}
+		while ((Now = NetworkNowNanos()) < NextDeadline)
+		{
+			if (WakeEarly())
+			{
+				return 0;
+			}
+			std::this_thread::yield();
+		}
+		NoteSlot(Now - NextDeadline);
+		//always from the last deadline, never from when we woke. this is the drift correction.
+		NextDeadline += PeriodNanos;
+		return 1;
+	}
+
+	//already due. the slot we're returning for is this one, and Behind more after it are due too.
+	const int64 Behind = (Now - NextDeadline) / PeriodNanos;
+	int64 Elapsed = 1;
+	if (Behind > FMath::Max(GArtilleryPacerMaxCatchUpSlots, 0))
+	{
+		//too far gone to catch up without running the sim flat out for a while. drop the backlog, but say how much of it
+		//there was, so the caller's tick count stays on the clock.
+		NextDeadline += Behind * PeriodNanos;
+		Skipped.fetch_add(Behind, std::memory_order_relaxed);
+		Elapsed += Behind;
+	}
+	else
+	{
+		CaughtUp.fetch_add(1, std::memory_order_relaxed);
+	}
+	NoteSlot(Now - NextDeadline);
+	NextDeadline += PeriodNanos;
+	return static_cast<int32>(FMath::Min<int64>(Elapsed, MAX_int32));
+}
+
+void FArtilleryTickPacer::NoteSlot(int64 LateNanos)
+{
+	Slots.fetch_add(1, std::memory_order_relaxed);
+	const uint64 LateMicros = static_cast<uint64>(FMath::Max<int64>(LateNanos, 0)) / 1000;
+	const int32 Bucket = LateMicros == 0
+		? 0
+		: FMath::Min(static_cast<int32>(FMath::FloorLog2_64(LateMicros)) + 1, FArtilleryPacerStats::Buckets - 1);
+	Late[Bucket].fetch_add(1, std::memory_order_relaxed);
+	uint64 Max = MaxLateNanos.load(std::memory_order_relaxed);
+	while (static_cast<uint64>(LateNanos) > Max && LateNanos > 0
+		&& !MaxLateNanos.compare_exchange_weak(Max, static_cast<uint64>(LateNanos), std::memory_order_relaxed))
+	{
+	}
+}
+
+FArtilleryPacerStats FArtilleryTickPacer::GetStats() const
+{
+	FArtilleryPacerStats Stats;
+	Stats.Slots = Slots.load(std::memory_order_relaxed);
+	Stats.CaughtUp = CaughtUp.load(std::memory_order_relaxed);
+	Stats.Skipped = Skipped.load(std::memory_order_relaxed);
+	Stats.MaxLateMicros = MaxLateNanos.load(std::memory_order_relaxed) / 1000;
+	for (int32 Bucket = 0; Bucket < FArtilleryPacerStats::Buckets; ++Bucket)
+	{
+		Stats.Late[Bucket] = Late[Bucket].load(std::memory_order_relaxed);
+	}
+	Stats.Primitive = Primitive;
+	return Stats;
+}
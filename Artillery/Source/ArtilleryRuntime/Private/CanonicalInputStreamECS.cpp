@@ -110,6 +110,7 @@ bool UCanonicalInputStreamECS::registerPattern( IPM::CanonPattern ToBind,
 			newSet.Get()->Add(FCM_Owner_ActorParams);
 			thisInputStream->MyPatternMatcher->AllPatternBinds.Add(ToBind->getName(), newSet);
 		}
+		thisInputStream->MyPatternMatcher->bBindsChanged.store(true);
 
 		return true;
 	}
@@ -134,6 +135,7 @@ bool UCanonicalInputStreamECS::removePattern(IPM::CanonPattern ToBind, FActionPa
 			{
 				auto remId = pinSharedPtr->Get()->FindId(FCM_Owner_ActorParams);
 				pinSharedPtr->Get()->Remove(remId);
+				thisInputStream->MyPatternMatcher->bBindsChanged.store(true);
 				return true;
 			}
 		}
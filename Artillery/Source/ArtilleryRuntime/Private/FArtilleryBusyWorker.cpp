@@ -1,7 +1,5 @@
 ﻿#include "FArtilleryBusyWorker.h"
 #include "ArtilleryDispatch.h"
-#include "Windows/WindowsSystemIncludes.h"
-#include <timeapi.h>
 
 #include "ArtilleryBPLibs.h"
 #include "BarrageDispatch.h"
@@ -28,11 +26,16 @@ bool FArtilleryBusyWorker::Init()
 
 void FArtilleryBusyWorker::RunStandardFrameSim(bool& missedPrior, uint64_t& currentIndexCabling,
                                                bool& burstDropDetected, PacketElement& current,
-                                               bool& RemoteInput)
+                                               bool& RemoteInput, uint64_t ReplayUpTo)
 {
+	const bool bReplay = ReplayUpTo != 0;
 	//this is an odd thing to do, I know, but we have some book-keeping we want to reserve for each code path.
 	//once this settles a little, I'll refactor, but I'm going to end up reworking this next weekend.
-	if (InputRingBuffer != nullptr && !InputRingBuffer.Get()->IsEmpty())
+	if (bReplay)
+	{
+		//the input's all in the streams already. that's the point.
+	}
+	else if (InputRingBuffer != nullptr && !InputRingBuffer.Get()->IsEmpty())
 	{
 		while (InputRingBuffer != nullptr && !InputRingBuffer.Get()->IsEmpty())
 		{
@@ -46,6 +49,11 @@ void FArtilleryBusyWorker::RunStandardFrameSim(bool& missedPrior, uint64_t& curr
 			//right now, we just wait until we get the remote input.
 			if (missedPrior)
 			{
+				//what just came in should have been in the frames that went without, so they go again.
+				if (RecentFrames > 0)
+				{
+					RequestRollback(RecentFrameTicks[FMath::Min(burstDropDetected ? 1 : 0, RecentFrames - 1)]);
+				}
 				if (burstDropDetected)
 				{
 					BristleconeControlStream->Add(
@@ -100,7 +108,7 @@ void FArtilleryBusyWorker::RunStandardFrameSim(bool& missedPrior, uint64_t& curr
 		//if we got nothing, repeat prior.
 		//0000000000000000000000000000000000
 
-		CablingControlStream->Add(CablingControlStream->get(CablingControlStream->highestInput - 1)->MyInputActions,
+		CablingControlStream->Add(CablingControlStream->get(CablingControlStream->GetHighestGuaranteedInput())->MyInputActions,
 		                          TickliteNow);
 	}
 #define ARTILLERY_FIRE_CONTROL_MACHINE_HANDLING (false)
@@ -110,12 +118,15 @@ void FArtilleryBusyWorker::RunStandardFrameSim(bool& missedPrior, uint64_t& curr
 	//Pattern matchers match, set events, and then those events are handed to the dispatch for now.
 	//gradually, we'll be able to run more and more of them on this thread, freeing us from the tyranny.
 	//Per input stream, run their patterns here. god in heaven.
-	EventBuffer& refDangerous_LifeCycleManaged_Abilities_TripleBuffered = RequestorQueue_Abilities_TripleBuffer->GetWriteBuffer();
+	ReplayEvents.Reset();
+	EventBuffer& refDangerous_LifeCycleManaged_Abilities_TripleBuffered = bReplay ? ReplayEvents : RequestorQueue_Abilities_TripleBuffer->GetWriteBuffer();
 
-	if (currentIndexCabling < CablingControlStream->highestInput)
+	//we're the only writer, so this can't move under us until the next Add.
+	const uint64_t HighestCabling = bReplay ? ReplayUpTo : CablingControlStream->GetHighestInput();
+	if (currentIndexCabling < HighestCabling)
 	{
 		//today's sin is PRIDE, bigbird!
-		for (int i = currentIndexCabling; i < CablingControlStream->highestInput; ++i)
+		for (uint64_t i = currentIndexCabling; i < HighestCabling; ++i)
 		{
 			//TODO: does this leak memory?
 			ActorKey StreamActorKey = CablingControlStream->GetActorByInputStream();
@@ -139,11 +150,18 @@ void FArtilleryBusyWorker::RunStandardFrameSim(bool& missedPrior, uint64_t& curr
 			//even if this doesn't get played for some reason, this is the last chance we've got to make a
 			//truly informed decision about the matter. By the time we reach the dispatch system, that chance is gone.
 			//Better to skip a cosmetic once in a while than crash the game.
-			CablingControlStream->get(CablingControlStream->highestInput - 1)->RunAtLeastOnce = true;
+			if (!bReplay)
+			{
+				CablingControlStream->MarkRun(HighestCabling - 1);
+			}
 		}
 	}
 
 	Locomos_BufferNotThreadSafe->Sort();
+	if (bReplay)
+	{
+		return;
+	}
 	refDangerous_LifeCycleManaged_Abilities_TripleBuffered.Sort();
 	if (RequestorQueue_Abilities_TripleBuffer->IsDirty() == false)
 	{
@@ -151,6 +169,52 @@ void FArtilleryBusyWorker::RunStandardFrameSim(bool& missedPrior, uint64_t& curr
 	}
 }
 
+void FArtilleryBusyWorker::RequestRollback(uint64 Tick)
+{
+	uint64 Pending = PendingRollbackTick.load(std::memory_order_relaxed);
+	while (Tick < Pending && !PendingRollbackTick.compare_exchange_weak(Pending, Tick, std::memory_order_relaxed))
+	{
+	}
+}
+
+void FArtilleryBusyWorker::Resimulate(UArtilleryDispatch* ArtilleryDispatch)
+{
+	const uint64 Tick = PendingRollbackTick.exchange(NoRollback, std::memory_order_relaxed);
+	if (Tick == NoRollback || ContingentPhysicsLinkage == nullptr || !FBRollbackRing::IsEnabled())
+	{
+		return;
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Artillery Resimulate");
+	if (!ContingentPhysicsLinkage->RestoreRollbackTick(Tick, ReplayTicks))
+	{
+		//too old, or bodies came or went since. Iris stomps are what's left for that.
+		UE_LOG(LogTemp, Warning, TEXT("Artillery:BusyWorker: couldn't roll back to tick %llu, carrying on without it."), Tick);
+		return;
+	}
+
+	//each tick's input ran from the index it was saved with up to where the next one started. the last one's ran
+	//up to wherever we are now.
+	const uint64_t Highest = CablingControlStream->GetHighestInput();
+	ArtilleryDispatch->BeginAttribReplay();
+	for (int32 Index = 0; Index < ReplayTicks.Num(); ++Index)
+	{
+		const FBRollbackTick Stepped = ReplayTicks[Index];
+		const uint64_t UpTo = Index + 1 < ReplayTicks.Num() ? ReplayTicks[Index + 1].Cookie : Highest;
+		ArtilleryDispatch->ReplayAttribTick(Stepped.Tick);
+		if (UpTo > Stepped.Cookie)
+		{
+			uint64_t From = Stepped.Cookie;
+			bool Unused = false;
+			PacketElement Ignored = 0;
+			RunStandardFrameSim(Unused, From, Unused, Ignored, Unused, UpTo);
+		}
+		ArtilleryDispatch->RERunLocomotions();
+		ContingentPhysicsLinkage->ReplayTick(Stepped);
+	}
+	ArtilleryDispatch->EndAttribReplay();
+	ArtilleryDispatch->QueueRollback(Tick);
+}
+
 //TODO right now, this incurs two serious determinism risks:
 //The order that threads get queues is random, so if you just go down the line, that won't produce a deterministic execution order.
 //Even if you fix that, you still need to order the requests as a gestalt, and now you have a problem where you don't know the
@@ -196,7 +260,6 @@ uint32 FArtilleryBusyWorker::Run()
 	SeqNumber = 0;
 	//Hi! Jake here! Reminding you that this will CYCLE
 	//That's known. Isn't that fun? :) Don't reorder these, by the way.
-	uint32_t LastIncrementWindow = ContingentInputECSLinkage->Now();
 	uint32_t lsbTime = ContingentInputECSLinkage->Now();
 	constexpr uint32_t sampleHertz = TheCone::CablingSampleHertz;
 	constexpr uint32_t RunHertz = LongboySendHertz;
@@ -204,16 +267,8 @@ uint32 FArtilleryBusyWorker::Run()
 	//in other words, artillery will always run at powers of two right now. that's intended for prototype.
 	constexpr uint32_t Period = 999900 / sampleHertz;
 	//swap to microseconds. standardizing. we actually run a LITTLE fast. for science reasons.
-	constexpr double MarginOfErrorForSleep = 0.75;
-	constexpr double MarginOfErrorForSpin = 0.90; //roughly .2 ms. Nothing but a spin is gonna be fast enough.
-	
-	//sleep basically always has +/1 duration * .5 error, at our sample rates.
-	constexpr uint32_t ErrorAdjustedPeriod = Period * MarginOfErrorForSleep;
-	
-	constexpr uint32_t MicroErrorAdjustedPeriod = Period * MarginOfErrorForSpin;
-	// we prefer to land near the _start_ of a period, so we bias.
-
-	constexpr std::chrono::milliseconds Step(Period / 1000);
+	//the pacer takes nanos. see ArtilleryTickPacer.h for how it sleeps and spins on each platform.
+	constexpr uint64_t PeriodNanos = static_cast<uint64_t>(Period) * 1000;
 
 	//we can now start the sim. we latch only on the apply step.
 	StartTicklitesSim->Trigger();
@@ -223,7 +278,19 @@ uint32 FArtilleryBusyWorker::Run()
 	//where we can, so we're trying to hide the barrage dependency here in a sense. We can't fully, but.
 	UArtilleryDispatch* ArtilleryDispatch = ContingentInputECSLinkage->GetWorld()->GetSubsystem<UArtilleryDispatch>();
 	ArtilleryDispatch->ThreadSetup();
-	timeBeginPeriod(2);
+	//a rollback needs the input it replays and the attributes it reads back, so it can't go further than either keeps.
+	if (ContingentPhysicsLinkage != nullptr)
+	{
+		ContingentPhysicsLinkage->SetRollbackWindow(FMath::Min<int32>(UCanonicalInputStreamECS::AddressableInputConservationWindow,
+			FArtilleryAttributeHistory::WindowTicks));
+	}
+	//slots are on the network clock, the same one input is stamped with, not on whatever this machine thinks time is.
+	Pacer.Start(PeriodNanos, [this]() { return static_cast<uint32>(ContingentInputECSLinkage->Now()); });
+	//input landing while the sim is waiting on its slot runs it then and there, same as if it had been here on the slot.
+	auto InputWaiting = [this, &sent]()
+	{
+		return !sent && InputRingBuffer != nullptr && !InputRingBuffer.Get()->IsEmpty();
+	};
 	
 	while (running)
 	{
@@ -236,10 +303,16 @@ uint32 FArtilleryBusyWorker::Run()
 			)
 		)
 		{
-			currentIndexCabling = CablingControlStream->highestInput;
+			Resimulate(ArtilleryDispatch);
+			currentIndexCabling = CablingControlStream->GetHighestInput();
 			PacketElement current = 0;
 			bool RemoteInput = false;
 			RunStandardFrameSim(missedPrior, currentIndexCabling, burstDropDetected, current, RemoteInput);
+			//the frame's own tick goes in last, so a rollback asked for while running it still finds the one before.
+			RecentFrameTicks[2] = RecentFrameTicks[1];
+			RecentFrameTicks[1] = RecentFrameTicks[0];
+			RecentFrameTicks[0] = SeqNumber;
+			RecentFrames = FMath::Min(RecentFrames + 1, 3);
 			/*
 			* Note: We also have Iris performing intermittent state stomps to recover from more serious desyncs.
 			* Ultimately, rollback can never solve everything. The windows just get too wide.
@@ -257,7 +330,11 @@ uint32 FArtilleryBusyWorker::Run()
 			}
 			else // yeah, I know it's optional, but stylistically, it's important.
 			{
+				//before the inputs go in, with the input index the frame started at, so a replay can find them again.
+				ContingentPhysicsLinkage->SaveRollbackTick(SeqNumber, TickliteNow, currentIndexCabling);
 				ContingentPhysicsLinkage->StackUp();
+				ArtilleryDispatch->CommitAttributeTick(SeqNumber);
+				TickliteTick = SeqNumber / SendHertzFactor;
 				StartTicklitesApply->Trigger();
 				StartRunAhead->Trigger();
 				ContingentPhysicsLinkage->StepWorld(TickliteNow, SeqNumber);
@@ -275,40 +352,28 @@ uint32 FArtilleryBusyWorker::Run()
 
 		//unlike cabling, we do our time keeping HERE. It may be worth switching cabling to also follow this.
 		//Alternatively, it may be worthwhile to switch to a wait/wake pattern against cabling, where we wait half the interval max, then
-		//start simulating in the remaining half. We're already eating 4ms of latency, and the act of sleeping is getting
-		//kind of expensive actually.
-		if (LastIncrementWindow + Period <= lsbTime)
+		//start simulating in the remaining half. We're already eating 4ms of latency.
+		//the pacer returns once per slot, on an absolute schedule, so a slow tick doesn't push the rest back.
+		//0 is input showing up early, which doesn't move the slot. more than 1 is slots the pacer skipped, and those
+		//still happened, so SeqNumber walks through every one of them and stays on the clock.
+		const int32 SlotsElapsed = Pacer.WaitForNextSlot(InputWaiting);
+		lsbTime = ContingentInputECSLinkage->Now();
+		for (int32 Slot = 0; Slot < SlotsElapsed; ++Slot)
 		{
-			LastIncrementWindow = FMath::Min(LastIncrementWindow + Period, lsbTime);
 			if (SeqNumber % SendHertzFactor == 0)
 			{
 				sent = false;
 			}
 			++SeqNumber;
-		}
-		else if ((LastIncrementWindow + MicroErrorAdjustedPeriod) <= lsbTime)
-		{
-			//spin spin spin
-			
-		}
-		else if ((LastIncrementWindow + ErrorAdjustedPeriod) <= lsbTime)
-		{
-			std::this_thread::yield(); //if we're within the margin of error on sleep, we yield instead.
-		}
-		else
-		{
-			std::this_thread::sleep_for(Step);
-		}
-		//std::this_thread::yield();
-		lsbTime = ContingentInputECSLinkage->Now();
-		if ((SeqNumber % sampleHertz) == 0)
-		{
-			UE_LOG(LogTemp, Display, TEXT("Artillery Busy Worker hertz cycled: %u against seq %ld"),
-				   lsbTime, SeqNumber);
+			if ((SeqNumber % sampleHertz) == 0)
+			{
+				UE_LOG(LogTemp, Display, TEXT("Artillery Busy Worker hertz cycled: %u against seq %ld"),
+					   lsbTime, SeqNumber);
+			}
 		}
 	}
 	
-	timeEndPeriod(2);
+	Pacer.Finish();
 	UE_LOG(LogTemp, Display, TEXT("Artillery:BusyWorker: Run Ended."));
 	return 0;
 }
@@ -0,0 +1,214 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ArtilleryAttributeStore.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+namespace ArtilleryAttributeHistoryTest
+{
+	typedef FArtilleryAttributeHistory FHistory;
+
+	static constexpr int32 Entities = 3;
+	//the lowest, a middling one, and the top bit of the presence mask.
+	static constexpr uint8 Attribs[] = {0, 3, FArtilleryAttributeStore::MaxAttribs - 1};
+	static constexpr int32 NumAttribs = UE_ARRAY_COUNT(Attribs);
+	static constexpr EAttributeValue Values[] = {EAttributeValue::Current, EAttributeValue::Base};
+	static constexpr int32 NumValues = UE_ARRAY_COUNT(Values);
+	//the last entity lets go of its row here and a new one takes it over, which has no history from before.
+	static constexpr int32 ReuseAt = 300;
+	static constexpr int32 FullSweepEvery = 256;
+
+	//commits aren't every tick, so there are ticks between them to ask about.
+	static uint64 TickOf(int32 Commit)
+	{
+		return 1000 + 3 * static_cast<uint64>(Commit);
+	}
+
+	struct FSnapshot
+	{
+		float Value[Entities][NumAttribs][NumValues];
+	};
+
+	struct FRun
+	{
+		FAutomationTestBase& Test;
+		int32 Interval;
+		TUniquePtr<FArtilleryAttributeStore> Store = MakeUnique<FArtilleryAttributeStore>();
+		FSkeletonKey Owners[Entities];
+		int32 BornAt[Entities] = {};
+		//indexed by commit, from 1.
+		TArray<FSnapshot> Expected;
+		int32 Checked = 0;
+		int32 Failures = 0;
+
+		FRun(FAutomationTestBase& InTest, int32 InInterval) : Test(InTest), Interval(InInterval)
+		{
+			Expected.AddZeroed();
+		}
+
+		void Register(int32 Entity, FSkeletonKey Owner, int32 Commit, FRandomStream& Random)
+		{
+			const uint32 Row = Store->Claim(Owner);
+			for (int32 Attrib = 0; Attrib < NumAttribs; ++Attrib)
+			{
+				Store->Init(Row, Attribs[Attrib], Random.FRandRange(1.f, 100.f));
+			}
+			Store->Bind(Owner, Row);
+			Owners[Entity] = Owner;
+			BornAt[Entity] = Commit;
+		}
+
+		float Read(int32 Entity, int32 Attrib, EAttributeValue Which)
+		{
+			const FAttributeHandle Handle = Store->Find(Owners[Entity], Attribs[Attrib]);
+			return Which == EAttributeValue::Current ? Handle->GetCurrentValue() : Handle->GetBaseValue();
+		}
+
+		//asks for Tick, which should come back as what the store held after commit Commit, or not at all.
+		void Check(int32 Entity, int32 Attrib, int32 Which, uint64 Tick, int32 Commit, bool bInWindow)
+		{
+			++Checked;
+			float Out = 0;
+			const bool bGot = Store->ValueAt(Owners[Entity], Attribs[Attrib], Values[Which], Tick, Out);
+			const bool bWant = bInWindow && Commit >= BornAt[Entity];
+			const bool bRight = bGot == bWant && (!bWant || Out == Expected[Commit].Value[Entity][Attrib][Which]);
+			if (!bRight && ++Failures <= 10)
+			{
+				Test.AddError(FString::Printf(TEXT("interval %d, %d commits in: entity %d attrib %d value %d at tick %llu (commit %d) gave %s %f, wanted %s %f."),
+					Interval, Expected.Num() - 1, Entity, Attribs[Attrib], Which, Tick, Commit,
+					bGot ? TEXT("found") : TEXT("nothing"), Out,
+					bWant ? TEXT("found") : TEXT("nothing"), bWant ? Expected[Commit].Value[Entity][Attrib][Which] : 0.f));
+			}
+		}
+
+		void CheckCommit(int32 Commit, bool bInWindow)
+		{
+			for (int32 Entity = 0; Entity < Entities; ++Entity)
+			{
+				for (int32 Attrib = 0; Attrib < NumAttribs; ++Attrib)
+				{
+					for (int32 Which = 0; Which < NumValues; ++Which)
+					{
+						Check(Entity, Attrib, Which, TickOf(Commit), Commit, bInWindow);
+						//between two commits is as of the earlier one.
+						Check(Entity, Attrib, Which, TickOf(Commit) + 1, Commit, bInWindow);
+						Check(Entity, Attrib, Which, TickOf(Commit + 1) - 1, Commit, bInWindow);
+					}
+				}
+			}
+		}
+
+		void Run(int32 Commits)
+		{
+			FRandomStream Random(25 + Interval);
+			for (int32 Entity = 0; Entity < Entities; ++Entity)
+			{
+				Register(Entity, FSkeletonKey(0x2500000000ull + Entity), 1, Random);
+			}
+
+			for (int32 Commit = 1; Commit <= Commits; ++Commit)
+			{
+				if (Commit == ReuseAt)
+				{
+					Store->Deregister(Owners[Entities - 1]);
+					Register(Entities - 1, FSkeletonKey(0x2600000000ull), Commit, Random);
+				}
+				//most attributes sit still most ticks, and some commits don't change anything at all.
+				const bool bQuiet = Random.FRand() < 0.1f;
+				for (int32 Entity = 0; !bQuiet && Entity < Entities; ++Entity)
+				{
+					for (int32 Attrib = 0; Attrib < NumAttribs; ++Attrib)
+					{
+						const FAttributeHandle Handle = Store->Find(Owners[Entity], Attribs[Attrib]);
+						if (Random.FRand() < 0.3f)
+						{
+							Handle->SetCurrentValue(Random.FRandRange(-1000.f, 1000.f));
+						}
+						if (Random.FRand() < 0.05f)
+						{
+							Handle->SetBaseValue(Random.FRandRange(-1000.f, 1000.f));
+						}
+					}
+				}
+				Store->Commit(TickOf(Commit));
+
+				FSnapshot& Snapshot = Expected.AddDefaulted_GetRef();
+				for (int32 Entity = 0; Entity < Entities; ++Entity)
+				{
+					for (int32 Attrib = 0; Attrib < NumAttribs; ++Attrib)
+					{
+						for (int32 Which = 0; Which < NumValues; ++Which)
+						{
+							Snapshot.Value[Entity][Attrib][Which] = Read(Entity, Attrib, Values[Which]);
+						}
+					}
+				}
+
+				//the newest commit, either side of a keyframe, and the oldest the window promises.
+				for (const int32 Back : {0, 1, 2, Interval - 1, Interval, Interval + 1, static_cast<int32>(FHistory::WindowTicks) - 1})
+				{
+					if (Commit - Back >= 1)
+					{
+						CheckCommit(Commit - Back, true);
+					}
+				}
+				if (Commit % FullSweepEvery == 0)
+				{
+					for (int32 Back = 0; Back < static_cast<int32>(FHistory::WindowTicks) && Commit - Back >= 1; ++Back)
+					{
+						CheckCommit(Commit - Back, true);
+					}
+				}
+				//once the deltas after a commit are lapped, no keyframe at or before it can be replayed from.
+				if (Commit > static_cast<int32>(FHistory::DeltaSlots))
+				{
+					CheckCommit(Commit - FHistory::DeltaSlots, false);
+				}
+				//and before the first commit there was nothing to start from.
+				for (int32 Entity = 0; Entity < Entities; ++Entity)
+				{
+					for (int32 Attrib = 0; Attrib < NumAttribs; ++Attrib)
+					{
+						Check(Entity, Attrib, 0, TickOf(0), 0, false);
+					}
+				}
+			}
+		}
+	};
+}
+
+//records known writes through the attribute store and asks for them back at and between commits, either side of
+//keyframes, across a reused row, and for long enough that both the delta and the keyframe rings lap.
+//does it at the shortest, default and longest keyframe intervals, since where keyframes land is the hard part.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FArtilleryAttributeHistoryReconstruct, "Artillery.Attributes.History.Reconstruct",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FArtilleryAttributeHistoryReconstruct::RunTest(const FString& Parameters)
+{
+	using namespace ArtilleryAttributeHistoryTest;
+	IConsoleVariable* IntervalVar = IConsoleManager::Get().FindConsoleVariable(TEXT("artillery.Attributes.KeyframeInterval"));
+	if (!TestNotNull(TEXT("keyframe interval cvar"), IntervalVar))
+	{
+		return false;
+	}
+	const int32 WasInterval = IntervalVar->GetInt();
+
+	for (const int32 Interval : {static_cast<int32>(FHistory::MinKeyframeInterval), 32, static_cast<int32>(FHistory::WindowTicks)})
+	{
+		IntervalVar->Set(Interval, ECVF_SetByCode);
+		FRun Run(*this, Interval);
+		//enough to lap the keyframe ring, and the deltas more times than that.
+		Run.Run(FMath::Max(static_cast<int32>(FHistory::KeyframeSlots + 2) * Interval, ReuseAt + static_cast<int32>(FHistory::DeltaSlots)));
+		const FArtilleryAttributeHistoryStats Stats = Run.Store->GetHistoryStats();
+		AddInfo(FString::Printf(TEXT("interval %d: %d reconstructions checked over %llu commits, %d keyframes live."),
+			Interval, Run.Checked, Stats.Commits, Stats.Keyframes));
+		TestEqual(FString::Printf(TEXT("interval %d: wrong reconstructions"), Interval), Run.Failures, 0);
+	}
+
+	IntervalVar->Set(WasInterval, ECVF_SetByCode);
+	return true;
+}
+
+#endif
@@ -0,0 +1,227 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ArtilleryPatternTable.h"
+#include "CanonicalInputStreamECS.h"
+#include "FCablePackedInput.h"
+#include "Math/RandomStream.h"
+
+namespace ArtilleryPatternTableTest
+{
+	typedef UCanonicalInputStreamECS::FConservedInputStream FStream;
+	typedef TArray<TPair<ArtilleryTime, EventBufferInfo>> FEvents;
+
+	static constexpr int32 ScriptFrames = FArtilleryPatternTable::Depth;
+	//the old patterns wrap their unsigned index on frames with less history than they sweep, so they only get run
+	//against a stream with this many empty frames in front. that's what the table means by pre-stream frames
+	//reading as nothing pressed.
+	static constexpr int32 Pad = FArtilleryPatternTable::Depth;
+	//enough history in front of a script that the flick's own early-out is behind it.
+	static constexpr int32 DeepLead = 2 * ArtilleryFlickSweepBack;
+	static constexpr int32 RandomScripts = 64;
+
+	static constexpr uint32 A = 1 << 0;
+	static constexpr uint32 B = 1 << 1;
+	static constexpr uint32 C = 1 << 7;
+	static constexpr uint32 Event = 1 << 19;
+
+	struct FFrame
+	{
+		uint32 Buttons = 0;
+		double StickX = 0.0;
+		double StickY = 0.0;
+	};
+
+	struct FScript
+	{
+		FString Name;
+		TArray<FFrame> Frames;
+	};
+
+	static INNNNCOMING Pack(const FFrame& Frame)
+	{
+		const uint64 X = FCableInputPacker::IntegerizedStick(Frame.StickX);
+		const uint64 Y = FCableInputPacker::IntegerizedStick(Frame.StickY);
+		return (X << 53) | (Y << 42) | Frame.Buttons;
+	}
+
+	//every script frame is sent at the same time on both streams, so the events' times have to agree too.
+	static TSharedPtr<FStream> MakeStream(int32 Empty, const FScript& Script)
+	{
+		TSharedPtr<FStream> Stream = MakeShared<FStream>();
+		for (int32 Index = 0; Index < Empty; ++Index)
+		{
+			Stream->Publish(Pack(FFrame()), 0, 0);
+		}
+		for (int32 Index = 0; Index < Script.Frames.Num(); ++Index)
+		{
+			Stream->Publish(Pack(Script.Frames[Index]), 1000 + Index, 1000 + Index);
+		}
+		return Stream;
+	}
+
+	static TArray<FScript> MakeScripts()
+	{
+		TArray<FScript> Scripts;
+		auto Buttons = [&Scripts](const TCHAR* Name, std::initializer_list<uint32> Masks)
+		{
+			FScript& Script = Scripts.AddDefaulted_GetRef();
+			Script.Name = Name;
+			for (uint32 Mask : Masks)
+			{
+				Script.Frames.Add({Mask, 0.0, 0.0});
+			}
+		};
+		//held from the very first frame, which only pre-stream frames can say anything about.
+		Buttons(TEXT("held from start"), {A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0, 0, 0});
+		//one dropped frame in the middle of a hold, then a release.
+		Buttons(TEXT("hold with a miss"), {0, A | B, A | B, A | B, B, A | B, A | B, A | B, A | B, A | B, 0, 0, B, B, 0, 0});
+		//two drops in the sweep, which the allow-one-miss hold mustn't forgive.
+		Buttons(TEXT("hold with two misses"), {A, A, 0, A, 0, A, A, A, A, A, A, A, A, A, A, 0});
+		Buttons(TEXT("taps"), {0, A, 0, B, 0, A | B, 0, C, C, 0, A, A, 0, Event, 0, A | B | C});
+		//releasing half of a bound pair, which couples the release binds through their union.
+		Buttons(TEXT("partial release"), {A | B, A | B, A | B, A | B, A | B, A | B, A | B, A, 0, A | B, A | B, A | B, A | B, A | B, A | B, B});
+		Buttons(TEXT("nothing"), {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+
+		FScript& Flick = Scripts.AddDefaulted_GetRef();
+		Flick.Name = TEXT("flicks");
+		const double Sticks[ScriptFrames][2] = {
+			{0.0, 0.0}, {0.0, 0.0}, {1.0, 0.0}, {1.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}, {-0.9, -0.9}, {-0.9, -0.9},
+			{0.0, 0.5}, {0.0, 1.0}, {0.0, 1.0}, {0.3, 0.0}, {-1.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}, {0.5, 0.5}};
+		for (int32 Index = 0; Index < ScriptFrames; ++Index)
+		{
+			Flick.Frames.Add({Index % 3 ? A : 0u, Sticks[Index][0], Sticks[Index][1]});
+		}
+
+		//buttons that mostly stay where they were, so holds and releases turn up, and a stick that wanders.
+		FRandomStream Random(22);
+		for (int32 Count = 0; Count < RandomScripts; ++Count)
+		{
+			FScript& Script = Scripts.AddDefaulted_GetRef();
+			Script.Name = FString::Printf(TEXT("random %d"), Count);
+			FFrame Frame;
+			for (int32 Index = 0; Index < ScriptFrames; ++Index)
+			{
+				for (uint32 Bit : {A, B, C, Event})
+				{
+					Frame.Buttons = Random.FRand() < 0.2f ? Frame.Buttons ^ Bit : Frame.Buttons;
+				}
+				if (Random.FRand() < 0.3f)
+				{
+					Frame.StickX = Random.FRandRange(-1.0f, 1.0f);
+					Frame.StickY = Random.FRandRange(-1.0f, 1.0f);
+				}
+				Script.Frames.Add(Frame);
+			}
+		}
+		return Scripts;
+	}
+
+	//every pattern kind we ship, each bound to single buttons, a pair, and an empty mask that should never fire.
+	static void Bind(UCanonicalInputStreamECS::FConservedInputPatternMatcher& Matcher)
+	{
+		const IPM::CanonPattern Patterns[] = {IPM::GPress, IPM::GHold, IPM::GHoldWM, IPM::GPerPress, IPM::GRelease, IPM::GFlick};
+		const uint32 Masks[] = {A, B, A | B, C, Event, 0};
+		uint32 Gun = 1;
+		for (IPM::CanonPattern Pattern : Patterns)
+		{
+			const ArtIPMKey Name = Pattern->getName();
+			Matcher.AllPatternsByName.Add(Name, Pattern);
+			TSharedPtr<TSet<FActionPatternParams>> Set = MakeShared<TSet<FActionPatternParams>>();
+			for (uint32 Mask : Masks)
+			{
+				FActionBitMask Seek;
+				Seek.buttons = Mask;
+				Set->Add(FActionPatternParams(Seek, 0, 0, FGunKey(TEXT("PatternTableTest"), Gun++)));
+			}
+			Matcher.AllPatternBinds.Add(Name, Set);
+		}
+		Matcher.Compiled.Compile(Matcher.AllPatternBinds, Matcher.AllPatternsByName);
+	}
+
+	static bool Same(const TPair<ArtilleryTime, EventBufferInfo>& Ours, const TPair<ArtilleryTime, EventBufferInfo>& Theirs)
+	{
+		return Ours.Key == Theirs.Key && Ours.Value.GunKey == Theirs.Value.GunKey && Ours.Value.Action == Theirs.Value.Action;
+	}
+}
+
+//replays scripted sixteen frame histories through the compiled table and the virtual patterns it replaced, both at the
+//very start of a stream and deep enough in that nothing is cut short, and wants the same events from both every frame.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FArtilleryPatternTableMatchesLegacy, "Artillery.Patterns.Table.MatchesLegacy",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FArtilleryPatternTableMatchesLegacy::RunTest(const FString& Parameters)
+{
+	using namespace ArtilleryPatternTableTest;
+	UCanonicalInputStreamECS::FConservedInputPatternMatcher Matcher(0, nullptr);
+	Bind(Matcher);
+
+	TSet<ArtIPMKey> Fired;
+	FEvents Ours;
+	FEvents Theirs;
+	int32 Mismatches = 0;
+	for (const FScript& Script : MakeScripts())
+	{
+		for (const int32 Lead : {0, DeepLead})
+		{
+			FScript Placed = Script;
+			Placed.Frames.InsertDefaulted(0, Lead);
+			const TSharedPtr<FStream> Stream = MakeStream(0, Placed);
+			const TSharedPtr<FStream> Padded = MakeStream(Pad, Placed);
+			for (int32 Frame = 0; Frame < Placed.Frames.Num(); ++Frame)
+			{
+				Ours.Reset();
+				Theirs.Reset();
+				Matcher.Compiled.Evaluate(Stream->CurrentHistory, Frame, Ours,
+					[&Stream, Frame](IPM::CanonPattern Pattern, FActionBitMask& Union)
+					{
+						return Pattern->runPattern(Frame, Union, Stream);
+					});
+				Matcher.runOneFrameLegacy(Frame + Pad, Padded, Theirs);
+
+				//the flick won't look at all until it has two sweeps of history. the padding gives the old one that
+				//early, so it's only held to the table once the stream really has it.
+				if (Frame < 2 * ArtilleryFlickSweepBack)
+				{
+					TestFalse(FString::Printf(TEXT("%s, frame %d: no flick this early"), *Script.Name, Frame),
+						Ours.ContainsByPredicate([](const TPair<ArtilleryTime, EventBufferInfo>& Fire)
+						{
+							return Fire.Value.Action == ArtIPMKey::StickFlick;
+						}));
+					Theirs.RemoveAll([](const TPair<ArtilleryTime, EventBufferInfo>& Fire)
+					{
+						return Fire.Value.Action == ArtIPMKey::StickFlick;
+					});
+				}
+
+				bool bSame = Ours.Num() == Theirs.Num();
+				for (int32 Index = 0; bSame && Index < Ours.Num(); ++Index)
+				{
+					bSame = Same(Ours[Index], Theirs[Index]);
+				}
+				if (!bSame)
+				{
+					++Mismatches;
+					AddError(FString::Printf(TEXT("%s, %d frames in, frame %d: the table fired %d events, the old patterns %d."),
+						*Script.Name, Lead, Frame, Ours.Num(), Theirs.Num()));
+				}
+				for (const TPair<ArtilleryTime, EventBufferInfo>& Fire : Ours)
+				{
+					Fired.Add(Fire.Value.Action);
+				}
+			}
+		}
+	}
+
+	//a kind that never fired wasn't compared at all.
+	for (const ArtIPMKey Kind : {ArtIPMKey::SingleFrameFire, ArtIPMKey::ButtonHold, ArtIPMKey::ButtonHoldAllowOneMiss,
+	                             ArtIPMKey::OnPress, ArtIPMKey::ButtonReleaseNoDelay, ArtIPMKey::StickFlick})
+	{
+		TestTrue(FString::Printf(TEXT("pattern kind %d fired somewhere"), static_cast<int32>(Kind)), Fired.Contains(Kind));
+	}
+	TestEqual(TEXT("frames where the table and the old patterns disagree"), Mismatches, 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CanonicalInputStreamECS.h"
+#include "Math/RandomStream.h"
+#include <thread>
+
+namespace ArtilleryConservedInputStreamTest
+{
+	static constexpr double Seconds = 2.0;
+	static constexpr int32 Readers = 3;
+
+	//every field of input N is written as N, so any shell whose fields disagree was torn.
+	static bool IsWhole(const FArtilleryShell& Shell, uint64 Input)
+	{
+		return Shell.MyInputActions == Input
+			&& static_cast<uint64>(Shell.SentAt) == static_cast<uint64>(static_cast<BristleTime>(Input))
+			&& Shell.ReachedArtilleryAt == Shell.SentAt;
+	}
+}
+
+//a writer publishes as fast as it can, which laps the ring every few milliseconds, and readers peek and range-read right
+//up against the margin. anything but zero torn is a bug.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FArtilleryConservedInputStreamTornReads, "Artillery.Inputs.ConservedStream.TornReads",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FArtilleryConservedInputStreamTornReads::RunTest(const FString& Parameters)
+{
+	using namespace ArtilleryConservedInputStreamTest;
+	UCanonicalInputStreamECS::FConservedInputStream Stream;
+	std::atomic<bool> bRunning{true};
+	std::atomic<uint64> Reads{0};
+	std::atomic<uint64> Rejected{0};
+	std::atomic<uint64> Torn{0};
+
+	std::thread Writer([&Stream, &bRunning]()
+	{
+		for (uint64 Input = 0; bRunning.load(std::memory_order_relaxed); ++Input)
+		{
+			Stream.Publish(Input, static_cast<BristleTime>(Input), static_cast<ArtilleryTime>(Input));
+		}
+	});
+	TArray<std::thread> ReaderThreads;
+	for (int32 Reader = 0; Reader < Readers; ++Reader)
+	{
+		ReaderThreads.Emplace([&, Reader]()
+		{
+			FRandomStream Random(Reader);
+			TArray<FArtilleryShell> Range;
+			while (bRunning.load(std::memory_order_relaxed))
+			{
+				const uint64 Highest = Stream.GetHighestInput();
+				//mostly the oldest addressable inputs, since that's where the writer is about to lap us.
+				const uint64 Back = Random.RandRange(1, UCanonicalInputStreamECS::AddressableInputConservationWindow);
+				if (Highest < Back)
+				{
+					continue;
+				}
+				const uint64 Input = Highest - Back;
+				if (Reader == 0)
+				{
+					Range.Reset();
+					const int32 Got = Stream.CopyRange(Input, Input + 64, Range);
+					for (int32 Index = 0; Index < Got; ++Index)
+					{
+						Torn.fetch_add(IsWhole(Range[Index], Input + Index) ? 0 : 1, std::memory_order_relaxed);
+					}
+					(Got ? Reads : Rejected).fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+				const std::optional<FArtilleryShell> Shell = Stream.peek(Input);
+				if (!Shell.has_value())
+				{
+					Rejected.fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+				Reads.fetch_add(1, std::memory_order_relaxed);
+				Torn.fetch_add(IsWhole(*Shell, Input) ? 0 : 1, std::memory_order_relaxed);
+			}
+		});
+	}
+
+	FPlatformProcess::Sleep(static_cast<float>(Seconds));
+	bRunning.store(false);
+	Writer.join();
+	for (std::thread& Reader : ReaderThreads)
+	{
+		Reader.join();
+	}
+	AddInfo(FString::Printf(TEXT("%llu inputs published, %llu reads, %llu turned away as lapped, %llu torn."),
+		Stream.GetHighestInput(), Reads.load(), Rejected.load(), Torn.load()));
+
+	//a writer that never lapped anyone, or readers that never got a read in, didn't test anything.
+	TestTrue(TEXT("the writer lapped the ring"), Stream.GetHighestInput() > UCanonicalInputStreamECS::InputConservationWindow);
+	TestTrue(TEXT("readers got reads in"), Reads.load() > 0);
+	TestEqual(TEXT("torn reads"), Torn.load(), static_cast<uint64>(0));
+	return true;
+}
+
+#endif
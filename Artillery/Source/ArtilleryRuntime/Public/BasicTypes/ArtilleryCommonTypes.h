@@ -84,6 +84,9 @@ namespace Arty
 	};
 	
 		
+	//how many ticks apart a ticklite runs. anything slower than Critical is spread across that many ticks, so its
+	//apply count, and any tick-based lifetime it keeps, stretches out by the same factor. if it needs to know how many
+	//ticks actually went by, it should diff GetTickliteTick, since a skipped sim tick skips the lanes due on it.
 	enum TickliteCadence
 	{
 		Critical = 1,
@@ -94,12 +97,15 @@ namespace Arty
 
 	struct TicklikeMemoryBlock
 	{
-		TickliteCadence Cadence = TickliteCadence::Lite;
+		//set before the add request. critical by default, since nothing written so far expects to be skipped.
+		TickliteCadence Cadence = TickliteCadence::Critical;
 		TicklitePhase RunGroup = TicklitePhase::Normal;
 		ArtilleryTime MadeStamp = 0;
 	};
 	struct TicklitePrototype : TicklikeMemoryBlock
 	{
+		//runs on the task pool, alongside the calculate of every other ticklite in the same phase. read what you like,
+		//but only write to your own state. anything that changes the world goes in apply.
 		virtual void CalculateTickable() = 0;
 		virtual bool ShouldExpireTickable() = 0;
 		
@@ -48,17 +48,22 @@ public:
 	bool RunAtLeastOnce = false; // if this is set, all artillery abilities spawned by running this input will be treated as having run at least once, and will not spawn cosmetic cues. Some animations may still play.
 	
 	//unpack as floats using the bristlecone packer logic. this is cross-machine deterministic.
-	float GetStickLeftX();
-	int32_t GetStickLeftXAsACSN();
-	float GetStickLeftY();
-	int32_t GetStickLeftYAsACSN();
-	float GetStickRightX();
-	int32_t GetStickRightXAsACSN();
-	float GetStickRightY();
-	int32_t GetStickRightYAsACSN();
+	float GetStickLeftX() const;
+	int32_t GetStickLeftXAsACSN() const;
+	float GetStickLeftY() const;
+	int32_t GetStickLeftYAsACSN() const;
+	float GetStickRightX() const;
+	int32_t GetStickRightXAsACSN() const;
+	float GetStickRightY() const;
+	int32_t GetStickRightYAsACSN() const;
 
-	bool GetInputAction(uint8 inputActionIndex);
-	uint32 GetButtonsAndEventsFlat();
+	bool GetInputAction(uint8 inputActionIndex) const;
+	//the pattern table calls this sixteen times a frame, so it lives here where it can inline.
+	uint32 GetButtonsAndEventsFlat() const
+	{
+		//0b1111 1111 1111 1111 1111 is 20 bits.
+		return MyInputActions & 0b11111111111111111111;
+	}
 private:
 	
 	//TODO ADD METHODS FOR GET STICKS, GET BUTTONS, GET EVENTS.
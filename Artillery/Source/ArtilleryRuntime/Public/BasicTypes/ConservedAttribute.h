@@ -7,13 +7,12 @@
 #include "UObject/UnrealType.h"
 #include "Engine/DataTable.h"
 #include "AttributeSet.h"
-#include "Containers/CircularBuffer.h"
 
 #include "ConservedAttribute.generated.h"
 /**
- * Conserved attributes record their last 128 changes.
- * Currently, this is for debug purposes, but we can use it with some additional features to provide a really expressive
- * model for rollback at a SUPER granular level if needed. 
+ * Conserved attributes used to record their last 128 changes each, in three rings of doubles.
+ * Live attributes are in FArtilleryAttributeStore now, and their history is the store's FArtilleryAttributeHistory,
+ * which only records what changed. This is kept as a plain value type for anything that still holds one.
  */
 
 //TODO: do we need to break the GAS dependency? It's forcing a lot of unneeded stuff.
@@ -21,18 +20,13 @@ USTRUCT(BlueprintType)
 struct ARTILLERYRUNTIME_API FConservedAttributeData : public FGameplayAttributeData
 {
 	GENERATED_BODY()
-	TCircularBuffer<double> CurrentHistory = TCircularBuffer<double>(128);
-	TCircularBuffer<double> RemoteHistory = TCircularBuffer<double>(128);
-	TCircularBuffer<double> BaseHistory = TCircularBuffer<double>(128);
 
 	virtual void SetCurrentValue(float NewValue) override {
 		SetCurrentValue(static_cast<double>(NewValue));
 	};
 
 	virtual void SetCurrentValue(double NewValue) {
-		CurrentHistory[CurrentHistory.GetNextIndex(CurrentHead)] = CurrentValue;
 		CurrentValue = NewValue;
-		++CurrentHead;
 	};
 
 	virtual void AddToCurrentValue(double AddValue)
@@ -45,8 +39,7 @@ struct ARTILLERYRUNTIME_API FConservedAttributeData : public FGameplayAttributeD
 	};
 	
 	virtual void SetRemoteValue(double NewValue) {
-		RemoteHistory[RemoteHistory.GetNextIndex(RemoteHead)] = NewValue;
-		++RemoteHead;
+		RemoteValue = NewValue;
 	};
 	
 	virtual void SetBaseValue(float NewValue) override {
@@ -54,9 +47,7 @@ struct ARTILLERYRUNTIME_API FConservedAttributeData : public FGameplayAttributeD
 	};
 
 	virtual void SetBaseValue(double NewValue) {
-		BaseHistory[BaseHistory.GetNextIndex(BaseHead)] = BaseValue;
 		BaseValue = NewValue;
-		++BaseHead;
 	};
 	double operator*(FConservedAttributeData const& rhs) 
 	{ 
@@ -71,8 +62,6 @@ struct ARTILLERYRUNTIME_API FConservedAttributeData : public FGameplayAttributeD
 		return CurrentValue * rhs; // this is a double op.
 	}
 protected:
-	uint64_t BaseHead = 0;
-	uint64_t CurrentHead = 0;
-	uint64_t RemoteHead = 0;
+	double RemoteValue = 0;
 };
 
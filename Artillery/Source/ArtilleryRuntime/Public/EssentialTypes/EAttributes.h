@@ -1,6 +1,7 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "ConservedAttribute.h"
+#include "ArtilleryAttributeStore.h"
 
 #include "ConservedKey.h"
 #include "ConservedVector.h"
@@ -38,6 +39,9 @@ enum class E_AttribKey : uint8
 	LastFiredTimestamp,
 	TriggerPulled,
 };
+//keep TriggerPulled last, or move this along with it.
+constexpr int32 NUM_ATTRIB_KEYS = static_cast<int32>(E_AttribKey::TriggerPulled) + 1;
+static_assert(NUM_ATTRIB_KEYS <= FArtilleryAttributeStore::MaxAttribs, "the attribute store keeps presence in a uint32.");
 
 UENUM(BlueprintType, Blueprintable)
 enum class E_IdentityAttrib : uint8
@@ -113,7 +117,8 @@ namespace Arty
 	constexpr AttribKey RELOAD_REMAINING = Arty::AttribKey::ReloadTimeRemaining;
 	constexpr AttribKey TICKS_SINCE_GUN_LAST_FIRED = Arty::AttribKey::TicksSinceLastFired;
 	constexpr AttribKey TRIGGER_PULLED = Arty::AttribKey::TriggerPulled;
-	typedef TSharedPtr<FConservedAttributeData> AttrPtr;
+	//a handle into UArtilleryDispatch's attribute store. null checks and -> work like the shared pointer it replaced.
+	typedef FAttributeHandle AttrPtr;
 	typedef TSharedPtr<FConservedAttributeKey> IdentPtr;
 	typedef TSharedPtr<FConservedVector> Attr3Ptr;
 	typedef TMap<AttribKey, AttrPtr> AttributeMap;
@@ -126,6 +131,6 @@ namespace Arty
 }
 
 #if ENABLE_VISUAL_LOG
-#define VISLOG_ATTRIBUTE(artillery_dispatch, key, attribute) if (FVisualLogger::IsRecording()) UE_VLOG(GetOwner(), LogPawnAction, Log, TEXT("%s> " #attribute ": %f"),*GetName(), artillery_dispatch->GetAttr(key, attribute)->CurrentValue)
+#define VISLOG_ATTRIBUTE(artillery_dispatch, key, attribute) if (FVisualLogger::IsRecording()) UE_VLOG(GetOwner(), LogPawnAction, Log, TEXT("%s> " #attribute ": %f"),*GetName(), artillery_dispatch->GetAttrib(key, attribute)->GetCurrentValue())
 #define VISLOG_VEC_ATTRIBUTE(artillery_dispatch, key, attribute) if (FVisualLogger::IsRecording()) UE_VLOG(GetOwner(), LogPawnAction, Log, TEXT("%s> " #attribute ": %s"),*GetName(), *artillery_dispatch->GetVecAttr(key, attribute)->CurrentValue.ToString())
 #endif // ENABLE_VISUAL_LOG
\ No newline at end of file
@@ -14,7 +14,8 @@ struct ARTILLERYRUNTIME_API FAttributeMap
 {
 	GENERATED_BODY()
 	
-	AttrMapPtr MyAttributes;
+	//our row in the dispatch's attribute store.
+	uint32 Row = FArtilleryAttributeStore::InvalidRow;
 	FSkeletonKey ParentKey;
 	UArtilleryDispatch* MyDispatch = nullptr;
 	bool ReadyToUse = false;
@@ -35,26 +36,17 @@ struct ARTILLERYRUNTIME_API FAttributeMap
 		this->ParentKey = ParentKeyIn;
 		this->MyDispatch = MyDispatchIn;
 
-		this->MyAttributes = MakeShareable(new AttributeMap());
-		
 		//TODO: swap this to loading values from a data table, and REMOVE this fallback.
 		//If we want defaults, those defaults should ALSO live in a data table, that way when a defaulting bug screws us
 		//maybe we can fix it without going through a full cert using a data only update.
-		for(auto x : DefaultAttributesIn)
-		{
-			MyAttributes->Add(x.Key, MakeShareable(new FConservedAttributeData));
-			MyAttributes->FindChecked(x.Key)->SetBaseValue(x.Value);
-			MyAttributes->FindChecked(x.Key)->SetCurrentValue(x.Value);
-		}
-
-		MyDispatch->RegisterAttributes(ParentKey, MyAttributes);
+		Row = MyDispatch->RegisterAttributes(ParentKey, DefaultAttributesIn);
 
-		ReadyToUse = true;
+		ReadyToUse = Row != FArtilleryAttributeStore::InvalidRow;
 	};
 	
 	~FAttributeMap()
 	{
-		if (MyAttributes != nullptr)
+		if (Row != FArtilleryAttributeStore::InvalidRow && MyDispatch)
 		{
 			MyDispatch->DeregisterAttributes(ParentKey);
 		}
@@ -0,0 +1,100 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "ArtilleryCommonTypes.h"
+
+namespace Arty
+{
+	//cadence, as lanes. a ticklite with cadence N sits in one of N lanes, and lane k of that cadence only runs on ticks
+	//where tick % N == k, so Lite work is an eighth of the lanes each tick and Slow a thirty-second. critical has one
+	//lane that runs every tick. new ticklites go in the emptiest lane of their cadence, which is what keeps it even.
+	//the tick is the busy worker's sim tick, not a count of ticklite passes, so lanes come due on the same ticks
+	//everywhere and a tick the sim skips doesn't shift every lane after it.
+	struct FTickliteLanes
+	{
+		static constexpr int32 CadenceCount = 4;
+		static constexpr int32 Periods[CadenceCount] = {Critical, Tick, Lite, Slow};
+		static constexpr int32 FirstLanes[CadenceCount] = {0, Critical, Critical + Tick, Critical + Tick + Lite};
+		static constexpr int32 LaneCount = Critical + Tick + Lite + Slow;
+
+		static int32 CadenceIndexOf(TickliteCadence Cadence)
+		{
+			switch (Cadence)
+			{
+			case TickliteCadence::Tick : return 1;
+			case TickliteCadence::Lite : return 2;
+			case TickliteCadence::Slow : return 3;
+			default: return 0;
+			}
+		}
+
+		static int32 DueLane(int32 CadenceIndex, uint64 TickNumber)
+		{
+			return FirstLanes[CadenceIndex] + static_cast<int32>(TickNumber % Periods[CadenceIndex]);
+		}
+	};
+
+	//what a tick's worth of ticklites looked like, by cadence. Ran counts everything in a lane that came due,
+	//expiring or not. BusiestLane against Live / period shows how even the spread is.
+	struct FTickliteCadenceLoad
+	{
+		int32 Live[FTickliteLanes::CadenceCount] = {};
+		int32 Ran[FTickliteLanes::CadenceCount] = {};
+		int32 BusiestLane[FTickliteLanes::CadenceCount] = {};
+	};
+
+	template <typename ElementType>
+	class TTickliteLaneSet
+	{
+	public:
+		ElementType& Add(ElementType&& Element, TickliteCadence Cadence)
+		{
+			const int32 CadenceIndex = FTickliteLanes::CadenceIndexOf(Cadence);
+			int32 Emptiest = FTickliteLanes::FirstLanes[CadenceIndex];
+			for (int32 Lane = Emptiest + 1; Lane < Emptiest + FTickliteLanes::Periods[CadenceIndex]; ++Lane)
+			{
+				Emptiest = Lanes[Lane].Num() < Lanes[Emptiest].Num() ? Lane : Emptiest;
+			}
+			return Lanes[Emptiest].Add_GetRef(MoveTemp(Element));
+		}
+
+		//one lane per cadence, in cadence order.
+		template <typename Fn>
+		void ForEachDueLane(uint64 TickNumber, Fn&& Body)
+		{
+			for (int32 CadenceIndex = 0; CadenceIndex < FTickliteLanes::CadenceCount; ++CadenceIndex)
+			{
+				Body(CadenceIndex, Lanes[FTickliteLanes::DueLane(CadenceIndex, TickNumber)]);
+			}
+		}
+
+		//the lanes due on TickNumber that weren't due on Calculated. for when calculate guessed the next tick wrong.
+		template <typename Fn>
+		void ForEachLaneDueInstead(uint64 TickNumber, uint64 Calculated, Fn&& Body)
+		{
+			for (int32 CadenceIndex = 0; CadenceIndex < FTickliteLanes::CadenceCount; ++CadenceIndex)
+			{
+				const int32 Lane = FTickliteLanes::DueLane(CadenceIndex, TickNumber);
+				if (Lane != FTickliteLanes::DueLane(CadenceIndex, Calculated))
+				{
+					Body(CadenceIndex, Lanes[Lane]);
+				}
+			}
+		}
+
+		void AddLoad(FTickliteCadenceLoad& Load) const
+		{
+			for (int32 CadenceIndex = 0; CadenceIndex < FTickliteLanes::CadenceCount; ++CadenceIndex)
+			{
+				const int32 First = FTickliteLanes::FirstLanes[CadenceIndex];
+				for (int32 Lane = First; Lane < First + FTickliteLanes::Periods[CadenceIndex]; ++Lane)
+				{
+					Load.Live[CadenceIndex] += Lanes[Lane].Num();
+					Load.BusiestLane[CadenceIndex] = FMath::Max(Load.BusiestLane[CadenceIndex], Lanes[Lane].Num());
+				}
+			}
+		}
+
+	private:
+		TArray<ElementType> Lanes[FTickliteLanes::LaneCount];
+	};
+}
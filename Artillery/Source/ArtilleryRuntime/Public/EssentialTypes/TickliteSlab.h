@@ -0,0 +1,145 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "Ticklite.h"
+#include "TickliteLanes.h"
+#include <atomic>
+
+namespace Arty
+{
+	//pooled ticklites live by value, one slab per concrete Ticklite<Impl> type per phase, rather than each one being
+	//its own allocation behind a shared pointer. slots vacated by expiry are refilled by later adds, and the slab
+	//never shrinks, so a steady stream of short-lived projectile ticklites settles into zero allocations.
+	//the worker only sees this interface. everything under it is statically dispatched.
+	//slabs are TArrays, so they get memmoved when they grow or swap down. whatever you pool has to be fine with that,
+	//which rules out std::function members and anything else that points into itself. those stay on the shared path.
+	class ITickliteSlab
+	{
+	public:
+		virtual ~ITickliteSlab() = default;
+		//ticklites thread only. moves queued adds into the slab and gives them their first calculate.
+		virtual void AdoptPending() = 0;
+		//only the lanes due on TickNumber.
+		virtual void CalculateDue(uint64 TickNumber, int32 MinPerBatch) = 0;
+		//the lanes due on TickNumber that weren't due on Calculated. see TTickliteLaneSet::ForEachLaneDueInstead.
+		virtual void CalculateDueInstead(uint64 TickNumber, uint64 Calculated, int32 MinPerBatch) = 0;
+		//ticklites thread only. applies or expires every ticklite in the due lanes, in slab order.
+		virtual void ApplyDue(uint64 TickNumber, FTickliteCadenceLoad& Load) = 0;
+		virtual void AddLoad(FTickliteCadenceLoad& Load) const = 0;
+	};
+
+	template <typename TicklikeType>
+	class TTickliteSlab final : public ITickliteSlab
+	{
+	public:
+		//any thread.
+		void Add(TicklikeType&& ToAdd)
+		{
+			FScopeLock Lock(&PendingLock);
+			Pending.Add(MoveTemp(ToAdd));
+		}
+
+		virtual void AdoptPending() override
+		{
+			{
+				FScopeLock Lock(&PendingLock);
+				Swap(Pending, Adopting);
+			}
+			for (TicklikeType& Added : Adopting)
+			{
+				const TickliteCadence Cadence = Added.Cadence;
+				Calc(Live.Add(MoveTemp(Added), Cadence));
+			}
+			Adopting.Reset();
+		}
+
+		virtual void CalculateDue(uint64 TickNumber, int32 MinPerBatch) override
+		{
+			Live.ForEachDueLane(TickNumber, [MinPerBatch](int32, TArray<TicklikeType>& Lane)
+			{
+				CalcLane(Lane, MinPerBatch);
+			});
+		}
+
+		virtual void CalculateDueInstead(uint64 TickNumber, uint64 Calculated, int32 MinPerBatch) override
+		{
+			Live.ForEachLaneDueInstead(TickNumber, Calculated, [MinPerBatch](int32, TArray<TicklikeType>& Lane)
+			{
+				CalcLane(Lane, MinPerBatch);
+			});
+		}
+
+		virtual void ApplyDue(uint64 TickNumber, FTickliteCadenceLoad& Load) override
+		{
+			Live.ForEachDueLane(TickNumber, [&Load](int32 CadenceIndex, TArray<TicklikeType>& Lane)
+			{
+				Load.Ran[CadenceIndex] += Lane.Num();
+				for (int32 Index = 0; Index < Lane.Num();)
+				{
+					TicklikeType& Tickable = Lane[Index];
+					if (Tickable.TicklikeType::ShouldExpireTickable())
+					{
+						Tickable.TicklikeType::OnExpireTickable();
+						//same swap-down as the shared pointer groups, so the same ordering caveats apply.
+						Lane.RemoveAtSwap(Index, EAllowShrinking::No);
+					}
+					else
+					{
+						Tickable.TicklikeType::ApplyTickable();
+						++Index;
+					}
+				}
+			});
+		}
+
+		virtual void AddLoad(FTickliteCadenceLoad& Load) const override
+		{
+			Live.AddLoad(Load);
+		}
+
+	private:
+		static void CalcLane(TArray<TicklikeType>& Lane, int32 MinPerBatch)
+		{
+			ParallelFor(TEXT("Ticklites.CalculateSlab"), Lane.Num(), MinPerBatch, [&Lane](int32 Index)
+			{
+				Calc(Lane[Index]);
+			});
+		}
+
+		static void Calc(TicklikeType& Tickable)
+		{
+			//qualified calls don't go through the vtable. everything in here is exactly this type.
+			if (!Tickable.TicklikeType::ShouldExpireTickable())
+			{
+				Tickable.TicklikeType::CalculateTickable();
+			}
+		}
+
+		TTickliteLaneSet<TicklikeType> Live;
+		TArray<TicklikeType> Pending;
+		TArray<TicklikeType> Adopting;
+		FCriticalSection PendingLock;
+	};
+
+	//every pooled ticklite type gets a small dense index the first time it's used, which is where its slab goes.
+	struct FTickliteSlabTypes
+	{
+		static constexpr int32 MaxTypes = 64;
+
+		template <typename TicklikeType>
+		static int32 IndexOf()
+		{
+			static const int32 Index = Registered.fetch_add(1);
+			checkf(Index < MaxTypes, TEXT("Artillery: more pooled ticklite types than FTickliteSlabTypes::MaxTypes."));
+			return Index;
+		}
+
+		static int32 Num()
+		{
+			return FMath::Min(Registered.load(std::memory_order_acquire), MaxTypes);
+		}
+
+	private:
+		static inline std::atomic<int32> Registered{0};
+	};
+}
@@ -11,6 +11,17 @@
 #include <thread>
 #include "AInstancedMeshManager.generated.h"
 
+//one instance to make in a burst. see AInstancedMeshManager::CreateNewInstances.
+struct FInstancedMeshSpawn
+{
+	//left invalid, one gets generated.
+	FSkeletonKey Key = FSkeletonKey::Invalid();
+	FTransform WorldTransform;
+	FVector3d MuzzleVelocity = FVector3d::ZeroVector;
+	uint16 Layer = 0;
+	float Scale = 1.0f;
+};
+
 UCLASS()
 class ARTILLERYRUNTIME_API AInstancedMeshManager : public AActor
 {
@@ -129,6 +140,20 @@ public:
 		return NewInstanceKey;
 	}
 
+	//CreateNewInstance for a whole volley or wave. the bodies go to barrage as one batch per layer instead of one add
+	//each, which is most of what spawning a burst used to cost. keys left invalid are filled in.
+	void CreateNewInstances(TArrayView<FInstancedMeshSpawn> Spawns)
+	{
+		for (FInstancedMeshSpawn& Spawn : Spawns)
+		{
+			Spawn.Key = Spawn.Key == FSkeletonKey::Invalid() ? GenerateNewProjectileKey() : Spawn.Key;
+			auto ScaledTransform = FTransform(FRotator::ZeroRotator, Spawn.WorldTransform.GetLocation(), FVector3d(Spawn.Scale, Spawn.Scale, Spawn.Scale));
+			FPrimitiveInstanceId NewInstanceId = SwarmKineManager->AddInstanceById(ScaledTransform, true);
+			SwarmKineManager->AddToMapDbg(NewInstanceId, Spawn.Key);
+		}
+		CreateNewInstancesWithKeysInternal(Spawns);
+	}
+
 	//TODO: this really really really should return a fblet or a kine OR make it impossible to get a FBlet or kine for that scene component.
 	//we do not ever want scene components that are managed in two or more ways.
 	TWeakObjectPtr<USceneComponent> GetSceneComponentForInstance(const FSkeletonKey InstanceKey)
@@ -149,15 +174,59 @@ private:
 	{
 		// TODO: can't use the BarrageColliderBase set of types, so in-lining the barrage setup code. Is this what we want long-term?
 		auto Physics = GetWorld()->GetSubsystem<UBarrageDispatch>();
+		auto params = MakeBounds(WorldTransform, Scale);
+		
+		FBLet MyBarrageBody = Physics->CreateProjectile(params, ProjectileKey, Layer);
+
+		FinishInstance(ProjectileKey, MuzzleVelocity, MyBarrageBody);
+	}
+
+	void CreateNewInstancesWithKeysInternal(TArrayView<const FInstancedMeshSpawn> Spawns) const
+	{
+		auto Physics = GetWorld()->GetSubsystem<UBarrageDispatch>();
+		//the batch takes one layer. a burst is nearly always all one layer, so this is nearly always one batch.
+		TArray<uint16, TInlineAllocator<4>> Layers;
+		for (const FInstancedMeshSpawn& Spawn : Spawns)
+		{
+			Layers.AddUnique(Spawn.Layer);
+		}
+		TArray<FBBoxParams> Params;
+		TArray<FSkeletonKey> Keys;
+		TArray<int32> Indices;
+		for (const uint16 Layer : Layers)
+		{
+			Params.Reset();
+			Keys.Reset();
+			Indices.Reset();
+			for (int32 Index = 0; Index < Spawns.Num(); ++Index)
+			{
+				if (Spawns[Index].Layer == Layer)
+				{
+					Params.Add(MakeBounds(Spawns[Index].WorldTransform, Spawns[Index].Scale));
+					Keys.Add(Spawns[Index].Key);
+					Indices.Add(Index);
+				}
+			}
+			TArray<FBLet> Bodies = Physics->CreateProjectiles(Params, Keys, Layer);
+			for (int32 Made = 0; Made < Indices.Num(); ++Made)
+			{
+				FinishInstance(Keys[Made], Spawns[Indices[Made]].MuzzleVelocity, Bodies.IsValidIndex(Made) ? Bodies[Made] : nullptr);
+			}
+		}
+	}
+
+	FBBoxParams MakeBounds(const FTransform& WorldTransform, float Scale) const
+	{
 		auto AnyMesh = SwarmKineManager->GetStaticMesh();
 		auto Boxen = AnyMesh->GetBoundingBox();
 		auto extents = Boxen.GetExtent() * 2 * Scale;
 
-		auto params = FBarrageBounder::GenerateBoxBounds(WorldTransform.GetLocation(), extents.X, extents.Y, extents.Z,
+		return FBarrageBounder::GenerateBoxBounds(WorldTransform.GetLocation(), extents.X, extents.Y, extents.Z,
 			FVector3d(0, 0, extents.Z/2));
-		
-		FBLet MyBarrageBody = Physics->CreateProjectile(params, ProjectileKey, Layer);
+	}
 
+	void FinishInstance(FSkeletonKey ProjectileKey, const FVector3d& MuzzleVelocity, FBLet MyBarrageBody) const
+	{
 		TransformDispatch->RegisterObjectToShadowTransform(ProjectileKey, SwarmKineManager);
 		FBarragePrimitive::SetVelocity(MuzzleVelocity, MyBarrageBody);
 
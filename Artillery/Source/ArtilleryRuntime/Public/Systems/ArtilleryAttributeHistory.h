@@ -0,0 +1,102 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//which of an attribute's values. remote is the last value someone else told us about.
+enum class EAttributeValue : uint8
+{
+	Current,
+	Base,
+	Remote
+};
+static constexpr int32 NUM_ATTRIBUTE_VALUES = 3;
+
+struct FArtilleryAttributeHistoryStats
+{
+	uint64 Commits = 0;
+	uint64 OldestTick = 0;
+	uint64 NewestTick = 0;
+	int32 DeltasLastCommit = 0;
+	int32 DeltasInWindow = 0;
+	int32 Keyframes = 0;
+	int32 KeyframeRows = 0;
+	SIZE_T Bytes = 0;
+};
+
+//every conserved attribute used to carry three full 128 deep rings, written on every set, whether or not anything
+//ever changed. with a few hundred enemies that was most of what an entity weighed, and most attributes sit still.
+//
+//this keeps one history for the whole attribute store instead. each commit records only the values that changed
+//since the last one, as sparse deltas, and every artillery.Attributes.KeyframeInterval commits it also writes a
+//keyframe of every live row. to get a value at a tick, start from the newest keyframe at or before it and replay the
+//deltas after. anything within WindowTicks commits of the newest is always reconstructable.
+//
+//busy worker only. the store commits into it from there, and rollback reads it from there.
+class ARTILLERYRUNTIME_API FArtilleryAttributeHistory
+{
+public:
+	//commits back from the newest that stay reconstructable. the old per-attribute rings were 128 deep.
+	static constexpr uint32 WindowTicks = 128;
+	static constexpr uint32 MinKeyframeInterval = 4;
+	//deltas have to outlive the oldest keyframe we'd still start from, which is at most a window and an interval back.
+	static constexpr uint32 DeltaSlots = 2 * WindowTicks;
+	static constexpr uint32 KeyframeSlots = WindowTicks / MinKeyframeInterval + 2;
+
+	//a commit is BeginCommit, then any number of AddDelta in row order, then a keyframe if it wants one.
+	void BeginCommit(uint64 Tick);
+	void AddDelta(uint32 Row, uint32 Generation, uint8 Attrib, EAttributeValue Which, float Value);
+	//true if this commit should end with a keyframe.
+	bool WantsKeyframe() const;
+	void BeginKeyframe();
+	//rows have to come in ascending order. Values holds NUM_ATTRIBUTE_VALUES floats per bit set in Present, lowest
+	//attribute first, in EAttributeValue order.
+	void AddKeyframeRow(uint32 Row, uint32 Generation, uint32 Present, TConstArrayView<float> Values);
+
+	//the value Row had for Attrib as of the commit stamped Tick, or the last commit before it. false if that's out of
+	//the window, or the row hadn't been given that attribute yet.
+	bool Reconstruct(uint32 Row, uint32 Generation, uint8 Attrib, EAttributeValue Which, uint64 Tick, float& Out) const;
+
+	FArtilleryAttributeHistoryStats GetStats() const;
+
+private:
+	struct FDelta
+	{
+		uint32 Row = 0;
+		uint32 Generation = 0;
+		uint8 Attrib = 0;
+		EAttributeValue Which = EAttributeValue::Current;
+		float Value = 0;
+	};
+	struct FDeltaSlot
+	{
+		uint64 Commit = 0;
+		uint64 Tick = 0;
+		//sorted by row, since the store commits in row order.
+		TArray<FDelta> Deltas;
+	};
+	struct FKeyframeRow
+	{
+		uint32 Row = 0;
+		uint32 Generation = 0;
+		uint32 Present = 0;
+		int32 FirstValue = 0;
+	};
+	struct FKeyframe
+	{
+		uint64 Commit = 0;
+		uint64 Tick = 0;
+		bool bValid = false;
+		TArray<FKeyframeRow> Rows;
+		TArray<float> Values;
+	};
+
+	const FKeyframe* NewestKeyframeAtOrBefore(uint64 Tick) const;
+	bool StillHasDeltasAfter(uint64 Commit) const;
+
+	FDeltaSlot Slots[DeltaSlots];
+	FKeyframe Keyframes[KeyframeSlots];
+	//commits are numbered from 1. the busy worker doesn't commit every slot, so ticks aren't contiguous, but these are.
+	uint64 Commits = 0;
+	uint64 LastKeyframeCommit = 0;
+	int32 NextKeyframe = 0;
+};
@@ -0,0 +1,321 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SkeletonTypes.h"
+#include "ArtilleryAttributeHistory.h"
+#include <atomic>
+THIRD_PARTY_INCLUDES_START
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+#include "libcuckoo/cuckoohash_map.hh"
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+THIRD_PARTY_INCLUDES_END
+
+class FAttributeHandle;
+
+//attributes used to be a TMap of TSharedPtr<FConservedAttributeData> per entity, registered in a cuckoo map, with
+//three 128 deep histories hanging off every single attribute. reading one meant a cuckoo find, a TMap find, and two
+//pointer hops, and that's the most common thing a ticklite does.
+//
+//this keeps them by column instead. every entity that registers attributes claims a dense row, stable for as long as
+//it's registered. rows live in pages that never move, and each page holds one contiguous array per attribute, so
+//Current[Health] for two hundred enemies is two hundred floats in a row. a lookup is one cuckoo find to get the row,
+//then indexing. history is one FArtilleryAttributeHistory for the whole store, instead of three rings per attribute.
+//writes just mark the attribute dirty, and the busy worker's commit each tick turns whatever's dirty into deltas.
+//
+//any thread may register, deregister, read and write. a deregistered row bumps its generation before it can be
+//claimed again, so a handle that outlives its entity goes invalid instead of pointing at whoever gets the row next.
+//values are plain floats, same as the gameplay attribute data they replace, so concurrent writers to the same
+//attribute race exactly as much as they used to.
+class ARTILLERYRUNTIME_API FArtilleryAttributeStore
+{
+public:
+	static constexpr uint32 PageSize = 256;
+	static constexpr uint32 MaxPages = 256;
+	//presence is a bitmask per row, so this is as wide as that. E_AttribKey checks it fits.
+	static constexpr int32 MaxAttribs = 32;
+	static constexpr uint32 InvalidRow = ~0u;
+
+	struct FPage
+	{
+		float Current[MaxAttribs][PageSize];
+		float Base[MaxAttribs][PageSize];
+		float Remote[MaxAttribs][PageSize];
+		//one bit per attribute, per EAttributeValue, set by writes and cleared by Commit.
+		std::atomic<uint32> Dirty[NUM_ATTRIBUTE_VALUES][PageSize];
+		std::atomic<uint32> Present[PageSize];
+		std::atomic<uint32> Generation[PageSize];
+		std::atomic<uint8> State[PageSize];
+		FSkeletonKey Owner[PageSize];
+
+		FPage();
+		float& Column(EAttributeValue Which, uint8 Attrib, uint32 InPage)
+		{
+			return Which == EAttributeValue::Current ? Current[Attrib][InPage]
+				: Which == EAttributeValue::Base ? Base[Attrib][InPage] : Remote[Attrib][InPage];
+		}
+	};
+
+	FArtilleryAttributeStore();
+	~FArtilleryAttributeStore();
+
+	//registering is three steps, so the attributes are all there before anyone can find them.
+	//Claim takes a row, Init fills in one attribute, and Bind makes the row findable under Owner, replacing and
+	//releasing whatever row Owner had before. InvalidRow from Claim means we're full.
+	uint32 Claim(FSkeletonKey Owner);
+	void Init(uint32 Row, uint8 Attrib, float Value);
+	void Bind(FSkeletonKey Owner, uint32 Row);
+	//false if Owner had no attributes.
+	bool Deregister(FSkeletonKey Owner);
+
+	uint32 FindRow(FSkeletonKey Owner) const
+	{
+		uint32 Row = InvalidRow;
+		KeyToRow.find(Owner, Row);
+		return Row;
+	}
+	//invalid if Owner isn't registered or doesn't have Attrib.
+	FAttributeHandle Find(FSkeletonKey Owner, uint8 Attrib);
+	FAttributeHandle At(uint32 Row, uint8 Attrib);
+	//which attributes a row has, one bit each.
+	uint32 PresentMask(uint32 Row) const
+	{
+		const FPage* Page = PageOf(Row);
+		return Page ? Page->Present[Row % PageSize].load(std::memory_order_acquire) : 0;
+	}
+
+	//busy worker only, once a tick, before ticklites apply. everything written since the last commit goes into the
+	//history as of Tick, and every so often a keyframe of the lot.
+	void Commit(uint64 InTick);
+	uint64 GetTick() const
+	{
+		return Tick.load(std::memory_order_relaxed);
+	}
+	//what Owner's Attrib was as of the commit for Tick, if that's still in the window. busy worker only, like Commit.
+	bool ValueAt(FSkeletonKey Owner, uint8 Attrib, EAttributeValue Which, uint64 AtTick, float& Out) const;
+	FArtilleryAttributeHistoryStats GetHistoryStats() const
+	{
+		return History.GetStats();
+	}
+
+	//rollback. while a replay's on, each live current value reads as it was committed the tick before the one being
+	//replayed, until the replay writes it, and from then on the replay's value carries. EndReplay puts the live value
+	//back wherever the replay never wrote, and leaves what it did write to go in with the next commit. the history
+	//isn't touched. busy worker only, between commits, like Commit.
+	void BeginReplay();
+	void ReplayTick(uint64 AtTick);
+	void EndReplay();
+
+	int32 Num() const
+	{
+		return LiveCount.load(std::memory_order_relaxed);
+	}
+	uint32 PagesInUse() const;
+
+private:
+	enum : uint8
+	{
+		Free,
+		Claimed,
+		Live
+	};
+
+	FPage* PageOf(uint32 Row) const
+	{
+		return Row < PageSize * MaxPages ? Pages[Row / PageSize].load(std::memory_order_acquire) : nullptr;
+	}
+	FPage* EnsurePage(uint32 Row);
+	void Release(uint32 Row);
+
+	libcuckoo::cuckoohash_map<FSkeletonKey, uint32> KeyToRow;
+	std::atomic<FPage*> Pages[MaxPages] = {};
+	//no free row below this. only a hint; claiming still CASes.
+	std::atomic<uint32> FirstMaybeFree{0};
+	std::atomic<int32> LiveCount{0};
+	//one past the highest row ever claimed, so Commit doesn't walk pages nobody's used.
+	std::atomic<uint32> HighWater{0};
+
+	std::atomic<uint64> Tick{0};
+	FArtilleryAttributeHistory History;
+
+	//values as float bits, so a compare exchange can tell whether anyone else wrote in between.
+	struct FReplayed
+	{
+		uint32 Row = 0;
+		uint32 Generation = 0;
+		uint8 Attrib = 0;
+		int32 Live = 0;
+		int32 Replayed = 0;
+		bool bWritten = false;
+	};
+	static bool SwapBits(float& Value, int32 From, int32 To);
+	TArray<FReplayed> Replaying;
+	bool bReplaying = false;
+};
+
+//what GetAttrib hands out. it used to be a TSharedPtr<FConservedAttributeData>, and this keeps the parts of that
+//anyone used: null checks, IsValid, and -> to get and set values. it's a row, a column and a generation, so it's cheap
+//to copy and doesn't keep anything alive. don't hang on to one across ticks; look it up again.
+class FAttributeHandle
+{
+public:
+	FAttributeHandle()
+	{
+	}
+
+	FAttributeHandle(std::nullptr_t)
+	{
+	}
+
+	FAttributeHandle(FArtilleryAttributeStore::FPage* InPage, uint32 InRow, uint32 InGeneration, uint8 InAttrib)
+		: Page(InPage), Row(InRow), Generation(InGeneration), Attrib(InAttrib)
+	{
+	}
+
+	//false once the entity is deregistered, even if something else has the row by now.
+	bool IsValid() const
+	{
+		return Page && Page->Generation[InPage()].load(std::memory_order_acquire) == Generation;
+	}
+	explicit operator bool() const
+	{
+		return IsValid();
+	}
+	bool operator==(std::nullptr_t) const
+	{
+		return !IsValid();
+	}
+	bool operator!=(std::nullptr_t) const
+	{
+		return IsValid();
+	}
+	//so AttrPtr->GetCurrentValue() still reads the way it did.
+	const FAttributeHandle* operator->() const
+	{
+		return this;
+	}
+
+	//stale handles read as zero and drop writes, including ones that go stale mid-write.
+	float GetCurrentValue() const
+	{
+		return IsValid() ? Page->Current[Attrib][InPage()] : 0.f;
+	}
+	float GetBaseValue() const
+	{
+		return IsValid() ? Page->Base[Attrib][InPage()] : 0.f;
+	}
+	float GetRemoteValue() const
+	{
+		return IsValid() ? Page->Remote[Attrib][InPage()] : 0.f;
+	}
+	void SetCurrentValue(double NewValue) const
+	{
+		Write(EAttributeValue::Current, NewValue);
+	}
+	void AddToCurrentValue(double AddValue) const
+	{
+		SetCurrentValue(GetCurrentValue() + AddValue);
+	}
+	void SetBaseValue(double NewValue) const
+	{
+		Write(EAttributeValue::Base, NewValue);
+	}
+	void SetRemoteValue(double NewValue) const
+	{
+		Write(EAttributeValue::Remote, NewValue);
+	}
+
+	uint32 GetRow() const
+	{
+		return Row;
+	}
+	uint8 GetAttrib() const
+	{
+		return Attrib;
+	}
+
+private:
+	uint32 InPage() const
+	{
+		return Row % FArtilleryAttributeStore::PageSize;
+	}
+	//the row can be released and claimed by someone else between the IsValid and the write, so the generation is
+	//checked again after. if it moved, the write is taken back, unless the new owner already wrote over it, in which
+	//case theirs stands either way. that's why it's a compare exchange and not a store.
+	void Write(EAttributeValue Which, double NewValue) const
+	{
+		if (!IsValid())
+		{
+			return;
+		}
+		int32* Bits = reinterpret_cast<int32*>(&Page->Column(Which, Attrib, InPage()));
+		const float AsFloat = static_cast<float>(NewValue);
+		int32 New;
+		FMemory::Memcpy(&New, &AsFloat, sizeof(New));
+		for (;;)
+		{
+			const int32 Old = FPlatformAtomics::AtomicRead(Bits);
+			if (!IsValid())
+			{
+				return;
+			}
+			if (FPlatformAtomics::InterlockedCompareExchange(Bits, New, Old) != Old)
+			{
+				//another write to the same attribute got in first. go again, so the last one still wins.
+				continue;
+			}
+			if (IsValid())
+			{
+				MarkDirty(Which);
+			}
+			else
+			{
+				FPlatformAtomics::InterlockedCompareExchange(Bits, Old, New);
+			}
+			return;
+		}
+	}
+	//after the value, so a commit that clears the bit is sure to see the write that set it.
+	void MarkDirty(EAttributeValue Which) const
+	{
+		Page->Dirty[static_cast<int32>(Which)][InPage()].fetch_or(1u << Attrib, std::memory_order_release);
+	}
+
+	FArtilleryAttributeStore::FPage* Page = nullptr;
+	uint32 Row = FArtilleryAttributeStore::InvalidRow;
+	uint32 Generation = 0;
+	uint8 Attrib = 0;
+};
+
+inline FAttributeHandle FArtilleryAttributeStore::At(uint32 Row, uint8 Attrib)
+{
+	FPage* Page = PageOf(Row);
+	if (!Page || Attrib >= MaxAttribs)
+	{
+		return nullptr;
+	}
+	const uint32 InPage = Row % PageSize;
+	//generation first. if the row is released after this, the handle just goes stale.
+	const uint32 Generation = Page->Generation[InPage].load(std::memory_order_acquire);
+	if (Page->State[InPage].load(std::memory_order_acquire) != Live
+		|| !(Page->Present[InPage].load(std::memory_order_relaxed) & (1u << Attrib)))
+	{
+		return nullptr;
+	}
+	return FAttributeHandle(Page, Row, Generation, Attrib);
+}
+
+inline FAttributeHandle FArtilleryAttributeStore::Find(FSkeletonKey Owner, uint8 Attrib)
+{
+	const uint32 Row = FindRow(Owner);
+	if (Row == InvalidRow)
+	{
+		return nullptr;
+	}
+	FAttributeHandle Handle = At(Row, Attrib);
+	//Owner could have let go of the row between the find and now, and someone else taken it.
+	if (Handle.IsValid() && PageOf(Row)->Owner[Row % PageSize] != Owner)
+	{
+		return nullptr;
+	}
+	return Handle;
+}
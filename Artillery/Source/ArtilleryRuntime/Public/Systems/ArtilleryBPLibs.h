@@ -21,10 +21,22 @@ public:
 		{
 			InputStreamKey streamkey = ptr->GetStreamForPlayer(PlayerKey::CABLE);
 			TSharedPtr<UCanonicalInputStreamECS::FConservedInputStream> sptr = ptr->GetStream(streamkey);
-			for(int InputIndex = 0; InputIndex <= Count; ++InputIndex)
+			if (!sptr || Count < 0)
 			{
-				std::optional<FArtilleryShell> input =  sptr.Get()->peek( sptr->GetHighestGuaranteedInput() - InputIndex);
-				Inputs.Add(input.has_value() ? input.value() : FArtilleryShell());
+				return;
+			}
+			//newest first. one validated copy of the range, rather than a peek per input.
+			const uint64_t Highest = sptr->GetHighestInput();
+			const uint64_t Want = static_cast<uint64_t>(Count) + 1;
+			TArray<FArtilleryShell> Oldest;
+			sptr->CopyRange(Highest > Want ? Highest - Want : 0, Highest, Oldest);
+			for (int32 i = Oldest.Num() - 1; i >= 0; --i)
+			{
+				Inputs.Add(Oldest[i]);
+			}
+			for (uint64_t Missing = Oldest.Num(); Missing < Want; ++Missing)
+			{
+				Inputs.Add(FArtilleryShell());
 			}
 		}
 	}
@@ -493,7 +505,7 @@ public:
 
 		UTimerTickliteHandlerComponent* TimerComponent = Cast<UTimerTickliteHandlerComponent>(NewTimerTickliteComponent);
 		FTTimer TimerTicklite(TimerComponent, LifetimeInTicks);
-		UArtilleryDispatch::SelfPtr->RequestAddTicklite(MakeShareable(new TL_Timer(TimerTicklite)), Early);
+		UArtilleryDispatch::SelfPtr->RequestAddPooledTicklite(TL_Timer(TimerTicklite), Early);
 		return TimerComponent;
 	}
 
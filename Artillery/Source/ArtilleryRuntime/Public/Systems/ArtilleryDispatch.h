@@ -15,12 +15,7 @@
 #include "GameplayTagContainer.h"
 #include "KeyCarry.h"
 #include "TransformDispatch.h"
-THIRD_PARTY_INCLUDES_START
-PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
-#include "libcuckoo/cuckoohash_map.hh"
-typedef libcuckoo::cuckoohash_map<FSkeletonKey, AttrMapPtr> AttrCuckoo;
-PRAGMA_POP_PLATFORM_DEFAULT_PACKING
-THIRD_PARTY_INCLUDES_END
+#include "ArtilleryAttributeStore.h"
 #include "ArtilleryDispatch.generated.h"
 
 
@@ -104,7 +99,7 @@ public:
 		RequestorQueue_Abilities_TripleBuffer = MakeShareable(new BufferedEvents());
 		RequestorQueue_Locomos = MakeShareable(new BufferedMoveEvents());
 		GunToFiringFunctionMapping = MakeShareable(new TMap<FGunKey, FArtilleryFireGunFromDispatch>());
-		AttributeSetToDataMapping = MakeShareable(new AttrCuckoo());
+		AttributeStore = MakeShareable(new FArtilleryAttributeStore());
 		IdentSetToDataMapping = MakeShareable(new TMap<FSkeletonKey, IdMapPtr>());
 		KeyToControlliteMapping = MakeShareable(new TMap<FSkeletonKey, Machlet>());
 		VectorSetToDataMapping = MakeShareable(new TMap<FSkeletonKey, Attr3MapPtr>());
@@ -121,6 +116,8 @@ public:
 	TSharedPtr<F_INeedA> RequestRouter;
 
 	ArtilleryTime GetShadowNow() const { return ArtilleryAsyncWorldSim.TickliteNow; }
+	//the sim tick the ticklites are applying. this, not the pass count, is what picks cadence lanes.
+	uint64 GetTickliteTick() const { return ArtilleryAsyncWorldSim.TickliteTick; }
 	
 	void REGISTER_ENTITY_FINAL_TICK_RESOLVER(const ActorKey& Self);
 	void REGISTER_PROJECTILE_FINAL_TICK_RESOLVER(uint32 MaximumLifespanInTicks, const FSkeletonKey& Self);
@@ -165,8 +162,8 @@ protected:
 	//We can actually map this quite directly.
 	FArtilleryUpdateEnemyControllerSubsystem EnemyUpdateHook;
 	FArtilleryAddEnemyToControllerSubsystem EnemyRegisterHook;
-	// NOTTODO: It's built!
-	TSharedPtr<AttrCuckoo> AttributeSetToDataMapping;
+	// NOTTODO: It's built! and then rebuilt, by column. see ArtilleryAttributeStore.h.
+	TSharedPtr<FArtilleryAttributeStore> AttributeStore;
 	//TODO: Figure out how to apply the learnings from the design of the controller with the defaulting.
 	//It'll be necessary, I'm afraid. This can't use raw pointers safely. Likely we can use defaulting + the fblet design.
 	TSharedPtr<TMap<FSkeletonKey, Machlet>> KeyToControlliteMapping;
@@ -235,6 +232,9 @@ protected:
 	//********************************
 	void RERunGuns();
 	void RERunLocomotions();
+	//once the busy worker's replayed from Tick, the threads in lockstep with it redo what they'd worked out against
+	//the world it threw away.
+	void QueueRollback(uint64 Tick);
 
 public:
 	typedef FArtilleryTicklitesWorker<UArtilleryDispatch> FTicklitesWorker;
@@ -259,6 +259,11 @@ public:
 		{
 			return ADispatch->GetShadowNow();
 		}
+
+		static uint64 GetTickliteTick()
+		{
+			return ADispatch->GetTickliteTick();
+		}
 	};
 	
 	//DUMMY FOR NOW.
@@ -268,6 +273,68 @@ public:
 	{
 		ArtilleryTicklitesWorker_LockstepToWorldSim.RequestAddTicklite(ToAdd, Group);
 	}
+
+	//no allocation, no refcount. use this unless something else needs to hold onto the ticklite.
+	template <typename TicklikeType>
+	void RequestAddPooledTicklite(TicklikeType ToAdd, TicklitePhase Group)
+	{
+		ArtilleryTicklitesWorker_LockstepToWorldSim.RequestAddPooledTicklite(MoveTemp(ToAdd), Group);
+	}
+
+	FTickliteCadenceLoad GetTickliteCadenceLoad() const
+	{
+		return ArtilleryTicklitesWorker_LockstepToWorldSim.GetCadenceLoad();
+	}
+
+	//how on time the busy worker's slots have been. any thread. see artillery.Pacer.Report.
+	FArtilleryPacerStats GetTickPacerStats() const
+	{
+		return ArtilleryAsyncWorldSim.Pacer.GetStats();
+	}
+
+	//ticklites run the sphere casts they queued during calculate through this, all at once. see FTSphereCast.
+	void RunQueryBatch(FBQueryBatch& Batch) const;
+
+	//the busy worker commits the tick's attribute changes to history through this, before ticklites apply.
+	void CommitAttributeTick(uint64 Tick) const
+	{
+		if (TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore)
+		{
+			HoldOpenStore->Commit(Tick);
+		}
+	}
+	//what an attribute's current value was as of Tick, for rollback. busy worker only. false if it's past the window.
+	bool GetAttribAtTick(FSkeletonKey Owner, Attr Attrib, uint64 Tick, float& Out) const
+	{
+		TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore;
+		return HoldOpenStore && HoldOpenStore->ValueAt(Owner, static_cast<uint8>(Attrib), EAttributeValue::Current, Tick, Out);
+	}
+	//the busy worker's replay reads attributes as of the tick before each one it replays. see FArtilleryAttributeStore.
+	void BeginAttribReplay() const
+	{
+		if (TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore)
+		{
+			HoldOpenStore->BeginReplay();
+		}
+	}
+	void ReplayAttribTick(uint64 Tick) const
+	{
+		if (TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore)
+		{
+			HoldOpenStore->ReplayTick(Tick);
+		}
+	}
+	void EndAttribReplay() const
+	{
+		if (TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore)
+		{
+			HoldOpenStore->EndReplay();
+		}
+	}
+	TSharedPtr<FArtilleryAttributeStore> GetAttributeStore() const
+	{
+		return AttributeStore;
+	}
 	
 	FGunKey RegisterExistingGun(const TSharedPtr<FArtilleryGun>& toBind, const ActorKey& ProbableOwner) const;
 	bool IsGunLive(FSkeletonKey Key); 
@@ -290,8 +357,8 @@ public:
 	TSharedPtr<FArtilleryGun> GetPointerToGun(const FGunKey& GunToGet) const;
 
 	/**
-	 * In theory having this will let us only have to fetch a pointer to the map once if we need to do things
-	 * with multiple attributes on the same key at once. Potential perf gains.
+	 * Builds a map of handles for everything the key has. The store only hashes the key once for all of them, but
+	 * if you just want one or two, GetAttrib is cheaper than building the map.
 	 * 
 	 * @param Owner Key to search for
 	 * @return Pointer to hashmap containing Attributes for the given key
@@ -357,12 +424,24 @@ public:
 		KeyToControlliteMapping->Add(in, LaputanMachine); //I spill my drink.
 	}
 	
-	void RegisterAttributes(FSkeletonKey in, AttrMapPtr Attributes)
+	//returns the row the attributes landed in, or InvalidRow. registering a key again replaces its attributes.
+	uint32 RegisterAttributes(FSkeletonKey in, const TMap<AttribKey, double>& Defaults)
 	{
-		if (auto hold = AttributeSetToDataMapping)
+		TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore;
+		if (!HoldOpenStore)
 		{
-			AttributeSetToDataMapping->insert_or_assign(in, Attributes);
+			return FArtilleryAttributeStore::InvalidRow;
+		}
+		const uint32 Row = HoldOpenStore->Claim(in);
+		if (Row != FArtilleryAttributeStore::InvalidRow)
+		{
+			for (const TPair<AttribKey, double>& Default : Defaults)
+			{
+				HoldOpenStore->Init(Row, static_cast<uint8>(Default.Key), static_cast<float>(Default.Value));
+			}
+			HoldOpenStore->Bind(in, Row);
 		}
+		return Row;
 	}
 	
 	void RegisterRelationships(FSkeletonKey in, IdMapPtr Relationships)
@@ -382,9 +461,9 @@ public:
 	
 	void DeregisterAttributes(FSkeletonKey in)
 	{
-		if (auto hold = AttributeSetToDataMapping)
+		if (TSharedPtr<FArtilleryAttributeStore> HoldOpenStore = AttributeStore)
 		{
-			hold->erase(in);
+			HoldOpenStore->Deregister(in);
 		}
 	}
 	
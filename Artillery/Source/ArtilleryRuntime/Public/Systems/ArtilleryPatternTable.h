@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/CircularBuffer.h"
+#include "ArtilleryCommonTypes.h"
+#include "ArtilleryShell.h"
+#include "FActionPattern.h"
+
+//the pattern matcher used to walk a TMap of TSets every input, union the masks of every bind, then call a virtual
+//runPattern per pattern, each of which walked the history again through a virtual peek that copied out a whole shell.
+//that's a lot of pointer chasing to answer "which of twenty bits were held for six frames."
+//
+//this compiles the binds down to flat arrays: one entry per live pattern with its union mask, and one per bind with
+//its mask and gun. evaluating a frame reads the buttons for the last Depth frames straight out of the ring once,
+//folds them into the handful of and/or aggregates the patterns are made of, and then each pattern is a couple of
+//bit ops on those. results are the same as the virtual patterns, including the ways those couple binds through their
+//union. the Artillery.Patterns.Table.MatchesLegacy test holds it to that, and artillery.Patterns.Verify runs both live
+//and complains if they ever disagree.
+//
+//busy worker only. Compile whenever the binds change, Evaluate every frame.
+class ARTILLERYRUNTIME_API FArtilleryPatternTable
+{
+public:
+	//the flick sweeps back furthest, fifteen frames plus the current one.
+	static constexpr int32 Depth = ArtilleryFlickSweepBack + 1;
+
+	using FBinds = TMap<ArtIPMKey, TSharedPtr<TSet<FActionPatternParams>>>;
+	using FPatterns = TMap<ArtIPMKey, IPM::CanonPattern>;
+	//for a pattern this doesn't know how to flatten. gets the pattern and the union of its binds, like runPattern did.
+	using FFallback = TFunctionRef<uint32(IPM::CanonPattern, FActionBitMask&)>;
+
+	//walks the binds in the same order the matcher always has, so events come out in the same order too.
+	void Compile(const FBinds& Binds, const FPatterns& Patterns);
+	//appends an event per bind whose mask is fully matched on Frame.
+	void Evaluate(const TCircularBuffer<FArtilleryShell>& Ring,
+	              uint64 Frame,
+	              TArray<TPair<ArtilleryTime, EventBufferInfo>>& Out,
+	              FFallback Fallback) const;
+	bool IsEmpty() const
+	{
+		return Kinds.IsEmpty();
+	}
+
+	//artillery.Patterns.Verify.
+	static bool ShouldVerify();
+
+private:
+	struct FCompiledKind
+	{
+		ArtIPMKey Name = ArtIPMKey::InternallyStateless;
+		IPM::CanonPattern Pattern = nullptr;
+		uint32 Union = 0;
+		int32 FirstBind = 0;
+		int32 NumBinds = 0;
+	};
+	struct FCompiledBind
+	{
+		uint32 Mask = 0;
+		FGunKey ToFire;
+	};
+	static bool DetectFlick(const TCircularBuffer<FArtilleryShell>& Ring, uint64 Frame);
+
+	TArray<FCompiledKind> Kinds;
+	TArray<FCompiledBind> Binds;
+	bool bNeedsFlick = false;
+};
@@ -6,6 +6,7 @@
 #include "Subsystems/WorldSubsystem.h"
 #include "AInstancedMeshManager.h"
 #include "FProjectileDefinitionRow.h"
+#include "BarrageContactRouter.h"
 //look, it's important that you wrap both your typedefs and your lib include in these, and that the lib include always be explicit.
 //lbc is a header only lib. this has some pretty stark implications. we probably need to move ALL type defs and ALL
 //includes into a Lbc module, isolate them, and compile them.
@@ -38,6 +39,17 @@ namespace Arty
 	DECLARE_MULTICAST_DELEGATE(OnArtilleryProjectilesActivated);
 }
 
+//one projectile in a volley. see UArtilleryProjectileDispatch::CreateProjectileInstances.
+struct FProjectileInstanceSpawn
+{
+	FName ProjectileDefinitionId;
+	FGunKey Gun;
+	//the key ends up in here, and stays invalid if there's no mesh manager for the definition.
+	FInstancedMeshSpawn Instance;
+	bool CanExpire = true;
+	int LifeInTicks = -1;
+};
+
 //todo, switch this over to be an inheritor of the static asset loader? maybe?
 UCLASS()
 class ARTILLERYRUNTIME_API UArtilleryProjectileDispatch : public UTickableWorldSubsystem, public ISkeletonLord, public ITickHeavy
@@ -81,6 +93,9 @@ public:
 	// TODO - Add handling for IsSensor and IsDynamic. We do not currently have anything that uses these flags, so they are not handled by the request router
 	FSkeletonKey QueueProjectileInstance(const FName ProjectileDefinitionId, const FGunKey& Gun, const FVector3d& StartLocation, const FVector3d& MuzzleVelocity, const float Scale = 1.0f, Layers::EJoltPhysicsLayer Layer = Layers::PROJECTILE, TArray<FGameplayTag>* TagArray = nullptr);
 	FSkeletonKey CreateProjectileInstance(FSkeletonKey ProjectileKey,  FGunKey Gun, const FName ProjectileDefinitionId, const FTransform& WorldTransform, const FVector3d& MuzzleVelocity, const float Scale = 1.0f, const bool IsSensor = true, const bool IsDynamic = false, Layers::EJoltPhysicsLayer Layer = Layers::PROJECTILE, const bool CanExpire = true, const int LifeInTicks = -1);
+	//CreateProjectileInstance for a burst. each mesh manager gets its share of the burst in one go, and makes their
+	//bodies in one barrage batch.
+	void CreateProjectileInstances(TArrayView<FProjectileInstanceSpawn> Spawns);
 	bool IsArtilleryProjectile(const FSkeletonKey MaybeProjectile);
 	void DeleteProjectile(const FSkeletonKey Target);
 	TWeakObjectPtr<AInstancedMeshManager> GetProjectileMeshManagerByManagerKey(const FSkeletonKey ManagerKey);
@@ -88,8 +103,14 @@ public:
 	TWeakObjectPtr<USceneComponent> GetSceneComponentForProjectile(const FSkeletonKey ProjectileKey);
 
 	void OnBarrageContactAdded(const BarrageContactEvent& ContactEvent);
+	//projectile contacts only, one per pair per tick. see FBContactFilter.
+	void OnBarrageContactsAdded(TArrayView<const BarrageContactEvent> ContactEvents);
 
 
 private:
+	void RegisterProjectileInstance(FSkeletonKey NewProjectileKey, const TWeakObjectPtr<AInstancedMeshManager>& MeshManager, FGunKey Gun,
+	                                const FName ProjectileDefinitionId, const bool CanExpire, const int LifeInTicks);
+
 	UArtilleryDispatch* MyDispatch;
+	FBContactSubscription ContactSubscription = FBarrageContactRouter::InvalidSubscription;
 };
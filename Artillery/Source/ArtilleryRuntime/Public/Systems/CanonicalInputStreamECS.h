@@ -13,11 +13,13 @@
 #include "BristleconeCommonTypes.h"
 #include "UBristleconeWorldSubsystem.h"
 #include <optional>
+#include <atomic>
 #include <unordered_map>
 #include <ArtilleryShell.h>
 #include "ArtilleryCommonTypes.h"
 #include "FArtilleryNoGuaranteeReadOnly.h"
 #include "FActionPattern.h"
+#include "ArtilleryPatternTable.h"
 #include "KeyedConcept.h"
 #include "TransformDispatch.h"
 #include "UCablingWorldSubsystem.h"
@@ -136,6 +138,11 @@ public:
 		//instead we check binds.
 		TMap<ArtIPMKey, IPM::CanonPattern> AllPatternsByName;
 
+		//the binds above, flattened. registerPattern and removePattern flag it, and the busy worker recompiles it
+		//before the next frame it runs.
+		FArtilleryPatternTable Compiled;
+		std::atomic<bool> bBindsChanged{true};
+
 
 		//***********************************************************
 		//
@@ -170,8 +177,48 @@ public:
 			//then pin it. at this point, we can be sure that we hold A STREAM that DOES exist.
 			//TODO: settle on a coherent error handling strategy here.
 			auto Stream = ECS->GetStream(MyStream);
-			
-			
+			if (!Stream)
+			{
+				return;
+			}
+			if (bBindsChanged.exchange(false))
+			{
+				Compiled.Compile(AllPatternBinds, AllPatternsByName);
+			}
+
+			const int32 FirstNew = IN_PARAM_REF_TRIPLEBUFFER_LIFECYLEMANAGED.Num();
+			Compiled.Evaluate(Stream->CurrentHistory, InputCycleNumber, IN_PARAM_REF_TRIPLEBUFFER_LIFECYLEMANAGED,
+				[&Stream, InputCycleNumber](IPM::CanonPattern Pattern, FActionBitMask& Union)
+				{
+					return Pattern->runPattern(InputCycleNumber, Union, Stream);
+				});
+
+			//the old patterns only behave once there's enough history for the longest sweep.
+			if (FArtilleryPatternTable::ShouldVerify() && InputCycleNumber >= 2 * ArtilleryFlickSweepBack)
+			{
+				TArray<TPair<ArtilleryTime, EventBufferInfo>> Legacy;
+				runOneFrameLegacy(InputCycleNumber, Stream, Legacy);
+				const int32 NumNew = IN_PARAM_REF_TRIPLEBUFFER_LIFECYLEMANAGED.Num() - FirstNew;
+				bool bSame = NumNew == Legacy.Num();
+				for (int32 i = 0; bSame && i < NumNew; ++i)
+				{
+					const TPair<ArtilleryTime, EventBufferInfo>& Ours = IN_PARAM_REF_TRIPLEBUFFER_LIFECYLEMANAGED[FirstNew + i];
+					bSame = Ours.Key == Legacy[i].Key && Ours.Value.GunKey == Legacy[i].Value.GunKey
+						&& Ours.Value.Action == Legacy[i].Value.Action;
+				}
+				if (!bSame)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("Artillery:Patterns: compiled patterns fired %d events on input %llu, the originals fired %d."),
+						NumNew, InputCycleNumber, Legacy.Num());
+				}
+			}
+		};
+
+		//the way patterns ran before they were compiled. kept for artillery.Patterns.Verify.
+		void runOneFrameLegacy(uint64_t InputCycleNumber,
+		                       FANG_PTR Stream,
+		                       TArray<TPair<ArtilleryTime, EventBufferInfo>>& Out)
+		{
 			//the lack of reference (&) here causes a _copy of the shared pointer._ This is not accidental.
 			for (auto SetTuple : AllPatternBinds)
 			{
@@ -201,7 +248,7 @@ public:
 									EventBufferInfo EventInfo;
 									EventInfo.GunKey = Elem.ToFire;
 									EventInfo.Action = currentPattern->getName();
-									IN_PARAM_REF_TRIPLEBUFFER_LIFECYLEMANAGED.Add(TPair<ArtilleryTime, EventBufferInfo>(
+									Out.Add(TPair<ArtilleryTime, EventBufferInfo>(
 											time,
 											EventInfo)
 									);
@@ -248,92 +295,169 @@ public:
 		InputStreamKey MyKey;
 
 
-		//Correct usage procedure is to null check then store a copy.
-		//Failure to follow this procedure will lead to eventual misery.
-		//This has a side-effect of marking the record as played at least once.
-		std::optional<FArtilleryShell> get(uint64_t input)
+		//one writer, the busy worker, many readers. the writer fills the slot at Published and only then release-stores
+		//Published + 1, so anything below an acquired Published is whole. the ring is reused though, and a reader that's
+		//slow enough could still be copying a slot out as the writer laps it. so every read copies first and then checks
+		//the writer is still AddressableInputConservationWindow behind, seqlock style, and throws the copy away if not.
+		//that's the torn read we used to get under load. the Artillery.Inputs.ConservedStream.TornReads test hammers this.
+
+		//a run of published inputs, read in place. the ring wraps, so it comes in at most two pieces, Older first.
+		//it's stable for as long as the writer takes to eat the margin, about two seconds. check StillReadable(First)
+		//once you're done with it, and don't trust anything you read if that says no.
+		struct FInputSpan
 		{
-			// the highest input is a reserved write-slot.
-			//the lower bound here ensures that there's always minimum two seconds worth of memory separating the readers
-			//and the writers. How safe is this? It's not! But it's insanely fast. Enjoy, future jake!
-			//TODO: Refactor this to use an atomic int instead of this hubristic madness.
-			if (input >= highestInput || (highestInput - input) > AddressableInputConservationWindow)
+			uint64_t First = 0;
+			TArrayView<const FArtilleryShell> Older;
+			TArrayView<const FArtilleryShell> Newer;
+
+			int32 Num() const
 			{
-				return std::optional<FArtilleryShell>(
-					std::nullopt
-				);
+				return Older.Num() + Newer.Num();
 			}
-			else
+
+			const FArtilleryShell& operator[](int32 Index) const
+			{
+				return Index < Older.Num() ? Older[Index] : Newer[Index - Older.Num()];
+			}
+		};
+
+		//Correct usage procedure is to null check then store a copy.
+		//This has a side-effect of marking the record as played at least once, so it's the busy worker's. everyone
+		//else uses peek.
+		std::optional<FArtilleryShell> get(uint64_t input)
+		{
+			std::optional<FArtilleryShell> Shell = peek(input);
+			if (Shell.has_value())
 			{
 				CurrentHistory[input].RunAtLeastOnce = true;
-				//this is the only risky op in here from a threading perspective.
-				return std::optional<FArtilleryShell>(CurrentHistory[input]);
+				Shell->RunAtLeastOnce = true;
 			}
+			return Shell;
 		};
 
+		//get, for when all you want is the side-effect. busy worker only, same as get.
+		void MarkRun(uint64_t input)
+		{
+			get(input);
+		}
+
 		//THE ONLY DIFFERENCE WITH PEEK IS THAT IT DOES NOT SET RUNATLEASTONCE.
-		//Peek is public out of necessity, but generally, you should use get.
 		std::optional<FArtilleryShell> peek(uint64_t input)
 		override
 		{
 			// the highest input is a reserved write-slot.
-			//the lower bound here ensures that there's always minimum two seconds worth of memory separating the readers
-			//and the writers. How safe is this? It's not! But it's insanely fast. Enjoy, future jake!
-			//TODO: Refactor this to use an atomic int instead of this hubristic madness.
-			if (input >= highestInput || (highestInput - input) > AddressableInputConservationWindow)
+			const uint64_t Highest = Published.load(std::memory_order_acquire);
+			if (input >= Highest || (Highest - input) > AddressableInputConservationWindow)
 			{
 				return std::optional<FArtilleryShell>(
 					std::nullopt
 				);
 			}
-			else
+			const FArtilleryShell Copy = CurrentHistory[input];
+			if (!StillReadable(input))
 			{
-				return std::optional<FArtilleryShell>(CurrentHistory[input]);
+				return std::optional<FArtilleryShell>(std::nullopt);
 			}
+			return std::optional<FArtilleryShell>(Copy);
 		};
+
+		//[From, To), clamped to what's published. false if none of it is readable.
+		bool GetSpan(uint64_t From, uint64_t To, FInputSpan& Out) const
+		{
+			const uint64_t Highest = Published.load(std::memory_order_acquire);
+			To = FMath::Min(To, Highest);
+			if (From >= To || (Highest - From) > AddressableInputConservationWindow)
+			{
+				return false;
+			}
+			const uint64_t Capacity = CurrentHistory.Capacity();
+			//the ring's capacity is a power of two, so this is its own index mask.
+			const uint64_t Start = From & (Capacity - 1);
+			const uint64_t Count = To - From;
+			const uint64_t InOlder = FMath::Min(Count, Capacity - Start);
+			const FArtilleryShell* Base = &CurrentHistory[0];
+			Out.First = From;
+			Out.Older = TArrayView<const FArtilleryShell>(Base + Start, static_cast<int32>(InOlder));
+			Out.Newer = TArrayView<const FArtilleryShell>(Base, static_cast<int32>(Count - InOlder));
+			return true;
+		}
+
+		//copies [From, To) onto the end of Out, oldest first. all or nothing: returns how many it added, which is
+		//zero if the writer lapped any of it mid-copy.
+		int32 CopyRange(uint64_t From, uint64_t To, TArray<FArtilleryShell>& Out) const
+		{
+			FInputSpan Span;
+			if (!GetSpan(From, To, Span))
+			{
+				return 0;
+			}
+			const int32 Before = Out.Num();
+			Out.Append(Span.Older.GetData(), Span.Older.Num());
+			Out.Append(Span.Newer.GetData(), Span.Newer.Num());
+			if (!StillReadable(Span.First))
+			{
+				Out.SetNum(Before, EAllowShrinking::No);
+				return 0;
+			}
+			return Span.Num();
+		}
+
+		//call after reading a slot. true if the writer couldn't have started on it since Published was loaded.
+		bool StillReadable(uint64_t input) const
+		{
+			//keeps the copy from being reordered after the reload.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return Published.load(std::memory_order_relaxed) - input <= AddressableInputConservationWindow;
+		}
+
 	public:
 		ActorKey GetActorByInputStream()
 		{
 			return ECSParent->ActorByStream(MyKey); // this lets us avoid exposing the key.
 		};
-		
 
-		uint64_t GetHighestGuaranteedInput()
+		//one past the newest readable input. acquire, so every input below it is whole.
+		uint64_t GetHighestInput() const
 		{
-			return highestInput-1;
+			return Published.load(std::memory_order_acquire);
+		}
+
+		uint64_t GetHighestGuaranteedInput() const
+		{
+			return GetHighestInput() - 1;
 		}
-		uint64_t highestInput = 0; // volatile is utterly useless for its intended purpose. 
 		UCanonicalInputStreamECS* ECSParent;
 		TSharedPtr<UCanonicalInputStreamECS::FConservedInputPatternMatcher> MyPatternMatcher;
 
 		//Add can only be used by the Artillery Worker Thread through the methods of the UCISArty.
 		void Add(INNNNCOMING shell, long SentAt)
 		{
-			CurrentHistory[highestInput].MyInputActions = shell;
-			CurrentHistory[highestInput].ReachedArtilleryAt = ECSParent->Now();
-			CurrentHistory[highestInput].SentAt = SentAt;
-			//this is gonna get weird after a couple refactors, but that's why we hide it here.
-
-			// reading, adding one, and storing are all separate ops. a slice here is never dangerous but can be erroneous.
-			// because this is a volatile variable, it cannot be optimized away and most compilers will not reorder it.
-			// however, volatile is basically useless normally. it doesn't provoke a memory fence, and for a variety of reasons
-			// it's not suitable for most driver applications. However.
-			// 
-			// There's a special case which is a monotonically increasing value that is only ever
-			// incremented by one thread with a single call site for the increment. In this case, you can still get
-			// interleaved but the value will always be either k or k+1. If it's stale in cache, the worst case
-			// is that the newest input won't be legible yet and this can be resolved by repolling.
-			++highestInput;
+			Publish(shell, SentAt, ECSParent->Now());
 		};
 
 		//Overload for local add via feed from cabling. don't use this unless you are CERTAIN.
 		void Add(INNNNCOMING shell)
 		{
-			CurrentHistory[highestInput].MyInputActions = shell;
-			CurrentHistory[highestInput].ReachedArtilleryAt = ECSParent->Now();
-			CurrentHistory[highestInput].SentAt = ECSParent->Now();
-			++highestInput;
+			const ArtilleryTime Now = ECSParent->Now();
+			Publish(shell, Now, Now);
 		};
+
+		//the one write. writer thread only. public so the stress test can drive a stream without an ECS behind it.
+		void Publish(INNNNCOMING shell, BristleTime SentAt, ArtilleryTime ReachedAt)
+		{
+			//we're the only writer, so our own last store is always what's there.
+			const uint64_t Slot = Published.load(std::memory_order_relaxed);
+			FArtilleryShell& Next = CurrentHistory[Slot];
+			Next.MyInputActions = shell;
+			Next.ReachedArtilleryAt = ReachedAt;
+			Next.SentAt = SentAt;
+			//the slot last held an input from a lap ago, which has nothing to do with this one.
+			Next.RunAtLeastOnce = false;
+			Published.store(Slot + 1, std::memory_order_release);
+		}
+
+	private:
+		std::atomic<uint64_t> Published{0};
 	};
 
 	//Used in the busyworker
@@ -363,10 +487,17 @@ public:
 		TSharedPtr<TArray<FArtilleryShell>> Inputs = MakeShareable(new TArray<FArtilleryShell>);
 		if(sptr)
 		{
-			for(int i = 0; i <= 15; ++i)
+			//newest first, like it always was. one validated copy instead of sixteen peeks.
+			const uint64_t Highest = sptr->GetHighestInput();
+			TArray<FArtilleryShell> Oldest;
+			sptr->CopyRange(Highest > 16 ? Highest - 16 : 0, Highest, Oldest);
+			for (int32 i = Oldest.Num() - 1; i >= 0; --i)
+			{
+				Inputs->Add(Oldest[i]);
+			}
+			while (Inputs->Num() < 16)
 			{
-				auto input =  sptr.Get()->peek( sptr->GetHighestGuaranteedInput());
-				Inputs->Add(input.has_value() ? input.value() : FArtilleryShell());
+				Inputs->Add(FArtilleryShell());
 			}
 		}
 		return Inputs;
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+struct FArtilleryPacerStats
+{
+	static constexpr int32 Buckets = 16;
+	uint64 Slots = 0;
+	//slots that were already due when we asked for them, and so ran back to back.
+	uint64 CaughtUp = 0;
+	//slots thrown away because we'd fallen further behind than artillery.Pacer.MaxCatchUpSlots.
+	uint64 Skipped = 0;
+	uint64 MaxLateMicros = 0;
+	//Late[0] is slots that woke less than a microsecond after their deadline. after that, Late[i] is from 2^(i-1) up
+	//to 2^i microseconds late, and the last bucket takes everything past that.
+	uint64 Late[Buckets] = {};
+	const TCHAR* Primitive = TEXT("none");
+};
+
+//the busy worker used to pace itself with a spin, yield and sleep ladder against the network clock, leaning on
+//timeBeginPeriod to make the sleeps short enough. that's windows only. on linux, sleep_for gave us drift or a hot core.
+//this paces against absolute deadlines instead, so a late wake never pushes the next slot back, and sleeps on the best
+//thing each platform has: clock_nanosleep with TIMER_ABSTIME on linux, a high resolution waitable timer on windows.
+//the last artillery.Pacer.SpinMicroseconds before a deadline are spent yielding, since no sleep is that precise.
+//
+//deadlines are on the network clock, the same one everyone else stamps input with, and fall on whole periods of it so
+//every machine's slots line up. the monotonic clock is only used to say how long to sleep until the next one.
+//
+//Start, WaitForNextSlot and Finish are for the pacing thread only. GetStats is safe from anywhere.
+class FArtilleryTickPacer
+{
+public:
+	FArtilleryTickPacer();
+	~FArtilleryTickPacer();
+
+	//starts the clock. NetworkClock is microseconds and allowed to wrap. the first slot is due at the next whole period.
+	void Start(uint64 InPeriodNanos, TFunction<uint32()> InNetworkClock);
+	//blocks until the next slot is due, and returns how many slots that was. that's 1, unless more than
+	//artillery.Pacer.MaxCatchUpSlots were already due, in which case the backlog is dropped, we resync to the clock, and
+	//the skipped slots count too. a smaller backlog returns 1 straight away for each, so the sim catches up.
+	//returns 0 without the slot being due if WakeEarly goes true while we wait. it's checked every yield, and at least
+	//every artillery.Pacer.WakeCheckMicroseconds while asleep.
+	int32 WaitForNextSlot(TFunctionRef<bool()> WakeEarly);
+	//releases whatever Start took from the OS.
+	void Finish();
+	FArtilleryPacerStats GetStats() const;
+
+	//monotonic, and the same clock the sleeps are measured against.
+	static int64 NowNanos();
+
+private:
+	void SleepUntil(int64 DeadlineNanos);
+	void NoteSlot(int64 LateNanos);
+	//the network clock, widened so it doesn't wrap, in nanos.
+	int64 NetworkNowNanos();
+
+	int64 PeriodNanos = 0;
+	//on the network clock.
+	int64 NextDeadline = 0;
+	TFunction<uint32()> NetworkClock;
+	uint32 LastNetworkMicros = 0;
+	int64 NetworkMicros = 0;
+	const TCHAR* Primitive = TEXT("none");
+#if PLATFORM_WINDOWS
+	void* Timer = nullptr;
+	bool bRaisedTimerResolution = false;
+#endif
+
+	std::atomic<uint64> Slots{0};
+	std::atomic<uint64> CaughtUp{0};
+	std::atomic<uint64> Skipped{0};
+	std::atomic<uint64> MaxLateNanos{0};
+	std::atomic<uint64> Late[FArtilleryPacerStats::Buckets] = {};
+};
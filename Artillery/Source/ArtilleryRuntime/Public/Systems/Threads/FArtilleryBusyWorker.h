@@ -10,6 +10,9 @@
 
 #include "BarrageDispatch.h"
 #include "NeedA.h"
+#include "ArtilleryTickPacer.h"
+
+class UArtilleryDispatch;
 
 //this is a busy-style thread, which runs preset bodies of work in a specified order. Generally, the goal is that it never
 //actually sleeps. In fact, it yields rather than sleeps, in general operation.
@@ -20,6 +23,7 @@
 // The artilleryworker needs to be kept fairly busy or it will melt one cpu core yield-cycling. to be honest, worth it.
 // no, seriously. with all the other sacrifices we've made occupying one core with game-sim physics, reconciliation,
 // rollbacks, and pattern matching is a pretty good bargain. we'll want to revisit this for servers, of course.
+// between slots it now sleeps on FArtilleryTickPacer, which is what makes linux servers workable at all.
 
 class FArtilleryBusyWorker : public FRunnable {
 	public:
@@ -31,10 +35,15 @@ class FArtilleryBusyWorker : public FRunnable {
 	TSharedPtr<BufferedEvents> RequestorQueue_Abilities_TripleBuffer;
 	TSharedPtr<BufferedAIMoveEvents> RequestorQueue_AI_Locomos_TripleBuffer;
 	ArtilleryTime TickliteNow = 0;
+	//the sim tick ticklites are about to apply, one per send window. set just before StartTicklitesApply fires.
+	//a window the busy worker didn't get to still counts, so it's the same tick on every machine.
+	uint64 TickliteTick = 0;
 	FSharedEventRef StartTicklitesSim;
 	FSharedEventRef StartTicklitesApply;
 	FSharedEventRef StartRunAhead;
 	int SeqNumber = 0;
+	//only the busy worker waits on it. anyone can read its stats.
+	FArtilleryTickPacer Pacer;
 	//Going forward, it is potentially worthwhile for us switch to this...
 	ITickHeavy* ParticleSystemPointer;
 	ITickHeavy* ProjectileSystemPointer;
@@ -42,11 +51,17 @@ class FArtilleryBusyWorker : public FRunnable {
 	//deinitialized when if we need to, as well. It wouldn't even be that hard, simply add a deregister to SkeletonLord
 	
 	virtual bool Init() override;
+	//a non-zero ReplayUpTo runs patterns and locomotions over [currentIndexCabling, ReplayUpTo) for a tick being
+	//replayed instead. nothing's drained, and ability events are dropped, since the gamethread had them the first time.
 	void RunStandardFrameSim(bool& missedPrior,
 		uint64_t& currentIndexCabling,
 		bool& burstDropDetected,
 		TheCone::PacketElement& current,
-		bool& RemoteInput);
+		bool& RemoteInput,
+		uint64_t ReplayUpTo = 0);
+	//any thread. the next frame rolls back to Tick, or to the earliest tick asked for if there's more than one, and
+	//replays from there before it runs. see BarrageRollback.h. nothing happens with barrage.Rollback.Enabled off.
+	void RequestRollback(uint64 Tick);
 	void ProcessRequestRouterBusyWorkerThread();
 	virtual uint32 Run() override;
 	virtual void Exit() override;
@@ -66,5 +81,14 @@ class FArtilleryBusyWorker : public FRunnable {
 	
 private:
 	void Cleanup();
+	//restores the earliest requested tick and replays every frame since, then has the lockstep threads redo theirs.
+	void Resimulate(UArtilleryDispatch* ArtilleryDispatch);
 	bool running;
+	static constexpr uint64 NoRollback = ~0ull;
+	std::atomic<uint64> PendingRollbackTick{NoRollback};
+	TArray<FBRollbackTick> ReplayTicks;
+	EventBuffer ReplayEvents;
+	//the ticks the last few frames ran on, newest first, so late input knows where it should have gone.
+	uint64 RecentFrameTicks[3] = {};
+	int32 RecentFrames = 0;
 };
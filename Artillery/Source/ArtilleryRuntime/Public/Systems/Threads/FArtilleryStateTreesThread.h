@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <atomic>
 #include <thread>
 
 #include "CoreMinimal.h"
@@ -61,14 +62,13 @@ public:
 	{
 		UE_LOG(LogTemp, Display, TEXT("Artillery: Destructing AI thread."));
 	};
-	virtual bool QueueRollback()
+	//the busy worker calls this once it's replayed from Tick. we ran ahead against the world it threw away, so the
+	//tick we ran gets run again once we're woken, against the one it kept. the enemy hook sees that tick twice, and
+	//the second time is the one that counts.
+	virtual bool QueueRollback(uint64 Tick)
 	{
-		//rollback is not implemented yet, but works by removing ticklikes added after the rollback's timestamp.
-		//then adding back in any expired ticklikes that should be revived, clearing the current tick, and beginning resim.
-		//Implementing this will not be easy, but it will suck a lot less than trying to do this with gameplay effects.
-		//This is one reason we advocate STRONGLY for the use of KEYS over references, as references to memmory location
-		//are not durable across rollbacks.
-		throw; 
+		bRollbackQueued.store(true, std::memory_order_release);
+		return true;
 	}
 
 	virtual bool Init() override
@@ -89,6 +89,10 @@ public:
 			DispatchOwner->RunEnemySim(SeqNumber);
 			RunAheadStateTrees->Wait();
 			RunAheadStateTrees->Reset(); // we can run long on sim, not on apply.
+			if (bRollbackQueued.exchange(false, std::memory_order_acquire))
+			{
+				DispatchOwner->RunEnemySim(SeqNumber);
+			}
 			
 			++SeqNumber;
 			
@@ -119,5 +123,6 @@ private:
 		running = false;
 	};
 	bool running;
+	std::atomic<bool> bRollbackQueued{false};
 };
 
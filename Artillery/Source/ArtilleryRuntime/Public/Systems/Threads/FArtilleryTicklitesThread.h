@@ -1,7 +1,18 @@
 ﻿#pragma once
 #include "CoreMinimal.h"
 #include "HAL/Runnable.h"
+#include "Async/ParallelFor.h"
 #include <Ticklite.h>
+#include "TickliteLanes.h"
+#include "TickliteSlab.h"
+#include "BarrageQueryBatch.h"
+
+//what a ticklite gets back for a query it queued in calculate, to read the result with in apply.
+struct FTickliteQueryTicket
+{
+	uint64 Pass = 0;
+	int32 Index = INDEX_NONE;
+};
 
 //this is a busy-style thread, which runs preset bodies of work in a specified order. Generally, the goal is that it never
 //actually sleeps. In fact, it only ever waits on the Artillery busy thread.
@@ -56,7 +67,47 @@ class FArtilleryTicklitesWorker : public FRunnable
 	ArtilleryTime LocalNow;
 
 	static const int GroupCount = 4;
-	TickliteGroup ExecutionGroups[GroupCount];
+	TTickliteLaneSet<TSharedPtr<TicklitePrototype>> ExecutionGroups[GroupCount];
+	//the sim tick calculate gets ready for, one past the last one applied. picks which cadence lanes are due.
+	uint64 NextTick = 0;
+	mutable FCriticalSection LoadLock;
+	FTickliteCadenceLoad LastLoad;
+	//below this, a group's calculate just runs here. handing tiny groups to the task pool costs more than it saves.
+	static constexpr int32 MinTicklitesPerCalcBatch = 64;
+	//pooled ticklites, by group and then by type. a slot is filled the first time that type is added to that group.
+	std::atomic<ITickliteSlab*> Slabs[GroupCount][FTickliteSlabTypes::MaxTypes] = {};
+	//queries queued by this pass's calculates. run once, between calculate and apply, then reset after apply.
+	FBQueryBatch PassQueries;
+	FCriticalSection PassQueriesLock;
+	//counts passes, so a ticklite whose apply wasn't due the pass it queued on can tell its result is gone.
+	uint64 QueryPass = 1;
+	//set by QueueRollback, taken by Run once apply's been let go.
+	std::atomic<bool> bRollbackQueued{false};
+
+	static int32 GroupIndexOf(TicklitePhase Group)
+	{
+		switch (Group)
+		{
+		case TicklitePhase::Early : return 0;
+		case TicklitePhase::Normal : return 1;
+		case TicklitePhase::Late : return 2;
+		case TicklitePhase::FINAL_TICK_RESOLVE : return 3;
+		}
+		return INDEX_NONE;
+	}
+
+	template <typename Fn>
+	void ForEachSlab(int32 GroupIndex, Fn&& Body)
+	{
+		const int32 Types = FTickliteSlabTypes::Num();
+		for (int32 Type = 0; Type < Types; ++Type)
+		{
+			if (ITickliteSlab* Slab = Slabs[GroupIndex][Type].load(std::memory_order_acquire))
+			{
+				Body(*Slab);
+			}
+		}
+	}
 
 
 	
@@ -66,30 +117,13 @@ protected:
 	
 	TSharedPtr<TicklitePrototype> TickliteAdd(TSharedPtr<TicklitePrototype> AllocatedTL,  TicklitePhase Group)
 	{
-		switch (Group)
+		const int32 GroupIndex = GroupIndexOf(Group);
+		if (GroupIndex == INDEX_NONE)
 		{
-		case TicklitePhase::Early :
-			{
-				ExecutionGroups[0].Add(AllocatedTL);
-				return AllocatedTL;
-			}
-		case TicklitePhase::Normal :
-			{
-				ExecutionGroups[1].Add( AllocatedTL);
-				return AllocatedTL;
-			}
-		case TicklitePhase::Late :
-			{
-				ExecutionGroups[2].Add(AllocatedTL);
-				return AllocatedTL;
-			}
-		case TicklitePhase::FINAL_TICK_RESOLVE :
-			{
-				ExecutionGroups[3].Add(AllocatedTL);
-				return AllocatedTL;
-			}	
+			return nullptr;
 		}
-		return nullptr;
+		const TickliteCadence Cadence = AllocatedTL->Cadence;
+		return ExecutionGroups[GroupIndex].Add(MoveTemp(AllocatedTL), Cadence);
 	}
 	//we may be able to remove sim or move it outside the run loop. I don't think there's anything wrong with simulating
 	//as fast as we can, and it buys us a lot of perf time by not sleeping the thread until it's apply time.
@@ -117,13 +151,59 @@ public:
 	{
 		QueuedAdds->Enqueue(StampLiteRequest(ToAdd, Group));
 	}
+
+	//by value, into the slab for its exact type. prefer this for anything you don't need to keep a pointer to.
+	//any thread.
+	template <typename TicklikeType>
+	void RequestAddPooledTicklite(TicklikeType ToAdd, TicklitePhase Group)
+	{
+		const int32 GroupIndex = GroupIndexOf(Group);
+		if (GroupIndex == INDEX_NONE)
+		{
+			return;
+		}
+		std::atomic<ITickliteSlab*>& Slot = Slabs[GroupIndex][FTickliteSlabTypes::IndexOf<TicklikeType>()];
+		ITickliteSlab* Slab = Slot.load(std::memory_order_acquire);
+		if (!Slab)
+		{
+			ITickliteSlab* Fresh = new TTickliteSlab<TicklikeType>();
+			if (Slot.compare_exchange_strong(Slab, Fresh, std::memory_order_acq_rel))
+			{
+				Slab = Fresh;
+			}
+			else
+			{
+				delete Fresh;
+			}
+		}
+		static_cast<TTickliteSlab<TicklikeType>*>(Slab)->Add(MoveTemp(ToAdd));
+	}
 	
+	//calculate only, from any task. the cast runs with everyone else's once calculate is done. read it back in apply.
+	FTickliteQueryTicket QueueSphereCast(const FVector3d& From, const FVector3d& Direction, double Radius, double Distance,
+	                                     FBarrageKey IgnoreBody)
+	{
+		FScopeLock Lock(&PassQueriesLock);
+		return FTickliteQueryTicket{QueryPass, PassQueries.AddSphereCast(From, Direction, Radius, Distance, IgnoreBody)};
+	}
+
+	//apply only. null if the ticket is from an earlier pass, or physics wasn't up to run it.
+	const FBQueryResult* GetQueuedQuery(const FTickliteQueryTicket& Ticket) const
+	{
+		return Ticket.Pass == QueryPass && PassQueries.Results.IsValidIndex(Ticket.Index) ? &PassQueries.Results[Ticket.Index] : nullptr;
+	}
+
 	inline ArtilleryTime GetShadowNow()
 	const
 	{
 		return DispatchOwner->GetShadowNow();
 	}
 
+	uint64 GetTickliteTick() const
+	{
+		return DispatchOwner->GetTickliteTick();
+	}
+
 	AttrPtr GetAttrib(FSkeletonKey Target, AttribKey Attr)
 	{
 		return DispatchOwner->GetAttrib(Target, Attr);
@@ -174,15 +254,23 @@ public:
 	virtual ~FArtilleryTicklitesWorker() override
 	{
 		UE_LOG(LogTemp, Display, TEXT("Artillery: Destructing SimTicklites thread."));
+		for (auto& Group : Slabs)
+		{
+			for (std::atomic<ITickliteSlab*>& Slot : Group)
+			{
+				delete Slot.exchange(nullptr);
+			}
+		}
 	};
-	virtual bool QueueRollback()
+	//the busy worker calls this once it's replayed from Tick, before it lets apply go. whatever we calculated and
+	//queried for the coming apply saw the world it threw away, so that all gets done again first.
+	//ticklites themselves aren't rewound. what they've applied to attributes stands, and the physics inputs they fed
+	//the replayed ticks went in again from the record. This is one reason we advocate STRONGLY for the use of KEYS
+	//over references, as references to memmory location are not durable across rollbacks.
+	virtual bool QueueRollback(uint64 Tick)
 	{
-		//rollback is not implemented yet, but works by removing ticklikes added after the rollback's timestamp.
-		//then adding back in any expired ticklikes that should be revived, clearing the current tick, and beginning resim.
-		//Implementing this will not be easy, but it will suck a lot less than trying to do this with gameplay effects.
-		//This is one reason we advocate STRONGLY for the use of KEYS over references, as references to memmory location
-		//are not durable across rollbacks.
-		throw; 
+		bRollbackQueued.store(true, std::memory_order_release);
+		return true;
 	}
 
 	virtual bool Init() override
@@ -195,6 +283,14 @@ public:
 	}
 
 
+	void CalcLane(TickliteGroup& Lane)
+	{
+		ParallelFor(TEXT("Ticklites.Calculate"), Lane.Num(), MinTicklitesPerCalcBatch, [&Lane, this](int32 Index)
+		{
+			CalcINE(Lane[Index]);
+		});
+	}
+
 	//TODO: ADD NULL GUARDS OR COPY. PREFER GUARD.
 	void CalcINE(TSharedPtr<TicklitePrototype>& x)
 	{
@@ -209,19 +305,29 @@ public:
 		}
 	}
 
-	//adding cadence is going to be quite annoying.
+	//any thread. how the last tick's ticklites broke down by cadence.
+	FTickliteCadenceLoad GetCadenceLoad() const
+	{
+		FScopeLock Lock(&LoadLock);
+		return LastLoad;
+	}
+
+	//only the lanes due this tick get calculated or applied. see FTickliteLanes.
 	virtual uint32 Run() override
 	{
 		StartTicklitesSim->Wait();
 		DispatchOwner->ThreadSetup();
 		while(running) {
 
-			for(auto& Group : ExecutionGroups)
+			//calculate only touches the ticklite's own state, so a group can be spread over the task pool.
+			//apply stays on this thread and in group order below, which is what keeps things deterministic.
+			//we don't know which sim tick apply will be for until it starts, so this gets ready for the next one.
+			const uint64 Calculated = NextTick;
+			for (int32 GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex)
 			{
-				for(auto Tickable : Group)
-				{
-					CalcINE(Tickable);
-				}
+				TRACE_CPUPROFILER_EVENT_SCOPE_STR("Ticklites Calculate");
+				ExecutionGroups[GroupIndex].ForEachDueLane(Calculated, [this](int32, TickliteGroup& Lane) { CalcLane(Lane); });
+				ForEachSlab(GroupIndex, [Calculated](ITickliteSlab& Slab) { Slab.CalculateDue(Calculated, MinTicklitesPerCalcBatch); });
 			}
 			//if we have any ticklite requests, perform their calculations here and then
 			//add them.
@@ -239,35 +345,96 @@ public:
 				}
 				QueuedAdds->Dequeue();
 			}
+			for (int32 GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex)
+			{
+				ForEachSlab(GroupIndex, [](ITickliteSlab& Slab) { Slab.AdoptPending(); });
+			}
+			if (!PassQueries.Queries.IsEmpty())
+			{
+				DispatchOwner->RunQueryBatch(PassQueries);
+			}
 			StartTicklitesApply->Wait();
 			StartTicklitesApply->Reset(); // we can run long on sim, not on apply.
 
-
-
-			
-			for (auto& Group : ExecutionGroups)
+			const uint64 Due = GetTickliteTick();
+			if (bRollbackQueued.exchange(false, std::memory_order_acquire))
 			{
-				//this is just to make it clearer, 0 works just as well.
-				int finalsize =  Group.IsEmpty() ? -1 : Group.Num();
-				for(int index = 0; index < finalsize;)
+				TRACE_CPUPROFILER_EVENT_SCOPE_STR("Ticklites Calculate After Rollback");
+				//tickets from the old pass go stale, and read as no result rather than the wrong one.
+				PassQueries.Reset();
+				++QueryPass;
+				for (int32 GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex)
+				{
+					ExecutionGroups[GroupIndex].ForEachDueLane(Due, [this](int32, TickliteGroup& Lane) { CalcLane(Lane); });
+					ForEachSlab(GroupIndex, [Due](ITickliteSlab& Slab) { Slab.CalculateDue(Due, MinTicklitesPerCalcBatch); });
+				}
+				if (!PassQueries.Queries.IsEmpty())
 				{
-					//either a ticklite expires, and the count remaining drops by one, or we process it and move to next.
-					if(Group[index]->ShouldExpireTickable())
+					DispatchOwner->RunQueryBatch(PassQueries);
+				}
+			}
+			else if (Due != Calculated)
+			{
+				//the sim skipped a tick, or this is the first one. catch up the lanes we didn't see coming.
+				TRACE_CPUPROFILER_EVENT_SCOPE_STR("Ticklites Calculate Catch Up");
+				const int32 QueuedBefore = PassQueries.Queries.Num();
+				for (int32 GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex)
+				{
+					ExecutionGroups[GroupIndex].ForEachLaneDueInstead(Due, Calculated, [this](int32, TickliteGroup& Lane) { CalcLane(Lane); });
+					ForEachSlab(GroupIndex, [Due, Calculated](ITickliteSlab& Slab)
 					{
-						Group[index]->OnExpireTickable();
-						//TODO good chance we must save the ticklites from older frames that have expired if we want any hope at determinism
-						//TODO THIS VIOLATES ORDERING. ...kinda. it's complicated. look, you almost certainly don't want it here.
-						//we probably need to use sorted array anyway.
-						Group.RemoveAtSwap(index, EAllowShrinking::No); //https://github.com/JKurzer/Bristle54/issues/24#issue-2567178871 GH Issue 24: SWQP?!
-						
-						--finalsize;//hohoho. merry nothingmas.
-					}
-					else
+						Slab.CalculateDueInstead(Due, Calculated, MinTicklitesPerCalcBatch);
+					});
+				}
+				if (PassQueries.Queries.Num() != QueuedBefore)
+				{
+					DispatchOwner->RunQueryBatch(PassQueries);
+				}
+			}
+			
+			FTickliteCadenceLoad Load;
+			for (int32 GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex)
+			{
+				ExecutionGroups[GroupIndex].ForEachDueLane(Due, [&Load](int32 CadenceIndex, TickliteGroup& Group)
+				{
+					Load.Ran[CadenceIndex] += Group.Num();
+					//this is just to make it clearer, 0 works just as well.
+					int finalsize =  Group.IsEmpty() ? -1 : Group.Num();
+					for(int index = 0; index < finalsize;)
 					{
-						Group[index]->ApplyTickable();
-						index++;
+						//either a ticklite expires, and the count remaining drops by one, or we process it and move to next.
+						if(Group[index]->ShouldExpireTickable())
+						{
+							Group[index]->OnExpireTickable();
+							//TODO good chance we must save the ticklites from older frames that have expired if we want any hope at determinism
+							//TODO THIS VIOLATES ORDERING. ...kinda. it's complicated. look, you almost certainly don't want it here.
+							//we probably need to use sorted array anyway.
+							Group.RemoveAtSwap(index, EAllowShrinking::No); //https://github.com/JKurzer/Bristle54/issues/24#issue-2567178871 GH Issue 24: SWQP?!
+							
+							--finalsize;//hohoho. merry nothingmas.
+						}
+						else
+						{
+							Group[index]->ApplyTickable();
+							index++;
+						}
 					}
-				}
+				});
+				//pooled ones go after the shared ones in the same phase. ordering between them is no more promised than within.
+				ForEachSlab(GroupIndex, [Due, &Load](ITickliteSlab& Slab) { Slab.ApplyDue(Due, Load); });
+			}
+			NextTick = Due + 1;
+			PassQueries.Reset();
+			++QueryPass;
+
+			for (int32 GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex)
+			{
+				ExecutionGroups[GroupIndex].AddLoad(Load);
+				ForEachSlab(GroupIndex, [&Load](ITickliteSlab& Slab) { Slab.AddLoad(Load); });
+			}
+			{
+				FScopeLock Lock(&LoadLock);
+				LastLoad = Load;
 			}
 
 
@@ -15,6 +15,7 @@ class FTSphereCast : public UArtilleryDispatch::TL_ThreadedImpl
 	FVector RayStart;
 	FVector RayDirection;
 	TSharedPtr<FHitResult> HitResultPtr;
+	FTickliteQueryTicket Cast;
 	std::function<void(FVector, TSharedPtr<FHitResult>)> Callback;
 
 public:
@@ -45,26 +46,32 @@ public:
 	{
 	}
 
+	//queued rather than cast here, so every sphere cast ticklite this tick goes out in one batch. see QueueSphereCast.
 	void TICKLITE_Calculate()
 	{
-		UBarrageDispatch* Physics = this->ADispatch->DispatchOwner->GetWorld()->GetSubsystem<UBarrageDispatch>();
-		if (Physics)
-		{
-			const JPH::DefaultBroadPhaseLayerFilter BroadPhaseFilter = Physics->GetDefaultBroadPhaseLayerFilter(Layers::CAST_QUERY);
-			const JPH::DefaultObjectLayerFilter ObjectLayerFilter = Physics->GetDefaultLayerFilter(Layers::CAST_QUERY);
-			const JPH::IgnoreSingleBodyFilter BodyFilter = Physics->GetFilterToIgnoreSingleBody(ShapeCastSourceObject);
-			
-			Physics->SphereCast(Radius, Distance, RayStart, RayDirection, HitResultPtr, BroadPhaseFilter, ObjectLayerFilter, BodyFilter);
-
-			if (Callback && HitResultPtr->MyItem != JPH::BodyID::cInvalidBodyID)
-			{
-				Callback(RayStart, HitResultPtr);
-			}
-		}
+		Cast = this->ADispatch->QueueSphereCast(RayStart, RayDirection, Radius, Distance, ShapeCastSourceObject);
 	}
 
 	void TICKLITE_Apply()
 	{
+		//same hit result the single SphereCast fills, so callbacks don't care which one it came from.
+		HitResultPtr->Init();
+		HitResultPtr->MyItem = JPH::BodyID::cInvalidBodyID;
+		const FBQueryResult* Hit = this->ADispatch->GetQueuedQuery(Cast);
+		if (Hit && Hit->bHit)
+		{
+			HitResultPtr->MyItem = Hit->BodyID;
+			HitResultPtr->bBlockingHit = true;
+			HitResultPtr->Location = FVector(Hit->Location);
+			HitResultPtr->ImpactPoint = FVector(Hit->Location);
+			HitResultPtr->ImpactNormal = FVector(Hit->Normal);
+			HitResultPtr->Distance = Hit->Distance;
+		}
+		//the callback can do whatever it likes, so it waits for apply rather than running alongside other calculates.
+		if (Callback && HitResultPtr->MyItem != JPH::BodyID::cInvalidBodyID)
+		{
+			Callback(RayStart, HitResultPtr);
+		}
 		--TicksRemaining;
 	}
 
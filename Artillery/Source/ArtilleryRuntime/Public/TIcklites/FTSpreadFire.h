@@ -64,8 +64,6 @@ public:
 		check(TransformDispatch);
 
 		// Query potential targets
-		TArray<uint32> BodyIDsFound;
-		BodyIDsFound.Reserve(MAX_FOUND_OBJECTS);
 		for (uint32 ActorIndex = 0; ActorIndex < NumberOfActors; ++ActorIndex)
 		{
 			const ActorKey& CurrentKey = (*ActorsToSearch)[ActorIndex];
@@ -76,14 +74,14 @@ public:
 			const auto ObjectLayerFilter = Physics->GetDefaultLayerFilter(Layers::CAST_QUERY);
 			const JPH::IgnoreSingleBodyFilter BodyFilter = Physics->GetFilterToIgnoreSingleBody(ActorFiblet);
 			
-			uint32 BodiesFoundNearTarget = 0;
-			Physics->SphereSearch(SourceObject, ActorLocation, this->ImpactRadius, BroadPhaseFilter, ObjectLayerFilter, BodyFilter, &BodiesFoundNearTarget, BodyIDsFound);
+			//lands in this thread's query arena, so no per-search allocation. done with it before the next search.
+			TArrayView<const FBFoundBody> BodiesFoundNearTarget = Physics->SphereSearch(ActorLocation, this->ImpactRadius, BroadPhaseFilter, ObjectLayerFilter, BodyFilter);
 
 			// Process bodies we found to count enemies
 			uint32 EnemyCounter = 0;
-			for (uint32 BodyCounterIndex = 0; BodyCounterIndex < BodiesFoundNearTarget; ++BodyCounterIndex)
+			for (const FBFoundBody& Found : BodiesFoundNearTarget)
 			{
-				const uint32 BodyID = BodyIDsFound[BodyCounterIndex];
+				const uint32 BodyID = Found.BodyID;
 
 				// If the other body isn't in the map, we need to check if it's an enemy
 				if (!EnemyBodyIDs.Contains(BodyID))
@@ -0,0 +1,130 @@
+#include "BarrageContactRouter.h"
+
+FBContactSubscription FBarrageContactRouter::Subscribe(const FBContactFilter& Filter, FOnBarrageContactBatch Deliver)
+{
+	FWriteScopeLock Lock(SubscriberLock);
+	FSubscriber& Added = Subscribers.AddDefaulted_GetRef();
+	Added.Handle = NextHandle++;
+	Added.Filter = Filter;
+	Added.Deliver = MoveTemp(Deliver);
+	RebuildInterest();
+	return Added.Handle;
+}
+
+void FBarrageContactRouter::Unsubscribe(FBContactSubscription Subscription)
+{
+	FWriteScopeLock Lock(SubscriberLock);
+	Subscribers.RemoveAll([Subscription](const FSubscriber& Subscriber)
+	{
+		return Subscriber.Handle == Subscription;
+	});
+	RebuildInterest();
+}
+
+void FBarrageContactRouter::RebuildInterest()
+{
+	uint32 Rebuilt[TypeCount][LayerSlots] = {};
+	for (const FSubscriber& Subscriber : Subscribers)
+	{
+		const FBContactFilter& Filter = Subscriber.Filter;
+		for (int32 Type = 0; Type < TypeCount; ++Type)
+		{
+			if (!(Filter.EventTypes & (1 << Type)))
+			{
+				continue;
+			}
+			for (int32 Layer = 0; Layer < LayerSlots; ++Layer)
+			{
+				//either body can be the A side, so the table has to be symmetric.
+				if (Filter.LayersA & (1u << Layer))
+				{
+					Rebuilt[Type][Layer] |= Filter.LayersB;
+				}
+				if (Filter.LayersB & (1u << Layer))
+				{
+					Rebuilt[Type][Layer] |= Filter.LayersA;
+				}
+			}
+		}
+	}
+	for (int32 Type = 0; Type < TypeCount; ++Type)
+	{
+		for (int32 Layer = 0; Layer < LayerSlots; ++Layer)
+		{
+			Interest[Type][Layer].store(Rebuilt[Type][Layer], std::memory_order_relaxed);
+		}
+	}
+}
+
+void FBarrageContactRouter::Stage(const BarrageContactEvent& Event)
+{
+	const uint64 One = Event.ContactEntity1.ContactKey.KeyIntoBarrage;
+	const uint64 Two = Event.ContactEntity2.ContactKey.KeyIntoBarrage;
+	FPairKey Pair;
+	Pair.Low = FMath::Min(One, Two);
+	Pair.High = FMath::Max(One, Two);
+	Pair.Type = static_cast<uint8>(Event.ContactEventType);
+	bool bAlreadyStaged = false;
+	StagedPairs.Add(Pair, &bAlreadyStaged);
+	if (!bAlreadyStaged)
+	{
+		Staged.Add(Event);
+	}
+}
+
+bool FBarrageContactRouter::SideMatches(uint32 LayerMask, uint64 KeyType, const BarrageContactEntity& Entity, FSkeletonKey Resolved)
+{
+	return (LayerMask & FBContactFilter::Layer(Entity.MyLayer))
+		&& (KeyType == SKELLY::SFIX_NONE || IS_OF_SK_TYPE(Resolved.Obj, KeyType));
+}
+
+void FBarrageContactRouter::Route(TFunctionRef<FSkeletonKey(FBarrageKey)> ResolveKey)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Barrage Route Contacts");
+	if (Staged.IsEmpty())
+	{
+		return;
+	}
+	{
+		FReadScopeLock Lock(SubscriberLock);
+		bool bAnyKeyTypes = false;
+		for (const FSubscriber& Subscriber : Subscribers)
+		{
+			bAnyKeyTypes |= Subscriber.Filter.KeyTypeA != SKELLY::SFIX_NONE || Subscriber.Filter.KeyTypeB != SKELLY::SFIX_NONE;
+		}
+
+		for (const BarrageContactEvent& Event : Staged)
+		{
+			const uint8 TypeBit = 1 << static_cast<uint8>(Event.ContactEventType);
+			//one lookup per body per event, however many subscribers want key types.
+			const FSkeletonKey One = bAnyKeyTypes ? ResolveKey(Event.ContactEntity1.ContactKey) : FSkeletonKey();
+			const FSkeletonKey Two = bAnyKeyTypes ? ResolveKey(Event.ContactEntity2.ContactKey) : FSkeletonKey();
+			for (FSubscriber& Subscriber : Subscribers)
+			{
+				const FBContactFilter& Filter = Subscriber.Filter;
+				if (!(Filter.EventTypes & TypeBit))
+				{
+					continue;
+				}
+				const bool bForward = SideMatches(Filter.LayersA, Filter.KeyTypeA, Event.ContactEntity1, One)
+					&& SideMatches(Filter.LayersB, Filter.KeyTypeB, Event.ContactEntity2, Two);
+				if (bForward || (SideMatches(Filter.LayersA, Filter.KeyTypeA, Event.ContactEntity2, Two)
+					&& SideMatches(Filter.LayersB, Filter.KeyTypeB, Event.ContactEntity1, One)))
+				{
+					Subscriber.Batch.Add(Event);
+				}
+			}
+		}
+
+		for (FSubscriber& Subscriber : Subscribers)
+		{
+			if (!Subscriber.Batch.IsEmpty())
+			{
+				Subscriber.Deliver.ExecuteIfBound(Subscriber.Batch);
+				Subscriber.Batch.Reset();
+			}
+		}
+	}
+	Staged.Reset();
+	StagedPairs.Reset();
+}
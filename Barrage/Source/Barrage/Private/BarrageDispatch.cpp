@@ -22,6 +22,7 @@ bool UBarrageDispatch::RegistrationImplementation()
 	UE_LOG(LogTemp, Warning, TEXT("Barrage:TransformUpdateQueue: Online"));
 	GameTransformPump = MakeShareable(new TransformUpdatesForGameThread(20024));
 	ContactEventPump = MakeShareable(new TCircularQueue<BarrageContactEvent>(8192));
+	ContactRouter = MakeShareable(new FBarrageContactRouter());
 	FBarragePrimitive::GlobalBarrage = this;
 	//this approach may actually be too slow. it is pleasingly lockless, but it allocs 16megs
 	//and just iterating through that could be Rough for the gamethread.
@@ -35,6 +36,7 @@ bool UBarrageDispatch::RegistrationImplementation()
 	JoltGameSim = MakeShareable(new FWorldSimOwner(TickRateInDelta, bind));
 	JoltBodyLifecycleMapping = MakeShareable(new KeyToFBLet());
 	TranslationMapping = MakeShareable(new KeyToKey());
+	PendingTombs = MakeShareable(new TQueue<FBLet, EQueueMode::Mpsc>());
 	SelfPtr = this;
 	return true;
 }
@@ -87,6 +89,7 @@ void UBarrageDispatch::Deinitialize()
 	Super::Deinitialize();
 	JoltBodyLifecycleMapping = nullptr;
 	TranslationMapping = nullptr;
+	PendingTombs = nullptr;
 	for (TSharedPtr<TArray<FBLet>>& TombFibletArray : Tombs)
 	{
 		TombFibletArray = nullptr;
@@ -117,6 +120,7 @@ void UBarrageDispatch::Deinitialize()
 		HoldOpen2->Empty();
 	}
 	HoldOpen2 = nullptr;
+	ContactRouter = nullptr;
 }
 
 void UBarrageDispatch::SphereCast(
@@ -158,6 +162,22 @@ void UBarrageDispatch::SphereSearch(
 	JoltGameSim->SphereSearch(CastingBodyID, Location, Radius, BroadPhaseFilter, ObjectFilter, BodiesFilter, OutFoundObjectCount, OutFoundObjects);
 }
 
+TArrayView<const FBFoundBody> UBarrageDispatch::SphereSearch(
+	FVector3d Location,
+	double Radius,
+	const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+	const JPH::ObjectLayerFilter& ObjectFilter,
+	const JPH::BodyFilter& BodiesFilter,
+	const FBSearchParams& Params) const
+{
+	if (Location.ContainsNaN())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Attempted to SphereSearch with a NaN value in the Location! [%s]"), *Location.ToString());
+		return TArrayView<const FBFoundBody>();
+	}
+	return JoltGameSim->SphereSearch(Location, Radius, BroadPhaseFilter, ObjectFilter, BodiesFilter, Params);
+}
+
 void UBarrageDispatch::CastRay(
 	FVector3d CastFrom,
 	FVector3d Direction,
@@ -172,6 +192,15 @@ void UBarrageDispatch::CastRay(
 	}
 }
 
+void UBarrageDispatch::RunQueryBatch(FBQueryBatch& Batch) const
+{
+	TSharedPtr<FWorldSimOwner> HoldOpen = JoltGameSim;
+	if (HoldOpen)
+	{
+		HoldOpen->RunQueryBatch(Batch);
+	}
+}
+
 //Defactoring the pointer management has actually made this much clearer than I expected.
 //these functions are overload polymorphic against our non-polymorphic POD params classes.
 //this is because over time, the needs of these classes may diverge and multiply
@@ -202,8 +231,9 @@ FBLet UBarrageDispatch::CreatePrimitive(FBCharParams& Definition, FSkeletonKey O
 {
 	if (JoltGameSim)
 	{
-		FBarrageKey temp = JoltGameSim->CreatePrimitive(Definition, Layer);
-		return ManagePointers(OutKey, temp, FBShape::Character);
+		FBarrageKey temp = JoltGameSim->CreatePrimitive(Definition, Layer, OutKey);
+		//a zero key means the character registry wouldn't take it.
+		return temp.KeyIntoBarrage != 0 ? ManagePointers(OutKey, temp, FBShape::Character) : nullptr;
 	}
 	return nullptr;
 }
@@ -228,6 +258,90 @@ FBLet UBarrageDispatch::CreatePrimitive(FBCapParams& Definition, FSkeletonKey Ou
 	return nullptr;
 }
 
+TArray<FBLet> UBarrageDispatch::CreatePrimitives(TArray<FBBoxParams>& Definitions, const TArray<FSkeletonKey>& OutKeys, uint16 Layer, bool isSensor, bool forceDynamic)
+{
+	TArray<FBLet> Created;
+	if (JoltGameSim && ensure(Definitions.Num() == OutKeys.Num()))
+	{
+		TArray<JPH::BodyCreationSettings> Settings;
+		Settings.Reserve(Definitions.Num());
+		for (FBBoxParams& Definition : Definitions)
+		{
+			Settings.Add(JoltGameSim->MakeBodySettings(Definition, Layer, isSensor, forceDynamic));
+		}
+		TArray<FBarrageKey> temp;
+		JoltGameSim->CreateAndAddBodies(Settings, temp);
+		Created = ManagePointers(OutKeys, temp, Box);
+	}
+	return Created;
+}
+
+TArray<FBLet> UBarrageDispatch::CreateProjectiles(TArray<FBBoxParams>& Definitions, const TArray<FSkeletonKey>& OutKeys, uint16 Layer)
+{
+	TArray<FBLet> Created;
+	if (JoltGameSim && ensure(Definitions.Num() == OutKeys.Num()))
+	{
+		TArray<JPH::BodyCreationSettings> Settings;
+		Settings.Reserve(Definitions.Num());
+		for (FBBoxParams& Definition : Definitions)
+		{
+			Settings.Add(JoltGameSim->MakeBodySettings(Definition, Layer, true, true));
+		}
+		TArray<FBarrageKey> temp;
+		JoltGameSim->CreateAndAddBodies(Settings, temp);
+		Created = ManagePointers(OutKeys, temp, Projectile);
+	}
+	return Created;
+}
+
+TArray<FBLet> UBarrageDispatch::CreatePrimitives(TArray<FBSphereParams>& Definitions, const TArray<FSkeletonKey>& OutKeys, uint16 Layer, bool isSensor)
+{
+	TArray<FBLet> Created;
+	if (JoltGameSim && ensure(Definitions.Num() == OutKeys.Num()))
+	{
+		TArray<JPH::BodyCreationSettings> Settings;
+		Settings.Reserve(Definitions.Num());
+		for (FBSphereParams& Definition : Definitions)
+		{
+			Settings.Add(JoltGameSim->MakeBodySettings(Definition, Layer, isSensor));
+		}
+		TArray<FBarrageKey> temp;
+		JoltGameSim->CreateAndAddBodies(Settings, temp);
+		Created = ManagePointers(OutKeys, temp, FBShape::Sphere);
+	}
+	return Created;
+}
+
+TArray<FBLet> UBarrageDispatch::CreatePrimitives(TArray<FBCapParams>& Definitions, const TArray<FSkeletonKey>& OutKeys, uint16 Layer, bool isSensor, FMassByCategory::BMassCategories MassClass)
+{
+	TArray<FBLet> Created;
+	if (JoltGameSim && ensure(Definitions.Num() == OutKeys.Num()))
+	{
+		TArray<JPH::BodyCreationSettings> Settings;
+		Settings.Reserve(Definitions.Num());
+		for (FBCapParams& Definition : Definitions)
+		{
+			Settings.Add(JoltGameSim->MakeBodySettings(Definition, Layer, isSensor, MassClass));
+		}
+		TArray<FBarrageKey> temp;
+		JoltGameSim->CreateAndAddBodies(Settings, temp);
+		Created = ManagePointers(OutKeys, temp, Capsule);
+	}
+	return Created;
+}
+
+TArray<FBLet> UBarrageDispatch::ManagePointers(const TArray<FSkeletonKey>& OutKeys, const TArray<FBarrageKey>& Created, FBShape form) const
+{
+	TArray<FBLet> Managed;
+	Managed.Reserve(Created.Num());
+	for (int32 i = 0; i < Created.Num(); ++i)
+	{
+		//a zero key means jolt was out of bodies for this one.
+		Managed.Add(Created[i].KeyIntoBarrage != 0 ? ManagePointers(OutKeys[i], Created[i], form) : nullptr);
+	}
+	return Managed;
+}
+
 FBLet UBarrageDispatch::ManagePointers(FSkeletonKey OutKey, FBarrageKey temp, FBShape form) const
 {
 	//interestingly, you can't use auto here. don't try. it may allocate a raw pointer internal
@@ -237,6 +351,7 @@ FBLet UBarrageDispatch::ManagePointers(FSkeletonKey OutKey, FBarrageKey temp, FB
 	indirect->Me = form;
 	JoltBodyLifecycleMapping->insert_or_assign (indirect->KeyIntoBarrage, indirect);
 	TranslationMapping->insert_or_assign(indirect->KeyOutOfBarrage, indirect->KeyIntoBarrage);
+	JoltGameSim->BindSkeletonKey(indirect->KeyIntoBarrage, indirect->KeyOutOfBarrage);
 	return indirect;
 }
 
@@ -253,6 +368,7 @@ FBLet UBarrageDispatch::LoadComplexStaticMesh(FBTransform& MeshTransform,
 		{
 			JoltBodyLifecycleMapping->insert_or_assign(shared->KeyIntoBarrage, shared);
 			TranslationMapping->insert_or_assign(OutKey, shared->KeyIntoBarrage);
+			JoltGameSim->BindSkeletonKey(shared->KeyIntoBarrage, OutKey);
 		}
 		return shared;
 	}
@@ -326,65 +442,179 @@ TStatId UBarrageDispatch::GetStatId() const
 
 void UBarrageDispatch::StackUp() const
 {
+	//StackUp opens the barrage tick, so this is where the last one gets closed out.
+	PhaseTimings.EndTick();
+	StackUpFrom(nullptr);
+}
+
+void UBarrageDispatch::StackUpFrom(const FBRollbackRing::FSlot* Replayed) const
+{
+	FBarragePhaseTimings::FScope Timed(PhaseTimings, EBarragePhase::StackUp);
 	//currently, these are only characters but that could change. This would likely become a TMap then but maybe not.
-	if (JoltGameSim)
+	TSharedPtr<FWorldSimOwner> HoldOpen = JoltGameSim;
+	if (HoldOpen)
 	{
-		for (FWorldSimOwner::FBInputFeed WorldSimOwnerFeedMap : JoltGameSim->ThreadAcc)
+		FBPhysicsInputBatch& Batch = HoldOpen->InputBatch;
+		Batch.Reset();
+		//the busy worker's own feed is never kept. anything it feeds us in a replay, it made again for that tick.
+		FBRollbackRing::FSlot* Recording = Replayed ? nullptr : HoldOpen->Rollback.Current();
+		const std::thread::id Us = std::this_thread::get_id();
+		for (int32 Feed = 0; Feed < ALLOWED_THREADS_FOR_BARRAGE_PHYSICS; ++Feed)
 		{
+			const FWorldSimOwner::FBInputFeed& WorldSimOwnerFeedMap = HoldOpen->ThreadAcc[Feed];
+			const bool bOurs = WorldSimOwnerFeedMap.That == Us;
+			if (Replayed && !bOurs)
+			{
+				//a slot that was saved but never stacked up has no ends, and nothing to give.
+				if (Replayed->FeedEnds.IsValidIndex(Feed))
+				{
+					const int32 From = Feed == 0 ? 0 : Replayed->FeedEnds[Feed - 1];
+					Batch.Append(TArrayView<const FBPhysicsInput>(Replayed->Inputs.GetData() + From, Replayed->FeedEnds[Feed] - From));
+				}
+				continue;
+			}
+			const int32 From = Batch.Num();
 			//the threadmaps themselves are always allocated, but they may not be "valid"
-			const TSharedPtr<FWorldSimOwner::FBInputFeed::ThreadFeed> HoldOpenThreadQueue = WorldSimOwnerFeedMap.Queue;
-			if (WorldSimOwnerFeedMap.Queue && ((HoldOpenThreadQueue != nullptr)) && WorldSimOwnerFeedMap.That != std::thread::id()) //if there IS a thread.
+			const TSharedPtr<FWorldSimOwner::FBInputFeed::ThreadFeed, ESPMode::ThreadSafe> HoldOpenThreadQueue = WorldSimOwnerFeedMap.Queue;
+			if (HoldOpenThreadQueue && WorldSimOwnerFeedMap.That != std::thread::id()) //if there IS a thread.
 			{
-				while (HoldOpenThreadQueue.Get() && !HoldOpenThreadQueue->IsEmpty())
+				Batch.Drain(*HoldOpenThreadQueue);
+			}
+			if (Recording)
+			{
+				if (!bOurs)
 				{
-					const FBPhysicsInput* input = HoldOpenThreadQueue->Peek();
-
-					JPH::BodyID result;
-					const bool bID = JoltGameSim->BarrageToJoltMapping->find(input->Target, result);
-					if (bID && input->metadata == FBShape::Character)
-					{
-						UpdateCharacter(const_cast<FBPhysicsInput&>(*input));
-					}
-
-					if (bID && !result.IsInvalid() && input->metadata != FBShape::Character)
-					{
-						JPH::BodyInterface* BodyInt = JoltGameSim->body_interface;
-						switch (input->Action)
-						{
-						case PhysicsInputType::Rotation:
-							//prolly gonna wanna change this to add torque................... not sure.
-							BodyInt->SetRotation(result, input->State, JPH::EActivation::Activate);
-							break;
-						case PhysicsInputType::OtherForce:
-							BodyInt->AddForce(result, input->State.GetXYZ(), JPH::EActivation::Activate);
-							break;
-						case PhysicsInputType::Velocity:
-							BodyInt->SetLinearVelocity(result, input->State.GetXYZ());
-							break;
-						case PhysicsInputType::SetPosition:
-							BodyInt->SetPosition(result, input->State.GetXYZ(), JPH::EActivation::Activate);
-							break;
-						case PhysicsInputType::SelfMovement:
-							BodyInt->AddForce(result, input->State.GetXYZ(), JPH::EActivation::Activate);
-							break;
-						case PhysicsInputType::AIMovement:
-							BodyInt->AddForce(result, input->State.GetXYZ(), JPH::EActivation::Activate);
-							break;
-						case PhysicsInputType::SetGravityFactor:
-							BodyInt->SetGravityFactor(result, input->State.GetZ());
-							break;
-						default:
-							UE_LOG(LogTemp, Warning, TEXT("UBarrageDispatch::StackUp: Unimplemented handling for input action [%d]"), input->Action);
-						}
-					}
-					
-					HoldOpenThreadQueue->Dequeue();
+					Recording->Inputs.Append(Batch.GetInputs().GetData() + From, Batch.Num() - From);
 				}
+				Recording->FeedEnds.Add(Recording->Inputs.Num());
 			}
 		}
+		HoldOpen->Rollback.Close();
+		const int32 Drained = Batch.Num();
+		Batch.Coalesce();
+		ApplyPhysicsInputs(Batch);
+		if (!Replayed)
+		{
+			HoldOpen->InputPressure.NoteDrained(Drained, Batch.Num());
+		}
+	}
+}
+
+void UBarrageDispatch::SetRollbackWindow(int32 Ticks) const
+{
+	TSharedPtr<FWorldSimOwner> HoldOpen = JoltGameSim;
+	if (HoldOpen)
+	{
+		HoldOpen->Rollback.SetWindow(Ticks);
+	}
+}
+
+void UBarrageDispatch::SaveRollbackTick(uint64 TickCount, uint64 Time, uint64 Cookie) const
+{
+	TSharedPtr<FWorldSimOwner> HoldOpen = JoltGameSim;
+	if (HoldOpen)
+	{
+		HoldOpen->SaveTick(FBRollbackTick{TickCount, Time, Cookie});
 	}
 }
 
+bool UBarrageDispatch::RestoreRollbackTick(uint64 TickCount, TArray<FBRollbackTick>& OutReplay) const
+{
+	OutReplay.Reset();
+	TSharedPtr<FWorldSimOwner> HoldOpen = JoltGameSim;
+	return HoldOpen && HoldOpen->RestoreTick(TickCount, OutReplay);
+}
+
+void UBarrageDispatch::ReplayTick(const FBRollbackTick& Stepped)
+{
+	TSharedPtr<FWorldSimOwner> HoldOpen = JoltGameSim;
+	if (!HoldOpen)
+	{
+		return;
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Replay Tick");
+	//saving it again keeps the ticks after it restorable, now that they've changed.
+	const FBRollbackRing::FSlot* Replayed = HoldOpen->SaveTick(Stepped);
+	if (!Replayed)
+	{
+		return;
+	}
+	StackUpFrom(Replayed);
+	StepWorld(Stepped.Time, Stepped.Tick, true);
+}
+
+void UBarrageDispatch::ApplyPhysicsInputs(FBPhysicsInputBatch& Batch) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Apply Physics Inputs");
+	TSharedPtr<FWorldSimOwner> HoldOpen = JoltGameSim;
+	if (!HoldOpen || Batch.Num() == 0)
+	{
+		return;
+	}
+	Batch.Resolve([&HoldOpen](FBarrageKey Key)
+	{
+		JPH::BodyID Found;
+		HoldOpen->BarrageToJoltMapping->find(Key, Found);
+		return Found;
+	});
+
+	//one write lock over every body in the batch, instead of one lock and unlock per input. everything below goes
+	//through the no-lock interface, which is only okay because we're holding them. don't call anything in here that
+	//takes a body lock of its own.
+	const JPH::BodyLockInterface& Locks = HoldOpen->physics_system->GetBodyLockInterface();
+	TArrayView<const JPH::BodyID> Distinct = Batch.GetDistinctBodies();
+	const JPH::BodyLockInterface::MutexMask Held = Locks.GetMutexMask(Distinct.GetData(), Distinct.Num());
+	Locks.LockWrite(Held);
+	JPH::BodyInterface& BodyInt = HoldOpen->physics_system->GetBodyInterfaceNoLock();
+	TArrayView<const FBPhysicsInput> Inputs = Batch.GetInputs();
+	TArrayView<const JPH::BodyID> Bodies = Batch.GetBodies();
+	for (int32 Index = 0; Index < Inputs.Num(); ++Index)
+	{
+		const FBPhysicsInput& Input = Inputs[Index];
+		const JPH::BodyID result = Bodies[Index];
+		if (Input.metadata == FBShape::Character)
+		{
+			UpdateCharacter(const_cast<FBPhysicsInput&>(Input));
+			continue;
+		}
+		if (result.IsInvalid())
+		{
+			continue;
+		}
+		switch (Input.Action)
+		{
+		case PhysicsInputType::Rotation:
+			//prolly gonna wanna change this to add torque................... not sure.
+			BodyInt.SetRotation(result, Input.State, JPH::EActivation::Activate);
+			HoldOpen->MarkBodyChanged(result);
+			break;
+		case PhysicsInputType::OtherForce:
+			BodyInt.AddForce(result, Input.State.GetXYZ(), JPH::EActivation::Activate);
+			break;
+		case PhysicsInputType::Velocity:
+			BodyInt.SetLinearVelocity(result, Input.State.GetXYZ());
+			break;
+		case PhysicsInputType::SetPosition:
+			BodyInt.SetPosition(result, Input.State.GetXYZ(), JPH::EActivation::Activate);
+			HoldOpen->MarkBodyChanged(result);
+			HoldOpen->BroadphaseMaintenance.NoteTeleported();
+			break;
+		case PhysicsInputType::SelfMovement:
+			BodyInt.AddForce(result, Input.State.GetXYZ(), JPH::EActivation::Activate);
+			break;
+		case PhysicsInputType::AIMovement:
+			BodyInt.AddForce(result, Input.State.GetXYZ(), JPH::EActivation::Activate);
+			break;
+		case PhysicsInputType::SetGravityFactor:
+			BodyInt.SetGravityFactor(result, Input.State.GetZ());
+			break;
+		default:
+			UE_LOG(LogTemp, Warning, TEXT("UBarrageDispatch::StackUp: Unimplemented handling for input action [%d]"), Input.Action);
+		}
+	}
+	Locks.UnlockWrite(Held);
+}
+
 bool UBarrageDispatch::UpdateCharacters(TSharedPtr<TArray<FBPhysicsInput>> CharacterInputs) const
 {
 	return JoltGameSim->UpdateCharacters(CharacterInputs);
@@ -395,68 +625,94 @@ bool UBarrageDispatch::UpdateCharacter(FBPhysicsInput& CharacterInput) const
 	return JoltGameSim->UpdateCharacter(CharacterInput);
 }
 
-void UBarrageDispatch::StepWorld(uint64 Time, uint64_t TickCount)
+void UBarrageDispatch::StepWorld(uint64 Time, uint64_t TickCount, bool bReplay)
 {
 	auto PinSim = JoltGameSim;
 			
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Step World");
-	if (JoltGameSim)
+	if (JoltGameSim && !bReplay)
 	{
-		if(TickCount % 512)
+		//this used to run whenever TickCount % 512 was non-zero, which is nearly every tick. now it's driven by churn.
+		if (JoltGameSim->BroadphaseMaintenance.ShouldOptimize(TickCount))
 		{
-					
 			TRACE_CPUPROFILER_EVENT_SCOPE_STR("Broadphase Optimize");
+			FBarragePhaseTimings::FScope Timed(PhaseTimings, EBarragePhase::Optimize);
+			const uint64 Started = FPlatformTime::Cycles64();
 			//we set a mutable for debug purposes, so we can check if the first optimization has occured in cases of perf
 			//degeneration.
 			JoltGameSim->Optimized = JoltGameSim->OptimizeBroadPhase();
+			JoltGameSim->BroadphaseMaintenance.NoteOptimized(TickCount, FPlatformTime::Cycles64() - Started);
 		}
 		
-		CleanTombs();
-		JoltGameSim->StepSimulation();
-		TSharedPtr<TMap<FBarrageKey, TSharedPtr<FBCharacterBase>>> HoldOpenCharacters = JoltGameSim->CharacterToJoltMapping;
-		if(HoldOpenCharacters)
 		{
-			// ReSharper disable once CppTemplateArgumentsCanBeDeduced - disabled to clear warning that causes compiler error if "fixed"
-			for(TTuple<FBarrageKey, TSharedPtr<FBCharacterBase>> CharacterKeyAndBase : *HoldOpenCharacters)
+			FBarragePhaseTimings::FScope Timed(PhaseTimings, EBarragePhase::Tombstones);
+			CleanTombs();
+			//shapes only go unused when bodies die, so this rides along with tomb cleanup, every eight seconds or so.
+			if (TickCount % 1024 == 0 && JoltGameSim->PrimitiveShapeCache)
 			{
-				if (CharacterKeyAndBase.Value->mCharacter)
+				JoltGameSim->PrimitiveShapeCache->EvictUnused();
+			}
+		}
+	}
+	if (JoltGameSim)
+	{
+		bLegacyContactListeners.store(OnBarrageContactAddedDelegate.IsBound() || OnBarrageContactPersistedDelegate.IsBound()
+			|| OnBarrageContactRemovedDelegate.IsBound(), std::memory_order_relaxed);
+		{
+			FBarragePhaseTimings::FScope Timed(PhaseTimings, EBarragePhase::Physics);
+			bReplaying.store(bReplay, std::memory_order_relaxed);
+			JoltGameSim->StepSimulation();
+			bReplaying.store(false, std::memory_order_relaxed);
+		}
+		TransformExportScratch.Reset();
+		TSharedPtr<KeyToFBLet> HoldCuckooLifecycle = JoltBodyLifecycleMapping;
+		{
+			FBarragePhaseTimings::FScope Timed(PhaseTimings, EBarragePhase::Characters);
+			const TArray<FBCharacterEntry>& Stepped = JoltGameSim->StepCharacters();
+			//characters have no flesh, so they never show up in jolt's active list. they're always live, though.
+			for (const FBCharacterEntry& CharacterKeyAndBase : Stepped)
+			{
+				FBLet CharacterPrim;
+				if (CharacterKeyAndBase.Value->mCharacter && HoldCuckooLifecycle && HoldCuckooLifecycle->find(CharacterKeyAndBase.Key, CharacterPrim) && FBarragePrimitive::IsNotNull(CharacterPrim))
 				{
-					if (!CharacterKeyAndBase.Value->mCharacter->GetPosition().IsNaN())
-					{
-						CharacterKeyAndBase.Value->StepCharacter();
-					}
-					else
-					{
-						CharacterKeyAndBase.Value->mCharacter->SetLinearVelocity(CharacterKeyAndBase.Value->World->GetGravity());
-						CharacterKeyAndBase.Value->mCharacter->SetPosition(CharacterKeyAndBase.Value->mInitialPosition);
-						CharacterKeyAndBase.Value->mForcesUpdate = CharacterKeyAndBase.Value->World->GetGravity();
-						CharacterKeyAndBase.Value->StepCharacter();
-					}
+					TransformExportScratch.Add(TransformUpdate(
+						CharacterPrim->KeyOutOfBarrage,
+						Time,
+						CoordinateUtils::FromJoltRotation(CharacterKeyAndBase.Value->mCharacter->GetRotation()),
+						CoordinateUtils::FromJoltCoordinates(CharacterKeyAndBase.Value->mCharacter->GetPosition()),
+						0));
+				}
+			}
+		}
+
+		//only bodies that actually moved get exported. sleeping and static bodies cost nothing here, and we no longer
+		//hold the lifecycle table lock for the duration, which was blocking every other thread that touched it.
+		{
+			FBarragePhaseTimings::FScope Timed(PhaseTimings, EBarragePhase::TransformExport);
+			JoltGameSim->GatherMovedBodyTransforms(Time, TransformExportScratch);
+			TSharedPtr<TransformUpdatesForGameThread> HoldOpenPump = GameTransformPump;
+			if (HoldOpenPump)
+			{
+				TRACE_CPUPROFILER_EVENT_SCOPE_STR("Publish Transforms");
+				for (const TransformUpdate& Update : TransformExportScratch)
+				{
+					HoldOpenPump->Enqueue(Update);
 				}
 			}
 		}
 		
 		//maintain tombstones
-		TSharedPtr<KeyToFBLet> HoldCuckooLifecycle = JoltBodyLifecycleMapping;
-		auto HoldCuckooTranslation = TranslationMapping;
-		if (HoldCuckooLifecycle && HoldCuckooLifecycle.Get() && !HoldCuckooLifecycle.Get()->empty())
+		TSharedPtr<TQueue<FBLet, EQueueMode::Mpsc>> HoldOpenPendingTombs = PendingTombs;
+		if (HoldOpenPendingTombs && !bReplay)
 		{
-			for (std::pair<const FBarrageKey, TSharedPtr<FBarragePrimitive>> KeyAndBarragePrimitive : HoldCuckooLifecycle->lock_table())
+			FBLet Entombed;
+			while (HoldOpenPendingTombs->Dequeue(Entombed))
 			{
-				FBLet HoldOpenFBP = KeyAndBarragePrimitive.second;
-				//NOTE: nullity check here includes tombstone check. Hence the odd form of the SECOND check.
-				//in other words, this checks != null && !tombstoned
-				if (KeyAndBarragePrimitive.first.KeyIntoBarrage != 0 && FBarragePrimitive::IsNotNull(HoldOpenFBP))
-				{
-					FBarragePrimitive::TryUpdateTransformFromJolt(HoldOpenFBP, Time);
-					
-					//returns a bool that can be used for debug.
-				} //This checks for != null && tombstoned
-				else if(KeyAndBarragePrimitive.first.KeyIntoBarrage != 0 && HoldOpenFBP && HoldOpenFBP->tombstone != 0) //just to make it explicit.
+				if (Entombed)
 				{
-					//TODO: MAY NOT BE THREADSAFE. CHECK NLT 10/5/24
-					
-					Tombs[TombOffset]->Push(HoldOpenFBP);
+					//unbinding the key keeps the corpse out of the export while it waits out its tombstone.
+					JoltGameSim->BindSkeletonKey(Entombed->KeyIntoBarrage, FSkeletonKey());
+					Tombs[TombOffset]->Push(Entombed);
 				}
 			}
 		}
@@ -465,9 +721,11 @@ void UBarrageDispatch::StepWorld(uint64 Time, uint64_t TickCount)
 
 bool UBarrageDispatch::BroadcastContactEvents() const
 {
+	FBarragePhaseTimings::FScope Timed(PhaseTimings, EBarragePhase::ContactEvents);
 	if(GetWorld())
 	{
 		TSharedPtr<TCircularQueue<BarrageContactEvent>> HoldOpen = ContactEventPump;
+		TSharedPtr<FBarrageContactRouter> HoldOpenRouter = ContactRouter;
 
 		while(HoldOpen && !HoldOpen->IsEmpty())
 		{
@@ -476,6 +734,10 @@ bool UBarrageDispatch::BroadcastContactEvents() const
 			{
 				try
 				{
+					if (HoldOpenRouter)
+					{
+						HoldOpenRouter->Stage(*Update);
+					}
 					switch (Update->ContactEventType)
 					{
 						case EBarrageContactEventType::ADDED:
@@ -497,6 +759,21 @@ bool UBarrageDispatch::BroadcastContactEvents() const
 				}
 			}
 		}
+		if (HoldOpenRouter)
+		{
+			try
+			{
+				HoldOpenRouter->Route([this](FBarrageKey Key)
+				{
+					FBLet Prim = GetShapeRef(Key);
+					return FBarragePrimitive::IsNotNull(Prim) ? Prim->KeyOutOfBarrage : FSkeletonKey();
+				});
+			}
+			catch (...)
+			{
+				return false;
+			}
+		}
 		return true;
 	}
 	return false;
@@ -511,17 +788,29 @@ inline BarrageContactEvent ConstructContactEvent(EBarrageContactEventType EventT
 void UBarrageDispatch::HandleContactAdded(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold,
 									JPH::ContactSettings& ioSettings)
 {
+		if (!WantsContact(EBarrageContactEventType::ADDED, inBody1.GetObjectLayer(), inBody2.GetObjectLayer()))
+		{
+			return;
+		}
 		BarrageContactEvent ContactEventToEnqueue = ConstructContactEvent(EBarrageContactEventType::ADDED, this, inBody1, inBody2, inManifold, ioSettings);
 		ContactEventPump->Enqueue(ContactEventToEnqueue);
 }
 void UBarrageDispatch::HandleContactPersisted(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold,
 									JPH::ContactSettings& ioSettings)
 {
+		if (!WantsContact(EBarrageContactEventType::PERSISTED, inBody1.GetObjectLayer(), inBody2.GetObjectLayer()))
+		{
+			return;
+		}
 		BarrageContactEvent ContactEventToEnqueue = ConstructContactEvent(EBarrageContactEventType::PERSISTED, this, inBody1, inBody2, inManifold, ioSettings);
 		ContactEventPump->Enqueue(ContactEventToEnqueue);
 }
 void UBarrageDispatch::HandleContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) const
 {
+	if (!WantsContact(EBarrageContactEventType::REMOVED, Layers::NUM_LAYERS, Layers::NUM_LAYERS))
+	{
+		return;
+	}
 	auto BK1 = this->GenerateBarrageKeyFromBodyId(inSubShapePair.GetBody1ID());
 	auto BK2 = this->GenerateBarrageKeyFromBodyId(inSubShapePair.GetBody2ID());
 	BarrageContactEvent ContactEventToEnqueue(
@@ -531,6 +820,48 @@ void UBarrageDispatch::HandleContactRemoved(const JPH::SubShapeIDPair& inSubShap
 			ContactEventPump->Enqueue(ContactEventToEnqueue);
 }
 
+FBBroadphaseChurn UBarrageDispatch::GetBroadphaseChurn() const
+{
+	TSharedPtr<FWorldSimOwner> HoldOpen = JoltGameSim;
+	return HoldOpen ? HoldOpen->BroadphaseMaintenance.GetChurn() : FBBroadphaseChurn();
+}
+
+FBPhysicsInputStats UBarrageDispatch::GetPhysicsInputStats() const
+{
+	TSharedPtr<FWorldSimOwner> HoldOpen = JoltGameSim;
+	return HoldOpen ? HoldOpen->InputPressure.GetStats() : FBPhysicsInputStats();
+}
+
+FBContactSubscription UBarrageDispatch::SubscribeToContacts(const FBContactFilter& Filter, FOnBarrageContactBatch Deliver) const
+{
+	TSharedPtr<FBarrageContactRouter> HoldOpen = ContactRouter;
+	return HoldOpen ? HoldOpen->Subscribe(Filter, MoveTemp(Deliver)) : FBarrageContactRouter::InvalidSubscription;
+}
+
+void UBarrageDispatch::UnsubscribeFromContacts(FBContactSubscription Subscription) const
+{
+	TSharedPtr<FBarrageContactRouter> HoldOpen = ContactRouter;
+	if (HoldOpen)
+	{
+		HoldOpen->Unsubscribe(Subscription);
+	}
+}
+
+bool UBarrageDispatch::WantsContact(EBarrageContactEventType Type, uint8 LayerOne, uint8 LayerTwo) const
+{
+	if (bReplaying.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+	if (bLegacyContactListeners.load(std::memory_order_relaxed))
+	{
+		return true;
+	}
+	//not a hold open. this runs per contact on jolt's threads, and the router outlives any step.
+	const FBarrageContactRouter* Router = ContactRouter.Get();
+	return Router && Router->Wants(Type, LayerOne, LayerTwo);
+}
+
 FBarrageKey UBarrageDispatch::GenerateBarrageKeyFromBodyId(const JPH::BodyID& Input) const
 {
 	return JoltGameSim->GenerateBarrageKeyFromBodyId(Input);
@@ -0,0 +1,101 @@
+#include "BarragePhaseTimings.h"
+
+#include "BarrageDispatch.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 GBarragePhaseTimingLogInterval = 0;
+static FAutoConsoleVariableRef CVarBarragePhaseTimingLogInterval(
+	TEXT("barrage.PhaseTimings.LogInterval"),
+	GBarragePhaseTimingLogInterval,
+	TEXT("Log barrage per-phase tick timings every N ticks. 0 turns it off. At 128hz, 1280 is every ten seconds."));
+
+static FAutoConsoleCommandWithWorld CmdBarragePhaseTimingReport(
+	TEXT("barrage.PhaseTimings.Report"),
+	TEXT("Log p50/p95/p99/max for each phase of the barrage tick, over the last 1024 ticks."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UBarrageDispatch* Physics = World ? World->GetSubsystem<UBarrageDispatch>() : nullptr;
+		if (Physics)
+		{
+			Physics->PhaseTimings.RequestReport();
+		}
+	}));
+
+const TCHAR* FBarragePhaseTimings::PhaseName(EBarragePhase Phase)
+{
+	switch (Phase)
+	{
+	case EBarragePhase::StackUp: return TEXT("StackUp");
+	case EBarragePhase::Optimize: return TEXT("Optimize");
+	case EBarragePhase::Physics: return TEXT("Physics");
+	case EBarragePhase::Characters: return TEXT("Characters");
+	case EBarragePhase::TransformExport: return TEXT("TransformExport");
+	case EBarragePhase::Tombstones: return TEXT("Tombstones");
+	case EBarragePhase::ContactEvents: return TEXT("ContactEvents");
+	case EBarragePhase::Queries: return TEXT("Queries");
+	default: return TEXT("Unknown");
+	}
+}
+
+FBarragePhaseTimings::FBarragePhaseTimings()
+{
+	FMemory::Memzero(Samples);
+	FMemory::Memzero(Recorded);
+}
+
+void FBarragePhaseTimings::Record(EBarragePhase Phase, uint64 Cycles)
+{
+	const int32 Index = static_cast<int32>(Phase);
+	const double Micros = FPlatformTime::ToMilliseconds64(Cycles) * 1000.0;
+	Samples[Index][Recorded[Index] % SampleWindow] = static_cast<uint32>(FMath::Min(Micros, double(MAX_uint32)));
+	++Recorded[Index];
+}
+
+void FBarragePhaseTimings::EndTick()
+{
+	++TicksSinceReport;
+	const bool bIntervalElapsed = GBarragePhaseTimingLogInterval > 0 && TicksSinceReport >= static_cast<uint64>(GBarragePhaseTimingLogInterval);
+	if (bIntervalElapsed || bReportRequested.exchange(false, std::memory_order_relaxed))
+	{
+		Report();
+		TicksSinceReport = 0;
+	}
+}
+
+FBarragePhaseStats FBarragePhaseTimings::GetStats(EBarragePhase Phase) const
+{
+	FBarragePhaseStats Stats;
+	const int32 Index = static_cast<int32>(Phase);
+	const int32 Count = static_cast<int32>(FMath::Min<uint64>(Recorded[Index], SampleWindow));
+	if (Count == 0)
+	{
+		return Stats;
+	}
+	TArray<uint32, TInlineAllocator<SampleWindow>> Sorted;
+	Sorted.Append(Samples[Index], Count);
+	Sorted.Sort();
+	auto Percentile = [&Sorted, Count](double P)
+	{
+		return Sorted[FMath::Clamp(FMath::CeilToInt32(P * Count) - 1, 0, Count - 1)];
+	};
+	Stats.Count = Count;
+	Stats.P50 = Percentile(0.50);
+	Stats.P95 = Percentile(0.95);
+	Stats.P99 = Percentile(0.99);
+	Stats.Max = Sorted.Last();
+	return Stats;
+}
+
+void FBarragePhaseTimings::Report() const
+{
+	for (int32 Phase = 0; Phase < PhaseCount; ++Phase)
+	{
+		const FBarragePhaseStats Stats = GetStats(static_cast<EBarragePhase>(Phase));
+		if (Stats.Count == 0)
+		{
+			continue;
+		}
+		UE_LOG(LogTemp, Display, TEXT("Barrage phase %-16s n=%4d p50=%6uus p95=%6uus p99=%6uus max=%6uus"),
+		       PhaseName(static_cast<EBarragePhase>(Phase)), Stats.Count, Stats.P50, Stats.P95, Stats.P99, Stats.Max);
+	}
+}
@@ -0,0 +1,100 @@
+#include "BarrageRollback.h"
+
+#include "HAL/IConsoleManager.h"
+
+static int32 GBarrageRollbackEnabled = 0;
+static FAutoConsoleVariableRef CVarBarrageRollbackEnabled(
+	TEXT("barrage.Rollback.Enabled"),
+	GBarrageRollbackEnabled,
+	TEXT("Save the world before every tick so late input can roll back and replay. Costs a copy of every body a tick, so it's off by default."));
+
+bool FBRollbackRing::IsEnabled()
+{
+	return GBarrageRollbackEnabled != 0;
+}
+
+void FBRollbackRing::SetWindow(int32 Ticks)
+{
+	Window = FMath::Max(Ticks, 1);
+	Empty();
+}
+
+FBRollbackRing::FSlot* FBRollbackRing::Open(const FBRollbackTick& Stepped)
+{
+	CurrentSlot = nullptr;
+	if (!IsEnabled() || Window == 0)
+	{
+		if (Slots.Num())
+		{
+			Empty();
+		}
+		return nullptr;
+	}
+	if (Slots.Num() != Window)
+	{
+		Slots.SetNum(Window);
+	}
+
+	FSlot* Slot = Find(Stepped.Tick);
+	if (Slot)
+	{
+		Slot->State.Reset();
+	}
+	else
+	{
+		//ticks only go forward outside a replay, so anything at or past this one is from before a rollback we
+		//couldn't finish. it's no good to anyone now.
+		while (Count > 0 && Slots[IndexOf(0)].Stepped.Tick >= Stepped.Tick)
+		{
+			Newest = IndexOf(1);
+			--Count;
+		}
+		Newest = (Newest + 1) % Slots.Num();
+		Count = FMath::Min(Count + 1, Slots.Num());
+		Slot = &Slots[Newest];
+		Slot->State.Reset();
+		Slot->Inputs.Reset();
+		Slot->FeedEnds.Reset();
+	}
+	Slot->Stepped = Stepped;
+	CurrentSlot = Slot;
+	return Slot;
+}
+
+FBRollbackRing::FSlot* FBRollbackRing::Find(uint64 Tick)
+{
+	for (int32 Age = 0; Age < Count; ++Age)
+	{
+		FSlot& Slot = Slots[IndexOf(Age)];
+		if (Slot.Stepped.Tick == Tick)
+		{
+			return &Slot;
+		}
+		if (Slot.Stepped.Tick < Tick)
+		{
+			break;
+		}
+	}
+	return nullptr;
+}
+
+void FBRollbackRing::TicksFrom(uint64 Tick, TArray<FBRollbackTick>& Out) const
+{
+	Out.Reset();
+	for (int32 Age = Count - 1; Age >= 0; --Age)
+	{
+		const FSlot& Slot = Slots[IndexOf(Age)];
+		if (Slot.Stepped.Tick >= Tick)
+		{
+			Out.Add(Slot.Stepped);
+		}
+	}
+}
+
+void FBRollbackRing::Empty()
+{
+	Slots.Empty();
+	Newest = -1;
+	Count = 0;
+	CurrentSlot = nullptr;
+}
@@ -0,0 +1,8 @@
+#include "BarrageSearch.h"
+
+FBQueryArena& FBQueryArena::ForThisThread()
+{
+	//about 8k per thread that ever searches, allocated the first time it does.
+	thread_local FBQueryArena Arena;
+	return Arena;
+}
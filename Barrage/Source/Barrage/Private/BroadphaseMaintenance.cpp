@@ -0,0 +1,82 @@
+#include "BroadphaseMaintenance.h"
+
+#include "BarrageDispatch.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 GBarrageBroadphaseChurnThreshold = 256;
+static FAutoConsoleVariableRef CVarBarrageBroadphaseChurnThreshold(
+	TEXT("barrage.Broadphase.ChurnThreshold"),
+	GBarrageBroadphaseChurnThreshold,
+	TEXT("Bodies added, removed or teleported before the broadphase is optimized again."));
+
+static int32 GBarrageBroadphaseMaxIntervalTicks = 1280;
+static FAutoConsoleVariableRef CVarBarrageBroadphaseMaxIntervalTicks(
+	TEXT("barrage.Broadphase.MaxIntervalTicks"),
+	GBarrageBroadphaseMaxIntervalTicks,
+	TEXT("Optimize anyway after this many ticks if there's been any churn at all, however little. 1280 is ten seconds at 128hz."));
+
+static int32 GBarrageBroadphaseMinIntervalTicks = 64;
+static FAutoConsoleVariableRef CVarBarrageBroadphaseMinIntervalTicks(
+	TEXT("barrage.Broadphase.MinIntervalTicks"),
+	GBarrageBroadphaseMinIntervalTicks,
+	TEXT("Never optimize more often than this many ticks apart, however much churn there's been."));
+
+static FAutoConsoleCommandWithWorld CmdBarrageBroadphaseReport(
+	TEXT("barrage.Broadphase.Report"),
+	TEXT("Log broadphase churn since the last optimize, and what the last optimize cost."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UBarrageDispatch* Physics = World ? World->GetSubsystem<UBarrageDispatch>() : nullptr;
+		if (Physics)
+		{
+			const FBBroadphaseChurn Churn = Physics->GetBroadphaseChurn();
+			UE_LOG(LogTemp, Display, TEXT("Barrage:Broadphase: %llu added, %llu removed, %llu teleported since tick %llu. %llu passes, last took %.3fms."),
+			       Churn.Added, Churn.Removed, Churn.Teleported, Churn.LastPassTick, Churn.Passes, Churn.LastPassMs);
+		}
+	}));
+
+bool FBBroadphaseMaintenance::ShouldOptimize(uint64 Tick) const
+{
+	const FBBroadphaseChurn Since = GetChurn();
+	const uint64 Churn = Since.Added + Since.Removed + Since.Teleported;
+	//nothing has been optimized yet, so anything at all is worth it.
+	if (Since.Passes == 0)
+	{
+		return Churn > 0;
+	}
+	if (Churn == 0)
+	{
+		return false;
+	}
+
+	//a tick behind the last pass means the sim started over, which is as good a time as any.
+	const uint64 Elapsed = Tick >= Since.LastPassTick ? Tick - Since.LastPassTick : MAX_uint64;
+	if (Elapsed < static_cast<uint64>(FMath::Max(GBarrageBroadphaseMinIntervalTicks, 1)))
+	{
+		return false;
+	}
+	return Churn >= static_cast<uint64>(FMath::Max(GBarrageBroadphaseChurnThreshold, 1))
+		|| Elapsed >= static_cast<uint64>(FMath::Max(GBarrageBroadphaseMaxIntervalTicks, 1));
+}
+
+void FBBroadphaseMaintenance::NoteOptimized(uint64 Tick, uint64 Cycles)
+{
+	AddedAtPass.store(Added.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	RemovedAtPass.store(Removed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	TeleportedAtPass.store(Teleported.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	LastPassCycles.store(Cycles, std::memory_order_relaxed);
+	LastPassTick.store(Tick, std::memory_order_relaxed);
+	Passes.fetch_add(1, std::memory_order_relaxed);
+}
+
+FBBroadphaseChurn FBBroadphaseMaintenance::GetChurn() const
+{
+	FBBroadphaseChurn Churn;
+	Churn.Added = Added.load(std::memory_order_relaxed) - AddedAtPass.load(std::memory_order_relaxed);
+	Churn.Removed = Removed.load(std::memory_order_relaxed) - RemovedAtPass.load(std::memory_order_relaxed);
+	Churn.Teleported = Teleported.load(std::memory_order_relaxed) - TeleportedAtPass.load(std::memory_order_relaxed);
+	Churn.Passes = Passes.load(std::memory_order_relaxed);
+	Churn.LastPassTick = LastPassTick.load(std::memory_order_relaxed);
+	Churn.LastPassMs = FPlatformTime::ToMilliseconds64(LastPassCycles.load(std::memory_order_relaxed));
+	return Churn;
+}
@@ -0,0 +1,170 @@
+#include "CharacterRegistry.h"
+#include "FWorldSimOwner.h"
+
+FBCharacterRegistry::FBCharacterRegistry()
+{
+}
+
+FBCharacterRegistry::~FBCharacterRegistry()
+{
+	for (std::atomic<FSlot*>& Page : Pages)
+	{
+		delete[] Page.exchange(nullptr);
+	}
+}
+
+FBCharacterRegistry::FSlot* FBCharacterRegistry::EnsureSlot(uint32 Index)
+{
+	std::atomic<FSlot*>& PageRef = Pages[Index / PageSize];
+	FSlot* Page = PageRef.load(std::memory_order_acquire);
+	if (!Page)
+	{
+		FSlot* Fresh = new FSlot[PageSize];
+		if (PageRef.compare_exchange_strong(Page, Fresh, std::memory_order_acq_rel))
+		{
+			Page = Fresh;
+		}
+		else
+		{
+			//someone beat us to it, and Page now holds theirs.
+			delete[] Fresh;
+		}
+	}
+	return Page + (Index % PageSize);
+}
+
+uint32 FBCharacterRegistry::ClaimSlot()
+{
+	//a reservation means some slot is Free or about to be, so the walk below always ends in a claim.
+	if (Occupied.fetch_add(1, std::memory_order_acq_rel) >= PageSize * MaxPages)
+	{
+		Occupied.fetch_sub(1, std::memory_order_relaxed);
+		return InvalidIndex;
+	}
+	//the hint can race past a slot that was freed at the same time, so if the top end is full, look below it too.
+	const uint32 Hint = FMath::Min(FirstMaybeFree.load(std::memory_order_relaxed), PageSize * MaxPages);
+	for (uint32 Step = 0; Step < PageSize * MaxPages; ++Step)
+	{
+		const uint32 Index = (Hint + Step) % (PageSize * MaxPages);
+		FSlot* Slot = EnsureSlot(Index);
+		uint8 Expected = Free;
+		if (Slot->State.compare_exchange_strong(Expected, Claimed, std::memory_order_acquire))
+		{
+			FirstMaybeFree.store(Index + 1, std::memory_order_relaxed);
+			uint32 High = HighWater.load(std::memory_order_relaxed);
+			while (High < Index + 1 && !HighWater.compare_exchange_weak(High, Index + 1, std::memory_order_release))
+			{
+			}
+			return Index;
+		}
+	}
+	Occupied.fetch_sub(1, std::memory_order_relaxed);
+	return InvalidIndex;
+}
+
+uint32 FBCharacterRegistry::Add(FBarrageKey Key, TSharedPtr<FBCharacterBase> Character)
+{
+	const uint32 Index = ClaimSlot();
+	if (Index == InvalidIndex)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Barrage:CharacterRegistry: out of character slots."));
+		return InvalidIndex;
+	}
+	FSlot* Slot = SlotAt(Index);
+	Slot->Key = Key;
+	Slot->Character = Character;
+	//live before it's findable, so a remove that finds it always has a live slot to kill.
+	LiveCount.fetch_add(1, std::memory_order_relaxed);
+	Slot->State.store(Live, std::memory_order_release);
+	FRecord Record;
+	Record.Index = Index;
+	Record.Character = Character;
+	if (!KeyToRecord.insert(Key, Record))
+	{
+		//the busy worker may already be looking at it, so it goes out the same way a removal does.
+		Slot->State.store(Dead, std::memory_order_release);
+		LiveCount.fetch_sub(1, std::memory_order_relaxed);
+		Removed.Enqueue(Index);
+		return InvalidIndex;
+	}
+	return Index;
+}
+
+bool FBCharacterRegistry::Remove(FBarrageKey Key)
+{
+	uint32 Index = InvalidIndex;
+	//only one remover gets the record, so only one marks the slot.
+	KeyToRecord.erase_fn(Key, [&Index](FRecord& Record)
+	{
+		Index = Record.Index;
+		return true;
+	});
+	if (Index == InvalidIndex)
+	{
+		return false;
+	}
+	SlotAt(Index)->State.store(Dead, std::memory_order_release);
+	LiveCount.fetch_sub(1, std::memory_order_relaxed);
+	Removed.Enqueue(Index);
+	return true;
+}
+
+TSharedPtr<FBCharacterBase> FBCharacterRegistry::Find(FBarrageKey Key) const
+{
+	TSharedPtr<FBCharacterBase> Found;
+	KeyToRecord.find_fn(Key, [&Found](const FRecord& Record)
+	{
+		Found = Record.Character;
+	});
+	return Found;
+}
+
+uint32 FBCharacterRegistry::IndexOf(FBarrageKey Key) const
+{
+	uint32 Index = InvalidIndex;
+	KeyToRecord.find_fn(Key, [&Index](const FRecord& Record)
+	{
+		Index = Record.Index;
+	});
+	return Index;
+}
+
+void FBCharacterRegistry::Snapshot(TArray<FBCharacterEntry>& Out) const
+{
+	Out.Reset(Num());
+	ForEachLive([&Out](uint32, FBarrageKey Key, const TSharedPtr<FBCharacterBase>& Character)
+	{
+		Out.Emplace(Key, Character);
+	});
+}
+
+void FBCharacterRegistry::BeginReclaim()
+{
+	uint32 Index;
+	while (Removed.Dequeue(Index))
+	{
+		Reclaiming.Add(Index);
+	}
+}
+
+void FBCharacterRegistry::FinishReclaim()
+{
+	uint32 Lowest = InvalidIndex;
+	for (uint32 Index : Reclaiming)
+	{
+		FSlot* Slot = SlotAt(Index);
+		Slot->Character.Reset();
+		Slot->Key = FBarrageKey();
+		Slot->State.store(Free, std::memory_order_release);
+		Occupied.fetch_sub(1, std::memory_order_release);
+		Lowest = FMath::Min(Lowest, Index);
+	}
+	Reclaiming.Reset();
+	if (Lowest != InvalidIndex)
+	{
+		uint32 Hint = FirstMaybeFree.load(std::memory_order_relaxed);
+		while (Lowest < Hint && !FirstMaybeFree.compare_exchange_weak(Hint, Lowest, std::memory_order_relaxed))
+		{
+		}
+	}
+}
@@ -0,0 +1,252 @@
+#include "CharacterVsCharacterGrid.h"
+
+#include "Algo/BinarySearch.h"
+
+using namespace JOLT;
+
+FBCharacterVsCharacterGrid::FBCharacterVsCharacterGrid(float InCellSize, float InMoveMargin)
+	: CellSize(InCellSize), InverseCellSize(1.0f / InCellSize), MoveMargin(InMoveMargin)
+{
+}
+
+void FBCharacterVsCharacterGrid::Add(CharacterVirtual* Character)
+{
+	FScopeLock Lock(&MembershipLock);
+	Characters.AddUnique(Character);
+}
+
+void FBCharacterVsCharacterGrid::Remove(const CharacterVirtual* Character)
+{
+	FScopeLock Lock(&MembershipLock);
+	Characters.RemoveSwap(const_cast<CharacterVirtual*>(Character));
+}
+
+FBCharacterVsCharacterGrid::FCellRange FBCharacterVsCharacterGrid::ToCellRange(const AABox& Bounds) const
+{
+	return FCellRange{
+		FMath::FloorToInt32(Bounds.mMin.GetX() * InverseCellSize),
+		FMath::FloorToInt32(Bounds.mMin.GetY() * InverseCellSize),
+		FMath::FloorToInt32(Bounds.mMin.GetZ() * InverseCellSize),
+		FMath::FloorToInt32(Bounds.mMax.GetX() * InverseCellSize),
+		FMath::FloorToInt32(Bounds.mMax.GetY() * InverseCellSize),
+		FMath::FloorToInt32(Bounds.mMax.GetZ() * InverseCellSize)
+	};
+}
+
+//21 bits an axis. at 2m cells, that wraps every ~4000km, which we are not going to hit.
+uint64 FBCharacterVsCharacterGrid::CellKey(int32 X, int32 Y, int32 Z)
+{
+	constexpr uint64 Mask = (1ull << 21) - 1;
+	return ((static_cast<uint64>(X) & Mask) << 42) | ((static_cast<uint64>(Y) & Mask) << 21) | (static_cast<uint64>(Z) & Mask);
+}
+
+//just enough of a character for jolt to collide against: shape, offset, padding, and its ID. no physics system, so
+//no inner body, and nothing it does can reach the world.
+Ref<CharacterVirtual> FBCharacterVsCharacterGrid::MakeFrozen(const CharacterVirtual* Character)
+{
+	CharacterVirtualSettings Settings;
+	Settings.mID = Character->GetID();
+	Settings.mShape = Character->GetShape();
+	Settings.mShapeOffset = Character->GetShapeOffset();
+	Settings.mCharacterPadding = Character->GetCharacterPadding();
+	Settings.mUp = Character->GetUp();
+	return new CharacterVirtual(&Settings, Character->GetPosition(), Character->GetRotation(), Character->GetUserData(), nullptr);
+}
+
+void FBCharacterVsCharacterGrid::Rebuild()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Character Grid Rebuild");
+	{
+		FScopeLock Lock(&MembershipLock);
+		Snapshot = Characters;
+	}
+
+	Frozen.Reset(Snapshot.Num());
+	FrozenByIdNext.Reset();
+	for (const CharacterVirtual* Character : Snapshot)
+	{
+		const uint32 Id = Character->GetID().GetValue();
+		Ref<CharacterVirtual>* Kept = FrozenById.Find(Id);
+		Ref<CharacterVirtual> Copy = Kept && (*Kept)->GetShape() == Character->GetShape() ? *Kept : MakeFrozen(Character);
+		Copy->SetPosition(Character->GetPosition());
+		Copy->SetRotation(Character->GetRotation());
+		Copy->SetLinearVelocity(Character->GetLinearVelocity());
+		Copy->SetUserData(Character->GetUserData());
+		Frozen.Add(Copy.GetPtr());
+		FrozenByIdNext.Add(Id, MoveTemp(Copy));
+	}
+	//anything that's left the grid lets go of its copy here.
+	Swap(FrozenById, FrozenByIdNext);
+
+	SnapshotRanges.Reset(Snapshot.Num());
+	Cells.Reset();
+	for (int32 Index = 0; Index < Snapshot.Num(); ++Index)
+	{
+		const CharacterVirtual* Character = Frozen[Index];
+		AABox Bounds = Character->GetShape()->GetWorldSpaceBounds(Character->GetCenterOfMassTransform(), Vec3::sOne());
+		Bounds.ExpandBy(Vec3::sReplicate(Character->GetCharacterPadding() + MoveMargin));
+		const FCellRange Range = ToCellRange(Bounds);
+		SnapshotRanges.Add(Range);
+		for (int32 X = Range.MinX; X <= Range.MaxX; ++X)
+		{
+			for (int32 Y = Range.MinY; Y <= Range.MaxY; ++Y)
+			{
+				for (int32 Z = Range.MinZ; Z <= Range.MaxZ; ++Z)
+				{
+					Cells.Add(TPair<uint64, int32>(CellKey(X, Y, Z), Index));
+				}
+			}
+		}
+	}
+	Cells.Sort([](const TPair<uint64, int32>& A, const TPair<uint64, int32>& B)
+	{
+		return A.Key < B.Key || (A.Key == B.Key && A.Value < B.Value);
+	});
+}
+
+template <typename VisitorType>
+void FBCharacterVsCharacterGrid::ForEachCandidate(const CharacterVirtual* Self, const AABox& QueryBounds, VisitorType&& Visit) const
+{
+	const FCellRange Query = ToCellRange(QueryBounds);
+	const int64 QueryCells = int64(Query.MaxX - Query.MinX + 1) * int64(Query.MaxY - Query.MinY + 1) * int64(Query.MaxZ - Query.MinZ + 1);
+	if (QueryCells > MaxCellsPerQuery)
+	{
+		for (int32 Index = 0; Index < Snapshot.Num(); ++Index)
+		{
+			if (Snapshot[Index] != Self)
+			{
+				Visit(Index);
+			}
+		}
+		return;
+	}
+
+	for (int32 X = Query.MinX; X <= Query.MaxX; ++X)
+	{
+		for (int32 Y = Query.MinY; Y <= Query.MaxY; ++Y)
+		{
+			for (int32 Z = Query.MinZ; Z <= Query.MaxZ; ++Z)
+			{
+				const uint64 Key = CellKey(X, Y, Z);
+				int32 At = Algo::LowerBoundBy(Cells, Key, [](const TPair<uint64, int32>& Cell) { return Cell.Key; });
+				for (; At < Cells.Num() && Cells[At].Key == Key; ++At)
+				{
+					const int32 Index = Cells[At].Value;
+					if (Snapshot[Index] == Self)
+					{
+						continue;
+					}
+					//a pair can share several cells. only visit it from the lowest cell that both ranges cover.
+					//this keeps queries free of any scratch state.
+					const FCellRange& Theirs = SnapshotRanges[Index];
+					if (X == FMath::Max(Query.MinX, Theirs.MinX)
+						&& Y == FMath::Max(Query.MinY, Theirs.MinY)
+						&& Z == FMath::Max(Query.MinZ, Theirs.MinZ))
+					{
+						Visit(Index);
+					}
+				}
+			}
+		}
+	}
+}
+
+//the narrow phase here is lifted straight from CharacterVsCharacterCollisionSimple. candidate selection differs, and
+//each candidate is its frozen copy.
+void FBCharacterVsCharacterGrid::CollideCharacter(const CharacterVirtual* inCharacter, RMat44Arg inCenterOfMassTransform,
+                                                  const CollideShapeSettings& inCollideShapeSettings, RVec3Arg inBaseOffset,
+                                                  CollideShapeCollector& ioCollector) const
+{
+	// Make shape 1 relative to inBaseOffset
+	Mat44 transform1 = inCenterOfMassTransform.PostTranslated(-inBaseOffset).ToMat44();
+
+	const Shape* shape1 = inCharacter->GetShape();
+	CollideShapeSettings settings = inCollideShapeSettings;
+
+	// Get bounds for character
+	AABox bounds1 = shape1->GetWorldSpaceBounds(transform1, Vec3::sOne());
+
+	//the grid lives in world space, so query with the un-offset bounds.
+	AABox WorldQuery = shape1->GetWorldSpaceBounds(inCenterOfMassTransform, Vec3::sOne());
+	WorldQuery.ExpandBy(Vec3::sReplicate(inCollideShapeSettings.mMaxSeparationDistance));
+
+	ForEachCandidate(inCharacter, WorldQuery, [&](int32 Index)
+	{
+		if (ioCollector.ShouldEarlyOut())
+		{
+			return;
+		}
+		const CharacterVirtual* c = Frozen[Index];
+		// Make shape 2 relative to inBaseOffset
+		Mat44 transform2 = c->GetCenterOfMassTransform().PostTranslated(-inBaseOffset).ToMat44();
+
+		// We need to add the padding of character 2 so that we will detect collision with its outer shell
+		settings.mMaxSeparationDistance = inCollideShapeSettings.mMaxSeparationDistance + c->GetCharacterPadding();
+
+		// Check if the bounding boxes of the characters overlap
+		const Shape* shape2 = c->GetShape();
+		AABox bounds2 = shape2->GetWorldSpaceBounds(transform2, Vec3::sOne());
+		bounds2.ExpandBy(Vec3::sReplicate(settings.mMaxSeparationDistance));
+		if (!bounds1.Overlaps(bounds2))
+		{
+			return;
+		}
+
+		// Collector needs to know which character we're colliding with
+		ioCollector.SetUserData(reinterpret_cast<uint64>(c));
+
+		// Note that this collides against the character's shape without padding, this will be corrected for in CharacterVirtual::GetContactsAtPosition
+		CollisionDispatch::sCollideShapeVsShape(shape1, shape2, Vec3::sOne(), Vec3::sOne(), transform1, transform2, SubShapeIDCreator(), SubShapeIDCreator(), settings, ioCollector);
+	});
+
+	// Reset the user data
+	ioCollector.SetUserData(0);
+}
+
+void FBCharacterVsCharacterGrid::CastCharacter(const CharacterVirtual* inCharacter, RMat44Arg inCenterOfMassTransform,
+                                               Vec3Arg inDirection, const ShapeCastSettings& inShapeCastSettings,
+                                               RVec3Arg inBaseOffset, CastShapeCollector& ioCollector) const
+{
+	// Convert shape cast relative to inBaseOffset
+	Mat44 transform1 = inCenterOfMassTransform.PostTranslated(-inBaseOffset).ToMat44();
+	ShapeCast shape_cast(inCharacter->GetShape(), Vec3::sOne(), transform1, inDirection);
+
+	// Get world space bounds of the character in the form of center and extent
+	Vec3 origin = shape_cast.mShapeWorldBounds.GetCenter();
+	Vec3 extents = shape_cast.mShapeWorldBounds.GetExtent();
+
+	//sweep the query bounds along the cast so we pick up anything it could reach.
+	AABox WorldQuery = inCharacter->GetShape()->GetWorldSpaceBounds(inCenterOfMassTransform, Vec3::sOne());
+	AABox WorldQueryEnd = WorldQuery;
+	WorldQueryEnd.Translate(inDirection);
+	WorldQuery.Encapsulate(WorldQueryEnd);
+
+	ForEachCandidate(inCharacter, WorldQuery, [&](int32 Index)
+	{
+		if (ioCollector.ShouldEarlyOut())
+		{
+			return;
+		}
+		const CharacterVirtual* c = Frozen[Index];
+		// Make shape 2 relative to inBaseOffset
+		Mat44 transform2 = c->GetCenterOfMassTransform().PostTranslated(-inBaseOffset).ToMat44();
+
+		// Sweep bounding box of the character against the bounding box of the other character to see if they can collide
+		const Shape* shape2 = c->GetShape();
+		AABox bounds2 = shape2->GetWorldSpaceBounds(transform2, Vec3::sOne());
+		bounds2.ExpandBy(extents);
+		if (!RayAABoxHits(origin, inDirection, bounds2.mMin, bounds2.mMax))
+		{
+			return;
+		}
+
+		// Collector needs to know which character we're colliding with
+		ioCollector.SetUserData(reinterpret_cast<uint64>(c));
+
+		// Note that this collides against the character's shape without padding, this will be corrected for in CharacterVirtual::GetFirstContactForSweep
+		CollisionDispatch::sCastShapeVsShapeWorldSpace(shape_cast, inShapeCastSettings, shape2, Vec3::sOne(), { }, transform2, SubShapeIDCreator(), SubShapeIDCreator(), ioCollector);
+	});
+
+	// Reset the user data
+	ioCollector.SetUserData(0);
+}
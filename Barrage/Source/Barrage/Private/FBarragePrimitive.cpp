@@ -13,15 +13,11 @@ FBarragePrimitive::~FBarragePrimitive()
 	//Only the CleanTombs function in dispatch actually releases the shared pointer on the dispatch side
 	//but an actor might hold a shared pointer to the primitive that represents it after that primitive has been
 	//popped out of this.
-	if (GlobalBarrage != nullptr && Me != FBShape::Character)
-	//TODO: This prevented the double free but we may now not free at all?
+	//characters go through here too now. the world sim knows not to destroy their inner body a second time.
+	if (GlobalBarrage != nullptr)
 	{
 		GlobalBarrage->FinalizeReleasePrimitive(KeyIntoBarrage);
 	}
-	else if (Me == FBShape::Character)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Character's last fblet is dealloc'd."));
-	}
 }
 
 //-----------------
@@ -36,7 +32,7 @@ void FBarragePrimitive::ApplyRotation(FQuat4d Rotator, FBLet Target)
 		TSharedPtr<FWorldSimOwner> GameSimHoldOpen = GlobalBarrage->JoltGameSim;
 		if (GameSimHoldOpen && MyBARRAGEIndex < ALLOWED_THREADS_FOR_BARRAGE_PHYSICS)
 		{
-			GameSimHoldOpen->ThreadAcc[MyBARRAGEIndex].Queue->Enqueue(
+			GameSimHoldOpen->EnqueueInput(MyBARRAGEIndex,
 				FBPhysicsInput(Target->KeyIntoBarrage, 0, PhysicsInputType::Rotation,CoordinateUtils::ToBarrageRotation(Rotator)));
 		}
 	}
@@ -62,11 +58,11 @@ bool FBarragePrimitive::TryUpdateTransformFromJolt(FBLet Target, uint64 Time)
 					{
 						//accumulate character update from OuterCharacter.
 						//SNAAAAAAAAAAAKE
-						TSharedPtr<FBCharacterBase>* CharacterRef = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
+						TSharedPtr<FBCharacterBase> CharacterRef = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
 						if (CharacterRef)
 						{
-							JPH::RVec3 Pos = CharacterRef->Get()->mCharacter->GetPosition();
-							JPH::Quat Rot = CharacterRef->Get()->mCharacter->GetRotation();
+							JPH::RVec3 Pos = CharacterRef->mCharacter->GetPosition();
+							JPH::Quat Rot = CharacterRef->mCharacter->GetRotation();
 							HoldOpen->Enqueue(TransformUpdate(
 								Target->KeyOutOfBarrage,
 								Time,
@@ -129,10 +125,10 @@ FVector3f FBarragePrimitive::GetPosition(FBLet Target)
 				}
 				if (Target->Me == FBShape::Character)
 				{
-					TSharedPtr<FBCharacterBase>* CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
-					if (CharacterActual && *CharacterActual)
+					TSharedPtr<FBCharacterBase> CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
+					if (CharacterActual)
 					{
-						return CoordinateUtils::FromJoltCoordinates(CharacterActual->Get()->mCharacter->GetPosition());
+						return CoordinateUtils::FromJoltCoordinates(CharacterActual->mCharacter->GetPosition());
 					}
 				}
 			}
@@ -153,10 +149,10 @@ FVector3f FBarragePrimitive::GetVelocity(FBLet Target)
 			{
 			case FBShape::Character:
 				{
-					TSharedPtr<FBCharacterBase>* CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
-					if (CharacterActual && *CharacterActual)
+					TSharedPtr<FBCharacterBase> CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
+					if (CharacterActual)
 					{
-						return CoordinateUtils::FromJoltCoordinates(CharacterActual->Get()->mEffectiveVelocity);
+						return CoordinateUtils::FromJoltCoordinates(CharacterActual->mEffectiveVelocity);
 					}
 				}
 				break;
@@ -180,7 +176,7 @@ void FBarragePrimitive::SetVelocity(FVector3d Velocity, FBLet Target)
 		{
 			JPH::Quat lastchance =  CoordinateUtils::ToBarrageVelocity(Velocity);
 			lastchance = lastchance.IsNaN() ? JPH::Quat::sZero() : lastchance;
-			GameSimHoldOpen->ThreadAcc[MyBARRAGEIndex].Queue->Enqueue(
+			GameSimHoldOpen->EnqueueInput(MyBARRAGEIndex,
 				FBPhysicsInput(Target->KeyIntoBarrage, 0, PhysicsInputType::Velocity, lastchance));
 		}
 	}
@@ -195,7 +191,7 @@ void FBarragePrimitive::SetPosition(FVector Position, FBLet Target)
 		{
 			JPH::Quat lastchance =  CoordinateUtils::ToBarrageVelocity(Position);
 			lastchance = lastchance.IsNaN() ? JPH::Quat::sZero() : lastchance;
-			GameSimHoldOpen->ThreadAcc[MyBARRAGEIndex].Queue->Enqueue(
+			GameSimHoldOpen->EnqueueInput(MyBARRAGEIndex,
 				FBPhysicsInput(Target->KeyIntoBarrage, 0, PhysicsInputType::SetPosition, lastchance));
 		}
 	}
@@ -209,7 +205,7 @@ void FBarragePrimitive::SetGravityFactor(float GravityFactor, FBLet Target)
 		TSharedPtr<FWorldSimOwner> GameSimHoldOpen = GlobalBarrage->JoltGameSim;
 		if (GameSimHoldOpen && MyBARRAGEIndex < ALLOWED_THREADS_FOR_BARRAGE_PHYSICS)
 		{
-			GameSimHoldOpen->ThreadAcc[MyBARRAGEIndex].Queue->Enqueue(
+			GameSimHoldOpen->EnqueueInput(MyBARRAGEIndex,
 				FBPhysicsInput(Target->KeyIntoBarrage, 0, PhysicsInputType::SetGravityFactor, JPH::Quat(0, 0, GravityFactor, 0)));
 		}
 	}
@@ -223,7 +219,7 @@ void FBarragePrimitive::Apply_Unsafe(FQuat4d Any, FBLet Target, PhysicsInputType
 		TSharedPtr<FWorldSimOwner> GameSimHoldOpen = GlobalBarrage->JoltGameSim;
 		if (GameSimHoldOpen && MyBARRAGEIndex < ALLOWED_THREADS_FOR_BARRAGE_PHYSICS)
 		{
-			GameSimHoldOpen->ThreadAcc[MyBARRAGEIndex].Queue->Enqueue(
+			GameSimHoldOpen->EnqueueInput(MyBARRAGEIndex,
 				FBPhysicsInput(Target->KeyIntoBarrage, 0, Type, JPH::Quat(Any.X, Any.Y, Any.Z, Any.W)));
 		}
 	}
@@ -236,7 +232,7 @@ void FBarragePrimitive::ApplyForce(FVector3d Force, FBLet Target, PhysicsInputTy
 		TSharedPtr<FWorldSimOwner> GameSimHoldOpen = GlobalBarrage->JoltGameSim;
 		if (GameSimHoldOpen && MyBARRAGEIndex < ALLOWED_THREADS_FOR_BARRAGE_PHYSICS)
 		{
-			GameSimHoldOpen->ThreadAcc[MyBARRAGEIndex].Queue->Enqueue(
+			GameSimHoldOpen->EnqueueInput(MyBARRAGEIndex,
 				FBPhysicsInput(Target->KeyIntoBarrage, 0, Type,CoordinateUtils::ToBarrageForce(Force)));
 		}
 	}
@@ -253,10 +249,10 @@ void FBarragePrimitive::SpeedLimit(FBLet Target, float TargetSpeed)
 			// if they exist... we proceed. this replaces the older faulty check.				  curry for safety.
 			if (GameSimHoldOpen->BarrageToJoltMapping->find(Target->KeyIntoBarrage, result) && Target->Me == FBShape::Character) 
 			{
-				TSharedPtr<FBCharacterBase>* CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
-				if (CharacterActual && *CharacterActual)
+				TSharedPtr<FBCharacterBase> CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
+				if (CharacterActual)
 				{
-					CharacterActual->Get()->mMaxSpeed = TargetSpeed/100;
+					CharacterActual->mMaxSpeed = TargetSpeed/100;
 				}
 			}
 		}
@@ -281,10 +277,10 @@ FBarragePrimitive::FBGroundState FBarragePrimitive::GetCharacterGroundState(FBLe
 				// exists	is a character.
 				if (Target->Me == FBShape::Character)
 				{
-					TSharedPtr<FBCharacterBase>* CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
-					if (CharacterActual && *CharacterActual)
+					TSharedPtr<FBCharacterBase> CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
+					if (CharacterActual)
 					{
-						JPH::Ref<JPH::CharacterVirtual> CharVirtual = CharacterActual->Get()->mCharacter;
+						JPH::Ref<JPH::CharacterVirtual> CharVirtual = CharacterActual->mCharacter;
 						return FromJoltGroundState(CharVirtual->GetGroundState());
 					}
 					return FBGroundState::NotFound;
@@ -310,10 +306,10 @@ FVector3f FBarragePrimitive::GetCharacterGroundNormal(FBLet Target)
 			}
 			if (Target->Me == FBShape::Character)
 			{
-				TSharedPtr<FBCharacterBase>* CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
-				if (CharacterActual && *CharacterActual)
+				TSharedPtr<FBCharacterBase> CharacterActual = GameSimHoldOpen->CharacterToJoltMapping->Find(Target->KeyIntoBarrage);
+				if (CharacterActual)
 				{
-					JPH::Ref<JPH::CharacterVirtual> CharVirtual = CharacterActual->Get()->mCharacter;
+					JPH::Ref<JPH::CharacterVirtual> CharVirtual = CharacterActual->mCharacter;
 					return CoordinateUtils::FromJoltUnitVector(CharVirtual->GetGroundNormal());
 				}
 				return FVector3f::ZeroVector;
@@ -330,7 +326,7 @@ void FBarragePrimitive::SetCharacterGravity(FVector3d InVector, FBLet Target)
 		TSharedPtr<FWorldSimOwner> GameSimHoldOpen = GlobalBarrage->JoltGameSim;
 		if (GameSimHoldOpen && MyBARRAGEIndex < ALLOWED_THREADS_FOR_BARRAGE_PHYSICS)
 		{
-			GameSimHoldOpen->ThreadAcc[MyBARRAGEIndex].Queue->Enqueue(
+			GameSimHoldOpen->EnqueueInput(MyBARRAGEIndex,
 				FBPhysicsInput(Target->KeyIntoBarrage, 0, PhysicsInputType::SetCharacterGravity,CoordinateUtils::ToBarrageForce(InVector)));
 		}
 	}
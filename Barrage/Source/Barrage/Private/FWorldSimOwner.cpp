@@ -4,10 +4,17 @@
 #include "CoordinateUtils.h"
 #include "PhysicsCharacter.h"
 #include "CastShapeCollectors/SphereCastCollector.h"
-#include "CastShapeCollectors/SphereSearchCollector.h"
+#include "CastShapeCollectors/BoundedBodyCollector.h"
+#include "CastShapeCollectors/SphereSearchSpanCollector.h"
 #include "CollisionDetectionFilters/FirstHitRayCastCollector.h"
 
 using namespace JOLT;
+
+//jolt's factory and type registry are process-wide, but a scratch world (the benchmarks, mostly) can be alive next to
+//the real one. the first world in sets them up and the last one out tears them down.
+static FCriticalSection JoltTypesLock;
+static int32 JoltTypesUsers = 0;
+
 //it's going to be quite tempting to make that initexit a const or a reference. don't.
 // ReSharper disable once CppPassValueParameterByConstReference
 FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadInitializer)
@@ -15,11 +22,24 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		DeltaTime = cDeltaTime;
 
 		BarrageToJoltMapping = MakeShareable(new KeyToBody());
-		BoxCache = MakeShareable(new BoundsToShape());
-		CharacterToJoltMapping = MakeShareable(new TMap<FBarrageKey, TSharedPtr<FBCharacterBase>>());
+		PrimitiveShapeCache = MakeShareable(new FBPrimitiveShapeCache());
+		MeshShapeCache = MakeShareable(new FBMeshShapeCache());
+		CharacterToJoltMapping = MakeShareable(new FBCharacterRegistry());
 		// Register allocation hook. In this example we'll just let Jolt use malloc / free but you can override these if you want (see Memory.h).
 		// This needs to be done before any other Jolt function is called.
-		RegisterDefaultAllocator();
+		{
+			FScopeLock TypesLock(&JoltTypesLock);
+			if (JoltTypesUsers++ == 0)
+			{
+				RegisterDefaultAllocator();
+				// Create a factory, this class is responsible for creating instances of classes based on their name or hash and is mainly used for deserialization of saved data.
+				Factory::sInstance = new Factory();
+				// Register all physics types with the factory and install their collision handlers with the CollisionDispatch class.
+				// If you have your own custom shape types you probably need to register their handlers with the CollisionDispatch before calling this function.
+				// If you implement your own default material (PhysicsMaterial::sDefault) make sure to initialize it before this function or else this function will create one for you.
+				RegisterTypes();
+			}
+		}
 		contact_listener = MakeShareable(new BarrageContactListener());
 		Allocator = MakeShareable(new TempAllocatorImpl(AllocationArenaSize));
 		physics_system = MakeShareable(new PhysicsSystem());
@@ -27,15 +47,6 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		Trace = TraceImpl;
 		JPH_IF_ENABLE_ASSERTS(AssertFailed = AssertFailedImpl;)
 
-		// Create a factory, this class is responsible for creating instances of classes based on their name or hash and is mainly used for deserialization of saved data.
-		// It is not directly used in this example but still required.
-		Factory::sInstance = new Factory();
-
-		// Register all physics types with the factory and install their collision handlers with the CollisionDispatch class.
-		// If you have your own custom shape types you probably need to register their handlers with the CollisionDispatch before calling this function.
-		// If you implement your own default material (PhysicsMaterial::sDefault) make sure to initialize it before this function or else this function will create one for you.
-		RegisterTypes();
-
 		// We need a job system that will execute physics jobs on multiple threads. Typically
 		// you would implement the JobSystem interface yourself and let Jolt Physics run on top
 		// of your own job scheduler. JobSystemThreadPool is an example implementation.
@@ -142,18 +153,32 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		// const IgnoreSingleBodyFilter default_body_filter(CastingBody);
 		// const BodyFilter &body_filter = default_body_filter;
 		
-		JPH::Vec3 JoltLocation = CoordinateUtils::ToJoltCoordinates(Location);
-		
-		SphereSearchCollector Collector(physics_system.Get()->GetBodyLockInterfaceNoLock(), BodiesFilter);
-		physics_system->GetBroadPhaseQuery().CollideSphere(JoltLocation, Radius, Collector, BroadPhaseFilter, ObjectFilter);
-
-		(*OutFoundObjectCount) = Collector.BodyCount;
-		for (uint32 FoundBodyIdx = 0; FoundBodyIdx < Collector.BodyCount; ++FoundBodyIdx)
+		TArrayView<const FBFoundBody> Found = SphereSearch(Location, Radius, BroadPhaseFilter, ObjectFilter, BodiesFilter, FBSearchParams());
+		(*OutFoundObjectCount) = Found.Num();
+		OutFoundObjectIDs.Reserve(OutFoundObjectIDs.Num() + Found.Num());
+		for (const FBFoundBody& Body : Found)
 		{
-			OutFoundObjectIDs.Add(Collector.mBodies[FoundBodyIdx]->GetID().GetIndexAndSequenceNumber());
+			OutFoundObjectIDs.Add(Body.BodyID);
 		}
 	}
 
+	inline TArrayView<const FBFoundBody> FWorldSimOwner::SphereSearch(
+		const FVector3d& Location,
+		double Radius,
+		const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+		const JPH::ObjectLayerFilter& ObjectFilter,
+		const JPH::BodyFilter& BodiesFilter,
+		const FBSearchParams& Params) const
+	{
+		JPH::Vec3 JoltLocation = CoordinateUtils::ToJoltCoordinates(Location);
+		FBQueryArena& Arena = FBQueryArena::ForThisThread();
+		BoundedBodyCollector Collector(physics_system.Get()->GetBodyLockInterfaceNoLock(), BodiesFilter, JoltLocation, Params,
+		                               Arena.Found, FBQueryArena::Capacity);
+		physics_system->GetBroadPhaseQuery().CollideSphere(JoltLocation, Radius, Collector, BroadPhaseFilter, ObjectFilter);
+		Collector.Finish();
+		return TArrayView<const FBFoundBody>(Arena.Found, Collector.BodyCount);
+	}
+
 	inline void FWorldSimOwner::CastRay(FVector3d CastFrom, FVector3d Direction, const BroadPhaseLayerFilter& BroadPhaseFilter, const ObjectLayerFilter& ObjectFilter, const BodyFilter& BodiesFilter, TSharedPtr<FHitResult> OutHit) const
 	{
 		check(OutHit.IsValid());
@@ -185,6 +210,134 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		}
 	}
 
+	//same work as the single queries above, minus the shared hit result and the per-call collector storage.
+	//these can run off the busy worker, so they go through the locking body interface, and hold the broadphase still
+	//for the whole batch so that no two queries in it see different steps.
+	void FWorldSimOwner::RunQueryBatch(FBQueryBatch& Batch) const
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Query Batch");
+		TSharedPtr<PhysicsSystem> PhysicsHoldOpen = physics_system;
+		TSharedPtr<KeyToBody> HoldOpenBodies = BarrageToJoltMapping;
+		const int32 Count = Batch.Queries.Num();
+		Batch.Results.Reset(Count);
+		Batch.Results.SetNum(Count);
+		if (!PhysicsHoldOpen || !HoldOpenBodies)
+		{
+			return;
+		}
+
+		//hand out found-buffer windows up front, so the searches themselves never touch shared state.
+		int32 FoundSlots = 0;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			if (Batch.Queries[i].Type == EBQueryType::SphereSearch)
+			{
+				Batch.Results[i].FoundStart = FoundSlots;
+				FoundSlots += Batch.MaxFoundPerSearch;
+			}
+		}
+		Batch.Found.SetNumUninitialized(FoundSlots, EAllowShrinking::No);
+
+		//taken here, on the caller, and held until every job is done, so the whole batch sees one step. the jobs never
+		//block on it themselves: they run on jolt's workers, and a step holding the write side needs those back.
+		FReadScopeLock BroadPhaseRead(BroadPhaseLock);
+		const BodyLockInterface& Locking = PhysicsHoldOpen->GetBodyLockInterface();
+		//into jolt space all at once up front, and hit positions back out all at once after.
+		TArray<Vec3>& JoltFroms = Batch.JoltFroms;
+		TArray<Vec3>& JoltDirections = Batch.JoltDirections;
+		TArray<Vec3>& JoltHits = Batch.JoltHits;
+		JoltFroms.SetNumUninitialized(Count, EAllowShrinking::No);
+		JoltDirections.SetNumUninitialized(Count, EAllowShrinking::No);
+		JoltHits.SetNumUninitialized(Count, EAllowShrinking::No);
+		for (Vec3& Hit : JoltHits)
+		{
+			Hit = Vec3::sZero();
+		}
+		CoordinateUtils::ToJoltCoordinates<FBQuery>(Batch.Queries, &FBQuery::From, JoltFroms);
+		CoordinateUtils::ToJoltCoordinates<FBQuery>(Batch.Queries, &FBQuery::Direction, JoltDirections);
+		ForEachBatched("Query Batch", Count, MinQueriesPerJob, [&](int32 Start, int32 End)
+		{
+			for (int32 i = Start; i < End; ++i)
+			{
+				const FBQuery& Query = Batch.Queries[i];
+				FBQueryResult& Result = Batch.Results[i];
+				if (Query.From.ContainsNaN() || Query.Direction.ContainsNaN())
+				{
+					continue;
+				}
+
+				BodyID Ignored;
+				if (Query.IgnoreBody.KeyIntoBarrage != 0)
+				{
+					HoldOpenBodies->find(Query.IgnoreBody, Ignored);
+				}
+				const DefaultBroadPhaseLayerFilter BroadPhaseFilter = PhysicsHoldOpen->GetDefaultBroadPhaseLayerFilter(Query.QueryLayer);
+				const DefaultObjectLayerFilter ObjectFilter = PhysicsHoldOpen->GetDefaultLayerFilter(Query.QueryLayer);
+				const IgnoreSingleBodyFilter BodiesFilter(Ignored);
+				const Vec3 JoltFrom = JoltFroms[i];
+
+				switch (Query.Type)
+				{
+				case EBQueryType::SphereCast:
+					{
+						ShapeCastSettings settings;
+						settings.mUseShrunkenShapeAndConvexRadius = true;
+						settings.mReturnDeepestPoint = true;
+						SphereShape sphere(Query.Radius);
+						//it lives on the stack, so keep jolt's refcounting from ever trying to free it.
+						sphere.SetEmbedded();
+						RShapeCast ShapeCast(&sphere, Vec3::sReplicate(1.0f), RMat44::sTranslation(JoltFrom),
+						                     JoltDirections[i] * Query.Distance);
+						SphereCastCollector CastCollector(*PhysicsHoldOpen, ShapeCast);
+						PhysicsHoldOpen->GetNarrowPhaseQuery().CastShape(ShapeCast, settings, ShapeCast.mCenterOfMassStart.GetTranslation(),
+						                                                 CastCollector, BroadPhaseFilter, ObjectFilter, BodiesFilter);
+						if (CastCollector.mBody)
+						{
+							Result.bHit = true;
+							Result.BodyID = CastCollector.mBody->GetID().GetIndexAndSequenceNumber();
+							JoltHits[i] = CastCollector.mContactPosition;
+							Result.Normal = CoordinateUtils::FromJoltUnitVector(CastCollector.mContactNormal);
+						}
+						break;
+					}
+				case EBQueryType::SphereSearch:
+					{
+						SphereSearchSpanCollector Collector(Locking, BodiesFilter, Batch.Found.GetData() + Result.FoundStart, Batch.MaxFoundPerSearch);
+						PhysicsHoldOpen->GetBroadPhaseQuery().CollideSphere(JoltFrom, Query.Radius, Collector, BroadPhaseFilter, ObjectFilter);
+						Result.FoundCount = Collector.BodyCount;
+						Result.bHit = Collector.BodyCount > 0;
+						break;
+					}
+				case EBQueryType::Ray:
+					{
+						RRayCast Ray(JoltFrom, JoltDirections[i]);
+						RayCastResult CastResult;
+						FirstHitRayCastCollector FirstHitCollector(Ray, CastResult, Locking, BodiesFilter);
+						PhysicsHoldOpen->GetBroadPhaseQuery().CastRay(RayCast(Ray), FirstHitCollector, BroadPhaseFilter, ObjectFilter);
+						if (FirstHitCollector.mHit.mBodyID != BodyID())
+						{
+							Result.bHit = true;
+							Result.BodyID = FirstHitCollector.mHit.mBodyID.GetIndexAndSequenceNumber();
+							JoltHits[i] = FirstHitCollector.mContactPosition;
+						}
+						break;
+					}
+				}
+			}
+		});
+
+		//misses and sphere searches carry a zero hit, which comes back out as the zero location they had anyway.
+		CoordinateUtils::FromJoltCoordinates<FBQueryResult>(JoltHits, Batch.Results, &FBQueryResult::Location);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			FBQueryResult& Result = Batch.Results[i];
+			if (Result.bHit && Batch.Queries[i].Type != EBQueryType::SphereSearch)
+			{
+				Result.Distance = (Result.Location - FVector3f(Batch.Queries[i].From)).Length();
+			}
+		}
+	}
+
 	inline EMotionType LayerToMotionTypeMapping(uint16 Layer)
 	{
 		switch (Layer)
@@ -245,39 +398,10 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		}
 	}
 
-	inline Ref<Shape> FWorldSimOwner::AttemptBoxCache(double JoltX, double JoltY, double JoltZ, float HEReduceMin)
-	{
-		auto Bounds = Vec3(JoltX, JoltY, JoltZ);
-		void* At = &Bounds;
-		auto BoundsHash = HashBytes(At,sizeof(Bounds));
-		if (!BoxCache->contains(BoundsHash))
-		{
-			Ref<Shape> NewShape = new BoxShape(Vec3(JoltX, JoltY, JoltZ), FMath::Min(HEReduceMin / 2.f, 0.01));
-			BoxCache->insert_or_assign(BoundsHash, NewShape);
-			return NewShape;
-		}
-		else
-		{
-			Ref<Shape> Result;
-			bool Success =  BoxCache->find(BoundsHash, Result);
-			if (Success)
-			{
-				return Result;
-			}
-			else
-			{
-				Ref<Shape> NewShape = new BoxShape(Vec3(JoltX, JoltY, JoltZ), FMath::Min(HEReduceMin / 2.f, 0.01));
-				BoxCache->insert_or_assign(BoundsHash, NewShape);
-				return NewShape;
-			}
-		}
-	}
-
 	//we need the coordinate utils, but we don't really want to include them in the .h
-	inline FBarrageKey FWorldSimOwner::CreatePrimitive(FBBoxParams& ToCreate, uint16 Layer, bool IsSensor, bool forceDynamic)
+	//settings are split out from creation so that single and batched creation can't drift apart.
+	BodyCreationSettings FWorldSimOwner::MakeBodySettings(FBBoxParams& ToCreate, uint16 Layer, bool IsSensor, bool forceDynamic)
 	{
-
-		BodyID BodyIDTemp = BodyID();
 		EMotionType MovementType = forceDynamic ? EMotionType::Dynamic : LayerToMotionTypeMapping(Layer);
 		EMotionQuality MotionQuality = LayerToMotionQualityMapping(Layer);
 
@@ -287,12 +411,9 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		{
 			HEReduceMin = 0.01;
 		}
-		//not really sure how much our cache helps us, but it could in theory improve GJK perf? Removed for perf testing.
-		//Ref<Shape> CachedShape = AttemptBoxCache(ToCreate.JoltX, ToCreate.JoltY, ToCreate.JoltZ, FMath::Min(HEReduceMin / 2.f, 0.01));
-		Ref<Shape> NewShape = new BoxShape(Vec3(ToCreate.JoltX, ToCreate.JoltY, ToCreate.JoltZ), FMath::Min(HEReduceMin / 2.f, 0.02));
-		ShapeSettings::ShapeResult box = RotatedTranslatedShapeSettings(
-			 	 CoordinateUtils::ToJoltCoordinates(ToCreate.Offset.X, ToCreate.Offset.Y, ToCreate.Offset.Z), Quat::sIdentity(), NewShape).Create();
-		ShapeRefC box_shape = box.Get();
+		//identical boxes (every projectile of a kind, mostly) share one shape.
+		ShapeRefC box_shape = PrimitiveShapeCache->FindOrCreateBox(HalfExtent, FMath::Min(HEReduceMin / 2.f, 0.02f),
+			CoordinateUtils::ToJoltCoordinates(ToCreate.Offset.X, ToCreate.Offset.Y, ToCreate.Offset.Z));
 
 		// We don't expect an error here, but you can check floor_shape_result for HasError() / GetError()
 		// Create the settings for the body itself. Note that here you can also set other properties like the restitution / friction.
@@ -312,6 +433,41 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		{
 			box_body_settings.mCollideKinematicVsNonDynamic = true;
 		}
+		return box_body_settings;
+	}
+
+	BodyCreationSettings FWorldSimOwner::MakeBodySettings(FBSphereParams& ToCreate, uint16 Layer, bool IsSensor)
+	{
+		EMotionType MovementType = LayerToMotionTypeMapping(Layer);
+
+		BodyCreationSettings sphere_settings(PrimitiveShapeCache->FindOrCreateSphere(ToCreate.JoltRadius),
+		                                     CoordinateUtils::ToJoltCoordinates(ToCreate.point.GridSnap(1)),
+		                                     Quat::sIdentity(),
+		                                     MovementType,
+		                                     Layer);
+		sphere_settings.mIsSensor = IsSensor;
+		return sphere_settings;
+	}
+
+	BodyCreationSettings FWorldSimOwner::MakeBodySettings(FBCapParams& ToCreate, uint16 Layer, bool IsSensor, FMassByCategory::BMassCategories MassClass)
+	{
+		EMotionType MovementType = LayerToMotionTypeMapping(Layer);
+		BodyCreationSettings cap_settings(PrimitiveShapeCache->FindOrCreateCapsule(ToCreate.JoltHalfHeightOfCylinder, ToCreate.JoltRadius),
+		                                  CoordinateUtils::ToJoltCoordinates(ToCreate.point.GridSnap(1)),
+		                                  Quat::sIdentity(),
+		                                  MovementType,
+		                                  Layer);
+		JPH::MassProperties msp;
+		msp.ScaleToMass(MassClass); //actual mass in kg
+		cap_settings.mMassPropertiesOverride = msp;
+		cap_settings.mOverrideMassProperties = JPH::EOverrideMassProperties::CalculateInertia;
+		cap_settings.mIsSensor = IsSensor;
+		return cap_settings;
+	}
+
+	inline FBarrageKey FWorldSimOwner::CreatePrimitive(FBBoxParams& ToCreate, uint16 Layer, bool IsSensor, bool forceDynamic)
+	{
+		BodyCreationSettings box_body_settings = MakeBodySettings(ToCreate, Layer, IsSensor, forceDynamic);
 		
 		// Create the actual rigid body
 		Body* box_body = body_interface->CreateBody(box_body_settings);
@@ -319,7 +475,8 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 
 		// Add it to the world
 		body_interface->AddBody(box_body->GetID(), EActivation::Activate);
-		BodyIDTemp = box_body->GetID();
+		BroadphaseMaintenance.NoteAdded();
+		BodyID BodyIDTemp = box_body->GetID();
 		auto FBK = GenerateBarrageKeyFromBodyId(BodyIDTemp);
 		//Barrage key is unique to WORLD and BODY. This is crushingly important.
 		BarrageToJoltMapping->insert(FBK, BodyIDTemp);
@@ -328,7 +485,8 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 	}
 
 	//we need the coordinate utils, but we don't really want to include them in the .h
-	inline FBarrageKey FWorldSimOwner::CreatePrimitive(FBCharParams& ToCreate, uint16 Layer)
+	//not inline, since the benchmarks spawn their characters through it from another translation unit.
+	FBarrageKey FWorldSimOwner::CreatePrimitive(FBCharParams& ToCreate, uint16 Layer, FSkeletonKey OutKey)
 	{
 
 		BodyID BodyIDTemp = BodyID();
@@ -345,29 +503,32 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		NewCharacter->World = this->physics_system;
 		NewCharacter->mDeltaTime = DeltaTime;
 		NewCharacter->mForcesUpdate = Vec3::sZero();
+		NewCharacter->OutKey = OutKey;
 		// Create the shape
-		BodyIDTemp = NewCharacter->Create(&this->CharacterVsCharacterCollisionSimple);
-		//Barrage key is unique to WORLD and BODY. This is crushingly important.
-		auto FBK = GenerateBarrageKeyFromBodyId(BodyIDTemp);
+		BodyIDTemp = NewCharacter->Create(&this->CharacterVsCharacterCollision);
+		//characters have no inner body, so every one of them comes back with the invalid body id. they get their own key.
+		auto FBK = GenerateCharacterKey();
+		//the invalid body is deliberate. it's how FBarragePrimitive tells a character that exists from one that doesn't.
 		BarrageToJoltMapping->insert(FBK, BodyIDTemp);
-		CharacterToJoltMapping->Add(FBK, NewCharacter);
+		if (CharacterToJoltMapping->Add(FBK, NewCharacter) == FBCharacterRegistry::InvalidIndex)
+		{
+			//into the grid only once it's registered. a character the grid has seen can't be let go of until a rebuild.
+			UE_LOG(LogTemp, Error, TEXT("Barrage:CreatePrimitive: could not register character %llu."), FBK.KeyIntoBarrage);
+			BarrageToJoltMapping->erase(FBK);
+			return FBarrageKey();
+		}
+		if (NewCharacter->mCharacter)
+		{
+			CharacterVsCharacterCollision.Add(NewCharacter->mCharacter);
+		}
 
 		return FBK;
 	}
 
 	inline FBarrageKey FWorldSimOwner::CreatePrimitive(FBSphereParams& ToCreate, uint16 Layer, bool IsSensor)
 	{
-
-		BodyID BodyIDTemp = BodyID();
-		EMotionType MovementType = LayerToMotionTypeMapping(Layer);
-
-		BodyCreationSettings sphere_settings(new SphereShape(ToCreate.JoltRadius),
-		                                     CoordinateUtils::ToJoltCoordinates(ToCreate.point.GridSnap(1)),
-		                                     Quat::sIdentity(),
-		                                     MovementType,
-		                                     Layer);
-		sphere_settings.mIsSensor = IsSensor;
-		BodyIDTemp = body_interface->CreateAndAddBody(sphere_settings, EActivation::Activate);
+		BodyID BodyIDTemp = body_interface->CreateAndAddBody(MakeBodySettings(ToCreate, Layer, IsSensor), EActivation::Activate);
+		BroadphaseMaintenance.NoteAdded();
 
 		auto FBK = GenerateBarrageKeyFromBodyId(BodyIDTemp);
 		//Barrage key is unique to WORLD and BODY. This is crushingly important.
@@ -377,25 +538,59 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 
 	inline FBarrageKey FWorldSimOwner::CreatePrimitive(FBCapParams& ToCreate, uint16 Layer, bool IsSensor, FMassByCategory::BMassCategories MassClass)
 	{
-		BodyID BodyIDTemp = BodyID();
-		EMotionType MovementType = LayerToMotionTypeMapping(Layer);
-		BodyCreationSettings cap_settings(new CapsuleShape(ToCreate.JoltHalfHeightOfCylinder, ToCreate.JoltRadius),
-		                                  CoordinateUtils::ToJoltCoordinates(ToCreate.point.GridSnap(1)),
-		                                  Quat::sIdentity(),
-		                                  MovementType,
-		                                  Layer);
-		JPH::MassProperties msp;
-		msp.ScaleToMass(MassClass); //actual mass in kg
-		cap_settings.mMassPropertiesOverride = msp;
-		cap_settings.mOverrideMassProperties = JPH::EOverrideMassProperties::CalculateInertia;
-		cap_settings.mIsSensor = IsSensor;
-		BodyIDTemp = body_interface->CreateAndAddBody(cap_settings, EActivation::Activate);
+		BodyID BodyIDTemp = body_interface->CreateAndAddBody(MakeBodySettings(ToCreate, Layer, IsSensor, MassClass), EActivation::Activate);
+		BroadphaseMaintenance.NoteAdded();
 		auto FBK = GenerateBarrageKeyFromBodyId(BodyIDTemp);
 		//Barrage key is unique to WORLD and BODY. This is crushingly important.
 		BarrageToJoltMapping->insert(FBK, BodyIDTemp);
 		return FBK;
 	}
 
+	//AddBody on its own inserts into the broadphase tree one node at a time. AddBodiesPrepare builds a subtree for the
+	//whole batch off to the side, and finalize splices it in under a single lock. This is what Jolt recommends for waves.
+	void FWorldSimOwner::CreateAndAddBodies(const TArray<BodyCreationSettings>& Settings, TArray<FBarrageKey>& OutKeys)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Create Bodies Batched");
+		OutKeys.Reset(Settings.Num());
+		TArray<BodyID> InOrder;
+		InOrder.Reserve(Settings.Num());
+		TArray<BodyID> ToAdd;
+		ToAdd.Reserve(Settings.Num());
+		for (const BodyCreationSettings& Setting : Settings)
+		{
+			// Note that if we run out of bodies this can return nullptr
+			Body* NewBody = body_interface->CreateBody(Setting);
+			//keep the output index-aligned with the input. an invalid ID here becomes the invalid barrage key (0) below.
+			InOrder.Add(NewBody ? NewBody->GetID() : BodyID());
+			if (NewBody)
+			{
+				ToAdd.Add(NewBody->GetID());
+			}
+		}
+
+		if (ToAdd.Num() > 0)
+		{
+			//prepare shuffles the array it's given, which is why we keep InOrder separately.
+			BodyInterface::AddState AddState = body_interface->AddBodiesPrepare(ToAdd.GetData(), ToAdd.Num());
+			FWriteScopeLock BroadPhaseWrite(BroadPhaseLock);
+			body_interface->AddBodiesFinalize(ToAdd.GetData(), ToAdd.Num(), AddState, EActivation::Activate);
+			BroadphaseMaintenance.NoteAdded(ToAdd.Num());
+		}
+
+		for (const BodyID& Added : InOrder)
+		{
+			if (Added.IsInvalid())
+			{
+				OutKeys.Add(FBarrageKey());
+				continue;
+			}
+			auto FBK = GenerateBarrageKeyFromBodyId(Added);
+			//Barrage key is unique to WORLD and BODY. This is crushingly important.
+			BarrageToJoltMapping->insert(FBK, Added);
+			OutKeys.Add(FBK);
+		}
+	}
+
 	FBLet FWorldSimOwner::LoadComplexStaticMesh(FBTransform& MeshTransform,
 	                                            const UStaticMeshComponent* StaticMeshComponent,
 	                                            FSkeletonKey Outkey)
@@ -440,71 +635,24 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 				return nullptr;
 			}
 
-			//Here we go!
-			auto& MeshSet = collbody->TriMeshGeometries;
-			JPH::VertexList JoltVerts;
-			JPH::IndexedTriangleList JoltIndexedTriangles;
-			uint32 tris = 0;
-			for (auto& Mesh : MeshSet)
-			{
-				tris += Mesh->Elements().GetNumTriangles();
-			}
-			JoltVerts.reserve(tris);
-			JoltIndexedTriangles.reserve(tris);
-			for (auto& Mesh : MeshSet)
-			{
-				//indexed triangles are made by collecting the vertexes, then generating triples describing the triangles.
-				//this allows the heavier vertices to be stored only once, rather than each time they are used. for large models
-				//like terrain, this can be extremely significant. though, it's not truly clear to me if it's worth it.
-				auto& VertToTriBuffers = Mesh->Elements();
-				auto& Verts = Mesh->Particles().X();
-				if (VertToTriBuffers.RequiresLargeIndices())
-				{
-					for (auto& aTri : VertToTriBuffers.GetLargeIndexBuffer())
-					{
-						JoltIndexedTriangles.push_back(IndexedTriangle(aTri[2], aTri[1], aTri[0]));
-					}
-				}
-				else
-				{
-					for (auto& aTri : VertToTriBuffers.GetSmallIndexBuffer())
-					{
-						JoltIndexedTriangles.push_back(IndexedTriangle(aTri[2], aTri[1], aTri[0]));
-					}
-				}
-
-				for (auto& vtx : Verts)
-				{
-					//need to figure out how to defactor this without breaking typehiding or having to create a bunch of util.h files.
-					//though, tbh, the util.h is the play. TODO: util.h ?
-					JoltVerts.push_back(CoordinateUtils::ToJoltCoordinates(vtx));
-				}
-			}
-			JPH::MeshShapeSettings FullMesh(JoltVerts, JoltIndexedTriangles);
-			//just the last boiler plate for now.
-			JPH::ShapeSettings::ShapeResult err = FullMesh.Create();
-			if (err.HasError())
+			//every instance of a mesh at a given scale shares one cooked shape. only the placement below is per instance.
+			TSharedPtr<FBMeshShapeCache> HoldOpenCache = MeshShapeCache;
+			ShapeRefC SharedShape = HoldOpenCache ? HoldOpenCache->FindOrCook(CollisionMesh, MeshTransform.GetScaleJoltArg()) : nullptr;
+			if (!SharedShape)
 			{
 				return nullptr;
 			}
-			//TODO: should we be holding the shape ref in gamesim owner?
-			auto& shape = err.Get();
 			BodyCreationSettings creation_settings;
 			creation_settings.mMotionType = EMotionType::Static;
 			creation_settings.mObjectLayer = Layers::NON_MOVING;
 			creation_settings.mFriction = 0.5f;
 			creation_settings.mRestitution = 0;
 			creation_settings.mUseManifoldReduction = true;
-			
-			Shape::ShapeResult result = shape->ScaleShape(MeshTransform.GetScaleJoltArg());
-			if (result.HasError() || result.IsEmpty())
-			{
-				throw;
-			}
 
-			Ref<Shape> OriginAndRotationApplied = new RotatedTranslatedShape(CoordinateUtils::ToJoltCoordinates(MeshTransform.GetLocation()), CoordinateUtils::ToJoltRotation(MeshTransform.GetRotationQuat()),  result.Get());
+			Ref<Shape> OriginAndRotationApplied = new RotatedTranslatedShape(CoordinateUtils::ToJoltCoordinates(MeshTransform.GetLocation()), CoordinateUtils::ToJoltRotation(MeshTransform.GetRotationQuat()), SharedShape);
 			creation_settings.SetShape(OriginAndRotationApplied);
 			BodyID bID = body_interface->CreateAndAddBody(creation_settings, EActivation::Activate);
+			BroadphaseMaintenance.NoteAdded();
 			FBarrageKey FBK = GenerateBarrageKeyFromBodyId(bID);
 			BarrageToJoltMapping->insert(FBK, bID);
 			FBLet shared = MakeShareable(new FBarragePrimitive(FBK, Outkey));
@@ -526,10 +674,209 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		if (AllocHoldOpen && JobHoldOpen)
 		{
 			TRACE_CPUPROFILER_EVENT_SCOPE_STR("Physics Update");
+			FWriteScopeLock BroadPhaseWrite(BroadPhaseLock);
 			PhysicsHoldOpen->Update(DeltaTime, cCollisionSteps, AllocHoldOpen.Get(), JobHoldOpen.Get());
 		}
 	}
 
+
+	//any thread, so long as nothing else is stepping this character. touches nothing but the character.
+	static void StepOneCharacter(FBCharacterBase& Character)
+	{
+		Character.DeferredPushes.Reset();
+		Character.DeferredGroundBody = BodyID();
+		if (!Character.mCharacter)
+		{
+			return;
+		}
+		if (Character.mCharacter->GetPosition().IsNaN())
+		{
+			Character.mCharacter->SetLinearVelocity(Character.World->GetGravity());
+			Character.mCharacter->SetPosition(Character.mInitialPosition);
+			Character.mForcesUpdate = Character.World->GetGravity();
+		}
+		Character.StepCharacter();
+
+		//jolt's own ground push, from the end of CharacterVirtual::Update. the character's jolt mass is zeroed so it
+		//doesn't do this itself, so the real mass comes from the settings it was made with.
+		const CharacterVirtual& Stepped = *Character.mCharacter;
+		const float Mass = Character.mCharacterSettings.mMass;
+		const float NormalDotGravity = Stepped.GetGroundNormal().Dot(Character.mGravity);
+		if (!Stepped.GetGroundBodyID().IsInvalid() && Mass > 0.0f && NormalDotGravity < 0.0f)
+		{
+			Character.DeferredGroundBody = Stepped.GetGroundBodyID();
+			Character.DeferredGroundPosition = Stepped.GetGroundPosition();
+			Character.DeferredGroundImpulse = -(Mass * NormalDotGravity / Character.mGravity.Length() * Character.mDeltaTime) * Character.mGravity;
+		}
+	}
+
+	//what CharacterVirtual::HandleContact would have done to each body the step touched, against the body as it is now.
+	//the one difference is the penetration term, since the listener never hears how deep a contact was.
+	//busy worker only, one character at a time.
+	static void ApplyDeferredPushes(FBCharacterBase& Character, PhysicsSystem& System)
+	{
+		if (!Character.mCharacter)
+		{
+			return;
+		}
+		const CharacterVirtual& Pusher = *Character.mCharacter;
+		const Vec3 Up = Pusher.GetUp();
+		const float MaxImpulse = Pusher.GetMaxStrength() * Character.mDeltaTime;
+		for (const FBCharacterBase::FDeferredPush& Push : Character.DeferredPushes)
+		{
+			BodyLockWrite Lock(System.GetBodyLockInterface(), Push.Body);
+			if (!Lock.SucceededAndIsInBroadPhase() || !Lock.GetBody().IsDynamic() || Lock.GetBody().IsSensor())
+			{
+				continue;
+			}
+			const Body& Pushed = Lock.GetBody();
+			constexpr float Damping = 0.9f;
+			//jolt's contact normal points the other way, which flips the sign here and on the impulse.
+			const float DeltaVelocity = (Push.CharacterVelocity - Pushed.GetPointVelocity(Push.Position)).Dot(Push.Normal) * Damping;
+			if (DeltaVelocity < 0.0f)
+			{
+				continue;
+			}
+			const Vec3 Jacobian = Vec3(Push.Position - Pushed.GetCenterOfMassPosition()).Cross(Push.Normal);
+			const float InverseEffectiveMass = Pushed.GetInverseInertia().Multiply3x3(Jacobian).Dot(Jacobian)
+				+ Pushed.GetMotionProperties()->GetInverseMass();
+			Vec3 Impulse = FMath::Min(DeltaVelocity / InverseEffectiveMass, MaxImpulse) * Push.Normal;
+			//gravity does the pushing down.
+			const float ImpulseDotUp = Impulse.Dot(Up);
+			if (ImpulseDotUp < 0.0f)
+			{
+				Impulse -= ImpulseDotUp * Up;
+			}
+			System.GetBodyInterfaceNoLock().AddImpulse(Push.Body, Impulse, Push.Position);
+		}
+		if (!Character.DeferredGroundBody.IsInvalid())
+		{
+			System.GetBodyInterface().AddImpulse(Character.DeferredGroundBody, Character.DeferredGroundImpulse, Character.DeferredGroundPosition);
+		}
+	}
+
+	//characters spawned without a skeleton key (the benchmarks, mostly) fall back to their barrage key, which is at
+	//least stable for a given spawn order.
+	static void SnapshotInKeyOrder(const FBCharacterRegistry& Characters, TArray<FBCharacterEntry>& Out)
+	{
+		Characters.Snapshot(Out);
+		Out.Sort([](const FBCharacterEntry& A, const FBCharacterEntry& B)
+		{
+			return A.Value->OutKey.Obj != B.Value->OutKey.Obj
+				? A.Value->OutKey.Obj < B.Value->OutKey.Obj
+				: A.Key.KeyIntoBarrage < B.Key.KeyIntoBarrage;
+		});
+	}
+
+	//every step reads only itself, bodies nothing's moving, and the frozen copies the grid just made, so they can run
+	//on any thread in any order. what they'd push on waits for the serial pass after, in skeleton key order.
+	const TArray<FBCharacterEntry>& FWorldSimOwner::StepCharacters(int32 MinPerJob)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Step Characters");
+		CharacterStepScratch.Reset();
+		auto HoldOpenCharacters = CharacterToJoltMapping;
+		if (!HoldOpenCharacters)
+		{
+			return CharacterStepScratch;
+		}
+		//anything removed before this point is out of the grid once it rebuilds, so it's safe to let go of after.
+		HoldOpenCharacters->BeginReclaim();
+		CharacterVsCharacterCollision.Rebuild();
+		HoldOpenCharacters->FinishReclaim();
+		SnapshotInKeyOrder(*HoldOpenCharacters, CharacterStepScratch);
+
+		ForEachBatched("Step Characters", CharacterStepScratch.Num(), MinPerJob, [this](int32 Start, int32 End)
+		{
+			for (int32 Index = Start; Index < End; ++Index)
+			{
+				StepOneCharacter(*CharacterStepScratch[Index].Value);
+			}
+		});
+
+		TSharedPtr<PhysicsSystem> HoldOpenSystem = physics_system;
+		for (const FBCharacterEntry& Entry : CharacterStepScratch)
+		{
+			ApplyDeferredPushes(*Entry.Value, *HoldOpenSystem);
+		}
+		return CharacterStepScratch;
+	}
+	
+	//jolt's part first, then the characters in key order, each with its own and its character virtual's state.
+	FBRollbackRing::FSlot* FWorldSimOwner::SaveTick(const FBRollbackTick& Stepped)
+	{
+		FBRollbackRing::FSlot* Slot = Rollback.Open(Stepped);
+		TSharedPtr<PhysicsSystem> HoldOpenSystem = physics_system;
+		TSharedPtr<FBCharacterRegistry> HoldOpenCharacters = CharacterToJoltMapping;
+		if (!Slot || !HoldOpenSystem || !HoldOpenCharacters)
+		{
+			return Slot;
+		}
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Save Rollback Tick");
+		//read before the save, so a body that shows up partway through still counts as having come since.
+		Slot->BodiesAddedOrRemoved = BroadphaseMaintenance.GetBodiesAddedOrRemoved();
+		FBStateStream Stream(Slot->State);
+		HoldOpenSystem->SaveState(Stream);
+		SnapshotInKeyOrder(*HoldOpenCharacters, RollbackCharacterScratch);
+		Slot->Characters.Reset();
+		for (const FBCharacterEntry& Entry : RollbackCharacterScratch)
+		{
+			Slot->Characters.Add(Entry.Key.KeyIntoBarrage);
+			Entry.Value->SaveState(Stream);
+		}
+		return Slot;
+	}
+
+	bool FWorldSimOwner::RestoreTick(uint64 Tick, TArray<FBRollbackTick>& OutReplay)
+	{
+		OutReplay.Reset();
+		FBRollbackRing::FSlot* Slot = Rollback.Find(Tick);
+		TSharedPtr<PhysicsSystem> HoldOpenSystem = physics_system;
+		TSharedPtr<FBCharacterRegistry> HoldOpenCharacters = CharacterToJoltMapping;
+		if (!Slot || !HoldOpenSystem || !HoldOpenCharacters
+			|| Slot->BodiesAddedOrRemoved != BroadphaseMaintenance.GetBodiesAddedOrRemoved())
+		{
+			return false;
+		}
+		SnapshotInKeyOrder(*HoldOpenCharacters, RollbackCharacterScratch);
+		if (RollbackCharacterScratch.Num() != Slot->Characters.Num())
+		{
+			return false;
+		}
+		for (int32 Index = 0; Index < RollbackCharacterScratch.Num(); ++Index)
+		{
+			if (RollbackCharacterScratch[Index].Key.KeyIntoBarrage != Slot->Characters[Index])
+			{
+				return false;
+			}
+		}
+
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Restore Rollback Tick");
+		//anything moving now might be asleep by the time the replay's done, and then export would never send it back.
+		HoldOpenSystem->GetActiveBodies(EBodyType::RigidBody, ActiveBodiesScratch);
+		for (const BodyID& Active : ActiveBodiesScratch)
+		{
+			MarkBodyChanged(Active);
+		}
+		FBStateStream Stream(Slot->State);
+		{
+			FWriteScopeLock BroadPhaseWrite(BroadPhaseLock);
+			if (!HoldOpenSystem->RestoreState(Stream))
+			{
+				UE_LOG(LogTemp, Error, TEXT("Barrage:Rollback: jolt wouldn't restore tick %llu."), Tick);
+				return false;
+			}
+		}
+		for (const FBCharacterEntry& Entry : RollbackCharacterScratch)
+		{
+			Entry.Value->RestoreState(Stream);
+		}
+		if (!Stream.ReadAll())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Barrage:Rollback: tick %llu didn't read back the way it was saved."), Tick);
+		}
+		Rollback.TicksFrom(Tick, OutReplay);
+		return true;
+	}
 	
 	bool FWorldSimOwner::OptimizeBroadPhase()
 	{
@@ -537,6 +884,7 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		// You should definitely not call this every frame or when e.g. streaming in a new level section as it is an expensive operation.
 		// Instead insert all new objects in batches instead of 1 at a time to keep the broad phase efficient.
 		auto HoldOpen = physics_system;
+		FWriteScopeLock BroadPhaseWrite(BroadPhaseLock);
 		HoldOpen->OptimizeBroadPhase();
 		return true;
 	}
@@ -554,10 +902,95 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 		return FBarrageKey(KeyCompose);
 	}
 
+	//same world half as a body's key, but with jolt's broadphase bit set in the low half, which no real body id has.
+	//the serial wraps one short of the invalid body id, so a character key is never mistaken for a body or for nothing.
+	FBarrageKey FWorldSimOwner::GenerateCharacterKey()
+	{
+		const uint32 Serial = NextCharacterSerial.fetch_add(1, std::memory_order_relaxed) % (BodyID::cBroadPhaseBit - 1);
+		uint64_t KeyCompose = PointerHash(this);
+		KeyCompose = KeyCompose << 32;
+		KeyCompose |= BodyID::cBroadPhaseBit | Serial;
+		return FBarrageKey(KeyCompose);
+	}
+
+	void FWorldSimOwner::BindSkeletonKey(FBarrageKey Key, FSkeletonKey OutKey)
+	{
+		BodyID Result;
+		if (GetBodyIDOrDefault(Key, Result) && !Result.IsInvalid())
+		{
+			body_interface->SetUserData(Result, OutKey.Obj);
+		}
+	}
+
+	//one lock per body, and we pull everything we need while we hold it. the transform goes out in jolt space and gets
+	//converted with everything else once the gather's done.
+	inline bool ExportBodyTransform(const BodyLockInterface& Locks, const BodyID& Moved, uint64 Time, bool SkipIfActive, TArray<TransformUpdate>& OutUpdates,
+	                                TArray<Vec3>& OutPositions, TArray<Quat>& OutRotations)
+	{
+		BodyLockRead Lock(Locks, Moved);
+		if (!Lock.SucceededAndIsInBroadPhase())
+		{
+			return false;
+		}
+		const Body& MovedBody = Lock.GetBody();
+		const uint64 OutKey = MovedBody.GetUserData();
+		if (OutKey == 0 || (SkipIfActive && MovedBody.IsActive()))
+		{
+			return false;
+		}
+		OutUpdates.Add(TransformUpdate(FSkeletonKey(OutKey), Time, FQuat4f::Identity, FVector3f::ZeroVector, 0));
+		OutPositions.Add(MovedBody.GetPosition());
+		OutRotations.Add(MovedBody.GetRotation());
+		return true;
+	}
+
+	uint32 FWorldSimOwner::GatherMovedBodyTransforms(uint64 Time, TArray<TransformUpdate>& OutUpdates)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_STR("Gather Moved Bodies");
+		uint32 Exported = 0;
+		//GetActiveBodiesUnsafe would skip the copy, but bodies get added and activated from the gamethread while we run.
+		//the safe version is a memcpy under jolt's active list mutex, which is cheap next to what it replaces.
+		physics_system->GetActiveBodies(EBodyType::RigidBody, ActiveBodiesScratch);
+		const BodyLockInterface& Locks = physics_system->GetBodyLockInterface();
+		const int32 FirstExported = OutUpdates.Num();
+		OutUpdates.Reserve(OutUpdates.Num() + ActiveBodiesScratch.size() + ChangedBodiesThisTick.Num());
+		ExportPositionsScratch.Reset();
+		ExportRotationsScratch.Reset();
+		for (const BodyID& Active : ActiveBodiesScratch)
+		{
+			Exported += ExportBodyTransform(Locks, Active, Time, false, OutUpdates, ExportPositionsScratch, ExportRotationsScratch);
+		}
+
+		//sorting lets us drop repeat pokes at the same body without a hash set.
+		ChangedBodiesThisTick.Sort();
+		BodyID Prior = BodyID();
+		for (const BodyID& Changed : ChangedBodiesThisTick)
+		{
+			if (Changed != Prior)
+			{
+				//anything still active was sent above. don't send it twice.
+				Exported += ExportBodyTransform(Locks, Changed, Time, true, OutUpdates, ExportPositionsScratch, ExportRotationsScratch);
+				Prior = Changed;
+			}
+		}
+		ChangedBodiesThisTick.Reset();
+
+		TArrayView<TransformUpdate> Fresh(OutUpdates.GetData() + FirstExported, OutUpdates.Num() - FirstExported);
+		CoordinateUtils::FromJoltCoordinates<TransformUpdate>(ExportPositionsScratch, Fresh, &TransformUpdate::Position);
+		CoordinateUtils::FromJoltRotations<TransformUpdate>(ExportRotationsScratch, Fresh, &TransformUpdate::Rotation);
+		return Exported;
+	}
+
 	FWorldSimOwner::~FWorldSimOwner()
 	{
-		UnregisterTypes();
-		Factory::sInstance = nullptr;
+		{
+			FScopeLock TypesLock(&JoltTypesLock);
+			if (--JoltTypesUsers == 0)
+			{
+				UnregisterTypes();
+				Factory::sInstance = nullptr;
+			}
+		}
 
 
 		//this is the canonical order.
@@ -574,13 +1007,13 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 	bool FWorldSimOwner::UpdateCharacter(FBPhysicsInput& Update)
 	{
 		auto key = Update.Target;
-		auto CharacterOuter = CharacterToJoltMapping->Find(key);
+		TSharedPtr<FBCharacterBase> CharacterOuter = CharacterToJoltMapping->Find(key);
 		//As you add handling for Characters with Inner Shapes, you'll need to use something like the line below.
 		//Unfortunately, it's going to be a lot of work. Right now, there's a bug preventing us from doing it, something in the lifecycle.
 		//auto CharacterInner = BarrageToJoltMapping->find(Update.Target.Get()->KeyIntoBarrage); 
 		if (CharacterOuter)
 		{
-			(*CharacterOuter)->IngestUpdate(Update);
+			CharacterOuter->IngestUpdate(Update);
 			return true;
 		}
 		return false;
@@ -0,0 +1,305 @@
+#include "MeshShapeCache.h"
+
+#include "CoordinateUtils.h"
+#include "Engine/StaticMesh.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PhysicsEngine/BodySetup.h"
+
+using namespace JOLT;
+
+namespace
+{
+	class FBShapeBytesOut final : public StreamOut
+	{
+	public:
+		explicit FBShapeBytesOut(TArray<uint8>& InBytes) : Bytes(InBytes)
+		{
+		}
+
+		virtual void WriteBytes(const void* inData, size_t inNumBytes) override
+		{
+			Bytes.Append(static_cast<const uint8*>(inData), inNumBytes);
+		}
+
+		virtual bool IsFailed() const override
+		{
+			return false;
+		}
+
+	private:
+		TArray<uint8>& Bytes;
+	};
+
+	class FBShapeBytesIn final : public StreamIn
+	{
+	public:
+		explicit FBShapeBytesIn(const TArray<uint8>& InBytes) : Bytes(InBytes)
+		{
+		}
+
+		virtual void ReadBytes(void* outData, size_t inNumBytes) override
+		{
+			if (Failed || Offset + static_cast<int64>(inNumBytes) > Bytes.Num())
+			{
+				//jolt doesn't check every read, so hand back zeroes rather than garbage.
+				FMemory::Memzero(outData, inNumBytes);
+				Failed = true;
+				return;
+			}
+			FMemory::Memcpy(outData, Bytes.GetData() + Offset, inNumBytes);
+			Offset += inNumBytes;
+		}
+
+		virtual bool IsEOF() const override
+		{
+			return Offset >= Bytes.Num();
+		}
+
+		virtual bool IsFailed() const override
+		{
+			return Failed;
+		}
+
+	private:
+		const TArray<uint8>& Bytes;
+		int64 Offset = 0;
+		bool Failed = false;
+	};
+}
+
+FBMeshShapeCache::FBMeshShapeCache(bool bInPersistToDisk) : bPersistToDisk(bInPersistToDisk)
+{
+}
+
+int32 FBMeshShapeCache::Num() const
+{
+	FScopeLock Lock(&CacheLock);
+	return Unscaled.Num() + Scaled.Num();
+}
+
+void FBMeshShapeCache::Empty()
+{
+	FScopeLock Lock(&CacheLock);
+	Scaled.Empty();
+	Unscaled.Empty();
+}
+
+int32 FBMeshShapeCache::TrimUnused()
+{
+	FScopeLock Lock(&CacheLock);
+	return TrimUnusedLocked();
+}
+
+int32 FBMeshShapeCache::TrimUnusedLocked()
+{
+	//a ref count of one is just us. scaled shapes hold their unscaled base, so they go first. unit scale is never in
+	//Scaled, since that's the base itself and would hold its own count up forever.
+	int32 Trimmed = 0;
+	for (auto It = Scaled.CreateIterator(); It; ++It)
+	{
+		if (It.Value()->GetRefCount() <= 1)
+		{
+			It.RemoveCurrent();
+			++Trimmed;
+		}
+	}
+	for (auto It = Unscaled.CreateIterator(); It; ++It)
+	{
+		if (It.Value()->GetRefCount() <= 1)
+		{
+			It.RemoveCurrent();
+			++Trimmed;
+		}
+	}
+	return Trimmed;
+}
+
+void FBMeshShapeCache::SaveShape(const Shape& Shape, TArray<uint8>& OutBytes)
+{
+	OutBytes.Reset();
+	FBShapeBytesOut Out(OutBytes);
+	Out.Write(CacheMagic);
+	Out.Write(CacheVersion);
+	Out.Write(static_cast<uint64>(JPH_VERSION_ID));
+	Shape::ShapeToIDMap ShapeMap;
+	Shape::MaterialToIDMap MaterialMap;
+	Shape.SaveWithChildren(Out, ShapeMap, MaterialMap);
+}
+
+ShapeRefC FBMeshShapeCache::LoadShape(const TArray<uint8>& Bytes)
+{
+	FBShapeBytesIn In(Bytes);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint64 JoltVersion = 0;
+	In.Read(Magic);
+	In.Read(Version);
+	In.Read(JoltVersion);
+	if (In.IsFailed() || Magic != CacheMagic || Version != CacheVersion || JoltVersion != static_cast<uint64>(JPH_VERSION_ID))
+	{
+		return nullptr;
+	}
+	Shape::IDToShapeMap ShapeMap;
+	Shape::IDToMaterialMap MaterialMap;
+	Shape::ShapeResult Result = Shape::sRestoreWithChildren(In, ShapeMap, MaterialMap);
+	if (In.IsFailed() || Result.HasError() || !Result.IsValid())
+	{
+		return nullptr;
+	}
+	return Result.Get();
+}
+
+FString FBMeshShapeCache::CachePathFor(const UStaticMesh* Mesh, const UBodySetup* Body)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Barrage"), TEXT("MeshShapes"),
+	                       FString::Printf(TEXT("%s_%s.jshape"), *FPaths::MakeValidFileName(Mesh->GetName()), *Body->BodySetupGuid.ToString()));
+}
+
+//https://github.com/jrouwe/JoltPhysics/blob/master/Samples/Tests/Shapes/MeshShapeTest.cpp
+//probably worth reviewing how indexed triangles work, too : https://www.youtube.com/watch?v=dOjZw5VU6aM
+ShapeRefC FBMeshShapeCache::CookFromChaos(const UBodySetup* Body)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Cook Jolt Mesh Shape");
+	auto& MeshSet = Body->TriMeshGeometries;
+	JPH::VertexList JoltVerts;
+	JPH::IndexedTriangleList JoltIndexedTriangles;
+	uint32 tris = 0;
+	for (auto& Mesh : MeshSet)
+	{
+		tris += Mesh->Elements().GetNumTriangles();
+	}
+	JoltVerts.reserve(tris);
+	JoltIndexedTriangles.reserve(tris);
+	for (auto& Mesh : MeshSet)
+	{
+		//indexed triangles are made by collecting the vertexes, then generating triples describing the triangles.
+		//this allows the heavier vertices to be stored only once, rather than each time they are used. for large models
+		//like terrain, this can be extremely significant. though, it's not truly clear to me if it's worth it.
+		//each chaos mesh indexes its own particles, so offset into the verts we've already collected.
+		const uint32 Base = static_cast<uint32>(JoltVerts.size());
+		auto& VertToTriBuffers = Mesh->Elements();
+		auto& Verts = Mesh->Particles().X();
+		if (VertToTriBuffers.RequiresLargeIndices())
+		{
+			for (auto& aTri : VertToTriBuffers.GetLargeIndexBuffer())
+			{
+				JoltIndexedTriangles.push_back(IndexedTriangle(Base + aTri[2], Base + aTri[1], Base + aTri[0]));
+			}
+		}
+		else
+		{
+			for (auto& aTri : VertToTriBuffers.GetSmallIndexBuffer())
+			{
+				JoltIndexedTriangles.push_back(IndexedTriangle(Base + aTri[2], Base + aTri[1], Base + aTri[0]));
+			}
+		}
+
+		for (auto& vtx : Verts)
+		{
+			JoltVerts.push_back(CoordinateUtils::ToJoltCoordinates(vtx));
+		}
+	}
+	JPH::MeshShapeSettings FullMesh(JoltVerts, JoltIndexedTriangles);
+	JPH::ShapeSettings::ShapeResult err = FullMesh.Create();
+	if (err.HasError())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Barrage: jolt refused a mesh shape: %hs"), err.GetError().c_str());
+		return nullptr;
+	}
+	return err.Get();
+}
+
+ShapeRefC FBMeshShapeCache::CookUnscaled(const UStaticMesh* Mesh, const UBodySetup* Body) const
+{
+	const FString CachePath = bPersistToDisk ? CachePathFor(Mesh, Body) : FString();
+	ShapeRefC Cooked;
+	if (bPersistToDisk)
+	{
+		TArray<uint8> Bytes;
+		if (FFileHelper::LoadFileToArray(Bytes, *CachePath, FILEREAD_Silent))
+		{
+			Cooked = LoadShape(Bytes);
+		}
+	}
+	if (!Cooked)
+	{
+		Cooked = CookFromChaos(Body);
+		if (Cooked && bPersistToDisk)
+		{
+			TArray<uint8> Bytes;
+			SaveShape(*Cooked, Bytes);
+			if (!FFileHelper::SaveArrayToFile(Bytes, *CachePath))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Barrage: couldn't write cooked mesh shape to %s"), *CachePath);
+			}
+		}
+	}
+	return Cooked;
+}
+
+ShapeRefC FBMeshShapeCache::FindOrCook(const UStaticMesh* Mesh, Vec3Arg Scale)
+{
+	if (!Mesh)
+	{
+		return nullptr;
+	}
+	const UBodySetup* Body = Mesh->GetBodySetup();
+	if (!Body)
+	{
+		return nullptr;
+	}
+	return FindOrScale(FObjectKey(Mesh), Scale, [this, Mesh, Body]() { return CookUnscaled(Mesh, Body); });
+}
+
+ShapeRefC FBMeshShapeCache::FindOrScale(FObjectKey Mesh, Vec3Arg Scale, TFunctionRef<ShapeRefC()> Cook)
+{
+	const FScaledKey Key{
+		Mesh,
+		FIntVector(FMath::RoundToInt32(Scale.GetX() * ScaleQuantum),
+		           FMath::RoundToInt32(Scale.GetY() * ScaleQuantum),
+		           FMath::RoundToInt32(Scale.GetZ() * ScaleQuantum))
+	};
+
+	FScopeLock Lock(&CacheLock);
+	if (const ShapeRefC* Found = Scaled.Find(Key))
+	{
+		return *Found;
+	}
+	ShapeRefC Base;
+	if (const ShapeRefC* Found = Unscaled.Find(Mesh))
+	{
+		Base = *Found;
+	}
+	else
+	{
+		Base = Cook();
+		if (!Base)
+		{
+			return nullptr;
+		}
+		Unscaled.Add(Mesh, Base);
+	}
+	//from the key, not the caller's exact scale, or the first caller would decide it for everyone who rounds the same.
+	const Vec3 RoundedScale(static_cast<float>(Key.Scale.X / ScaleQuantum),
+	                        static_cast<float>(Key.Scale.Y / ScaleQuantum),
+	                        static_cast<float>(Key.Scale.Z / ScaleQuantum));
+	Shape::ShapeResult Result = Base->ScaleShape(RoundedScale);
+	if (Result.HasError() || !Result.IsValid())
+	{
+		return nullptr;
+	}
+	ShapeRefC ScaledShape = Result.Get();
+	//jolt hands back the base itself for unit scale, or near enough. it's already cached as that.
+	if (ScaledShape == Base)
+	{
+		return Base;
+	}
+	if (Scaled.Num() >= SoftLimit)
+	{
+		TrimUnusedLocked();
+	}
+	Scaled.Add(Key, ScaledShape);
+	return ScaledShape;
+}
@@ -33,7 +33,10 @@ JPH::BodyID FBCharacter::Create(JPH::CharacterVsCharacterCollision* CVCColliderS
 			//mCharacterSettings.mInnerBodyLayer = Layers::MOVING;
 			
 			mCharacter = new CharacterVirtual(&mCharacterSettings, mInitialPosition, Quat::sIdentity(), 0, World.Get());
-			//mCharacter->SetListener(this);
+			//we hold the body pushes, and the ground push that needs this mass, until every character has stepped.
+			//see FWorldSimOwner::StepCharacters. mCharacterSettings keeps the real mass.
+			mCharacter->SetListener(this);
+			mCharacter->SetMass(0.0f);
 			
 			mCharacter->SetCharacterVsCharacterCollision(CVCColliderSystem); // see https://github.com/jrouwe/JoltPhysics/blob/e3ed3b1d33f3a0e7195fbac8b45b30f0a5c8a55b/UnitTests/Physics/CharacterVirtualTests.cpp#L759
 			mEffectiveVelocity = Vec3::sZero();
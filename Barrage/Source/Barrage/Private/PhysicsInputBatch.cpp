@@ -0,0 +1,211 @@
+#include "PhysicsInputBatch.h"
+
+#include "BarrageDispatch.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 GBarrageInputCoalesce = 1;
+static FAutoConsoleVariableRef CVarBarrageInputCoalesce(
+	TEXT("barrage.Input.Coalesce"),
+	GBarrageInputCoalesce,
+	TEXT("Fold each tick's physics inputs down to one per body and type before applying them. 0 applies them all, in arrival order."));
+
+static int32 GBarrageInputOverflowPolicy = static_cast<int32>(FBPhysicsInputPressure::EOverflow::Drop);
+static FAutoConsoleVariableRef CVarBarrageInputOverflowPolicy(
+	TEXT("barrage.Input.OverflowPolicy"),
+	GBarrageInputOverflowPolicy,
+	TEXT("What a full physics input feed does with a new input. 0 drops it. 1 waits up to barrage.Input.OverflowWaitMs for room, then drops it. Drops are always counted, see barrage.Input.Report."));
+
+static float GBarrageInputOverflowWaitMs = 1.0f;
+static FAutoConsoleVariableRef CVarBarrageInputOverflowWaitMs(
+	TEXT("barrage.Input.OverflowWaitMs"),
+	GBarrageInputOverflowWaitMs,
+	TEXT("How long an enqueue will wait on a full feed under barrage.Input.OverflowPolicy 1."));
+
+static const TCHAR* InputTypeName(int32 Action)
+{
+	switch (static_cast<PhysicsInputType>(Action))
+	{
+	case PhysicsInputType::SelfMovement: return TEXT("SelfMovement");
+	case PhysicsInputType::Velocity: return TEXT("Velocity");
+	case PhysicsInputType::OtherForce: return TEXT("OtherForce");
+	case PhysicsInputType::Rotation: return TEXT("Rotation");
+	case PhysicsInputType::SetPosition: return TEXT("SetPosition");
+	case PhysicsInputType::SetGravityFactor: return TEXT("SetGravityFactor");
+	case PhysicsInputType::SetCharacterGravity: return TEXT("SetCharacterGravity");
+	case PhysicsInputType::AIMovement: return TEXT("AIMovement");
+	case PhysicsInputType::Throttle: return TEXT("Throttle");
+	default: return TEXT("Unknown");
+	}
+}
+
+static FAutoConsoleCommandWithWorld CmdBarrageInputReport(
+	TEXT("barrage.Input.Report"),
+	TEXT("Log how many physics inputs have been drained, coalesced away, waited on and dropped."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UBarrageDispatch* Physics = World ? World->GetSubsystem<UBarrageDispatch>() : nullptr;
+		if (Physics)
+		{
+			const FBPhysicsInputStats Stats = Physics->GetPhysicsInputStats();
+			UE_LOG(LogTemp, Display, TEXT("Barrage:Input: %llu drained, %llu applied after coalescing, %llu waited for room, %llu dropped."),
+			       Stats.Drained, Stats.Applied, Stats.Waited, Stats.Dropped);
+			for (int32 Action = 0; Action < NUM_PHYSICS_INPUT_TYPES; ++Action)
+			{
+				if (Stats.DroppedByType[Action])
+				{
+					UE_LOG(LogTemp, Display, TEXT("Barrage:Input:   %s: %llu dropped"), InputTypeName(Action), Stats.DroppedByType[Action]);
+				}
+			}
+		}
+	}));
+
+FBPhysicsInputBatch::EFold FBPhysicsInputBatch::HowToFold(PhysicsInputType Action)
+{
+	switch (Action)
+	{
+	//these all end up as AddForce, or as += on a character, so adding them up first changes nothing.
+	case PhysicsInputType::SelfMovement:
+	case PhysicsInputType::OtherForce:
+	case PhysicsInputType::AIMovement:
+		return EFold::Sum;
+	//these overwrite, so only the last one ever mattered.
+	case PhysicsInputType::Velocity:
+	case PhysicsInputType::Rotation:
+	case PhysicsInputType::SetPosition:
+	case PhysicsInputType::SetGravityFactor:
+	case PhysicsInputType::SetCharacterGravity:
+	case PhysicsInputType::Throttle:
+		return EFold::LastWins;
+	default:
+		return EFold::Keep;
+	}
+}
+
+void FBPhysicsInputBatch::Coalesce()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Coalesce Physics Inputs");
+	if (!GBarrageInputCoalesce || Inputs.Num() < 2)
+	{
+		return;
+	}
+	Inputs.StableSort([](const FBPhysicsInput& A, const FBPhysicsInput& B)
+	{
+		if (A.Target.KeyIntoBarrage != B.Target.KeyIntoBarrage)
+		{
+			return A.Target.KeyIntoBarrage < B.Target.KeyIntoBarrage;
+		}
+		return A.Action < B.Action;
+	});
+
+	int32 Kept = 1;
+	for (int32 Index = 1; Index < Inputs.Num(); ++Index)
+	{
+		const FBPhysicsInput& Next = Inputs[Index];
+		FBPhysicsInput& Last = Inputs[Kept - 1];
+		if (Last.Target == Next.Target && Last.Action == Next.Action && Last.metadata == Next.metadata)
+		{
+			const EFold Fold = HowToFold(Next.Action);
+			if (Fold == EFold::Sum)
+			{
+				Last.State += Next.State;
+				Last.Sequence = Next.Sequence;
+				continue;
+			}
+			if (Fold == EFold::LastWins)
+			{
+				Last = Next;
+				continue;
+			}
+		}
+		if (Kept != Index)
+		{
+			Inputs[Kept] = Next;
+		}
+		++Kept;
+	}
+	Inputs.SetNum(Kept, EAllowShrinking::No);
+}
+
+void FBPhysicsInputBatch::Resolve(TFunctionRef<JPH::BodyID(FBarrageKey)> Find)
+{
+	Bodies.SetNumUninitialized(Inputs.Num(), EAllowShrinking::No);
+	Distinct.Reset();
+	for (int32 Index = 0; Index < Inputs.Num(); ++Index)
+	{
+		//sorted or not, runs of the same target are common, and one lookup covers the whole run.
+		if (Index > 0 && Inputs[Index].Target == Inputs[Index - 1].Target)
+		{
+			Bodies[Index] = Bodies[Index - 1];
+			continue;
+		}
+		Bodies[Index] = Find(Inputs[Index].Target);
+		if (!Bodies[Index].IsInvalid())
+		{
+			Distinct.Add(Bodies[Index]);
+		}
+	}
+}
+
+bool FBPhysicsInputPressure::Enqueue(TCircularQueue<FBPhysicsInput>& Feed, const FBPhysicsInput& Input)
+{
+	if (Feed.Enqueue(Input))
+	{
+		return true;
+	}
+
+	if (GBarrageInputOverflowPolicy == static_cast<int32>(EOverflow::Wait)
+		&& Drainer.load(std::memory_order_relaxed) != std::this_thread::get_id())
+	{
+		Waited.fetch_add(1, std::memory_order_relaxed);
+		const uint64 GiveUpAt = FPlatformTime::Cycles64()
+			+ static_cast<uint64>(FMath::Max(GBarrageInputOverflowWaitMs, 0.0f) / 1000.0 / FPlatformTime::GetSecondsPerCycle64());
+		while (FPlatformTime::Cycles64() < GiveUpAt)
+		{
+			FPlatformProcess::Yield();
+			if (Feed.Enqueue(Input))
+			{
+				return true;
+			}
+		}
+	}
+
+	NoteDropped(Input.Action);
+	return false;
+}
+
+void FBPhysicsInputPressure::NoteDropped(PhysicsInputType Action)
+{
+	const int32 Slot = FMath::Clamp(static_cast<int32>(Action), 0, NUM_PHYSICS_INPUT_TYPES - 1);
+	DroppedByType[Slot].fetch_add(1, std::memory_order_relaxed);
+
+	//a full feed drops thousands at a time. once a second is plenty to notice.
+	const uint64 Now = FPlatformTime::Cycles64();
+	uint64 Last = LastWarnedAt.load(std::memory_order_relaxed);
+	if ((Last == 0 || FPlatformTime::ToSeconds64(Now - Last) >= 1.0)
+		&& LastWarnedAt.compare_exchange_strong(Last, Now, std::memory_order_relaxed))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Barrage:Input: a physics input feed is full, dropping %s input. See barrage.Input.Report."),
+		       InputTypeName(Slot));
+	}
+}
+
+void FBPhysicsInputPressure::NoteDrained(uint64 DrainedNow, uint64 AppliedNow)
+{
+	Drainer.store(std::this_thread::get_id(), std::memory_order_relaxed);
+	Drained.fetch_add(DrainedNow, std::memory_order_relaxed);
+	Applied.fetch_add(AppliedNow, std::memory_order_relaxed);
+}
+
+FBPhysicsInputStats FBPhysicsInputPressure::GetStats() const
+{
+	FBPhysicsInputStats Stats;
+	Stats.Drained = Drained.load(std::memory_order_relaxed);
+	Stats.Applied = Applied.load(std::memory_order_relaxed);
+	Stats.Waited = Waited.load(std::memory_order_relaxed);
+	for (int32 Action = 0; Action < NUM_PHYSICS_INPUT_TYPES; ++Action)
+	{
+		Stats.DroppedByType[Action] = DroppedByType[Action].load(std::memory_order_relaxed);
+		Stats.Dropped += Stats.DroppedByType[Action];
+	}
+	return Stats;
+}
@@ -0,0 +1,82 @@
+#include "PrimitiveShapeCache.h"
+
+using namespace JOLT;
+
+JPH::ShapeRefC FBPrimitiveShapeCache::FindOrCreate(const FShapeKey& Key, TFunctionRef<ShapeRefC()> Create)
+{
+	ShapeRefC Found;
+	if (Shapes.find(Key, Found))
+	{
+		return Found;
+	}
+	//two threads can both miss and both build one. whoever inserts second just takes the first one's.
+	ShapeRefC Created = Create();
+	if (!Created)
+	{
+		return Created;
+	}
+	Shapes.uprase_fn(Key, [&Found](ShapeRefC& Existing)
+	{
+		Found = Existing;
+		return false;
+	}, Created);
+	return Found ? Found : Created;
+}
+
+JPH::ShapeRefC FBPrimitiveShapeCache::FindOrCreateBox(Vec3Arg HalfExtent, float ConvexRadius, Vec3Arg Offset)
+{
+	FShapeKey Key;
+	Key.Kind = EKind::Box;
+	Key.Dimensions = Quantize(HalfExtent);
+	Key.Offset = Quantize(Offset);
+	Key.ConvexRadius = Quantize(ConvexRadius);
+	return FindOrCreate(Key, [&Key]() -> ShapeRefC
+	{
+		Ref<Shape> Box = new BoxShape(Dequantize(Key.Dimensions), Dequantize(Key.ConvexRadius));
+		ShapeSettings::ShapeResult Result = RotatedTranslatedShapeSettings(Dequantize(Key.Offset), Quat::sIdentity(), Box).Create();
+		return Result.IsValid() ? Result.Get() : ShapeRefC();
+	});
+}
+
+JPH::ShapeRefC FBPrimitiveShapeCache::FindOrCreateSphere(float Radius)
+{
+	FShapeKey Key;
+	Key.Kind = EKind::Sphere;
+	Key.Dimensions = FIntVector(Quantize(Radius), 0, 0);
+	return FindOrCreate(Key, [&Key]() -> ShapeRefC
+	{
+		return new SphereShape(Dequantize(Key.Dimensions.X));
+	});
+}
+
+JPH::ShapeRefC FBPrimitiveShapeCache::FindOrCreateCapsule(float HalfHeightOfCylinder, float Radius)
+{
+	FShapeKey Key;
+	Key.Kind = EKind::Capsule;
+	Key.Dimensions = FIntVector(Quantize(HalfHeightOfCylinder), Quantize(Radius), 0);
+	return FindOrCreate(Key, [&Key]() -> ShapeRefC
+	{
+		return new CapsuleShape(Dequantize(Key.Dimensions.X), Dequantize(Key.Dimensions.Y));
+	});
+}
+
+int32 FBPrimitiveShapeCache::EvictUnused()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Evict Unused Shapes");
+	int32 Evicted = 0;
+	//with the table locked, nobody can take a new ref through us, and a count of one means nobody else has one.
+	auto Locked = Shapes.lock_table();
+	for (auto It = Locked.begin(); It != Locked.end();)
+	{
+		if (It->second->GetRefCount() <= 1)
+		{
+			It = Locked.erase(It);
+			++Evicted;
+		}
+		else
+		{
+			++It;
+		}
+	}
+	return Evicted;
+}
@@ -0,0 +1,218 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "FWorldSimOwner.h"
+#include "PhysicsCharacter.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeExit.h"
+
+using namespace JOLT;
+
+namespace BarrageRollbackTest
+{
+	static constexpr int32 Characters = 16;
+	static constexpr int32 Ticks = 96;
+	//far enough in that the crowd's been shoving boxes for a while, so there are contacts to get back.
+	static constexpr int32 RestoreAt = 40;
+	static constexpr double SpacingCm = 80.0;
+	static constexpr double BoxCm = 30.0;
+
+	static bool SameBits(float A, float B)
+	{
+		return FMemory::Memcmp(&A, &B, sizeof(float)) == 0;
+	}
+
+	static bool SameBits(Vec3Arg A, Vec3Arg B)
+	{
+		return SameBits(A.GetX(), B.GetX()) && SameBits(A.GetY(), B.GetY()) && SameBits(A.GetZ(), B.GetZ());
+	}
+
+	static bool SameBits(QuatArg A, QuatArg B)
+	{
+		return SameBits(A.GetXYZ(), B.GetXYZ()) && SameBits(A.GetW(), B.GetW());
+	}
+
+	struct FBodyState
+	{
+		RVec3 Position;
+		Quat Rotation;
+		Vec3 Linear;
+		Vec3 Angular;
+	};
+
+	//everything a tick leaves behind that we check, boxes first, then characters.
+	struct FTickState
+	{
+		TArray<FBodyState> Boxes;
+		TArray<FBodyState> Walkers;
+	};
+
+	//the same crowd and boxes as the parallel stepping test, smaller.
+	struct FScene
+	{
+		FWorldSimOwner World{1.0f / 128.0f, [](int) {}};
+		TArray<TSharedPtr<FBCharacter>> Walkers;
+		TArray<BodyID> Boxes;
+
+		FScene()
+		{
+			FBBoxParams Floor = FBarrageBounder::GenerateBoxBounds(FVector3d(0, 0, -50), 100000, 100000, 100);
+			TArray<BodyCreationSettings> Settings;
+			Settings.Add(World.MakeBodySettings(Floor, Layers::NON_MOVING));
+
+			const int32 Side = FMath::CeilToInt32(FMath::Sqrt(static_cast<double>(Characters)));
+			for (int32 Index = 0; Index < Characters; Index += 2)
+			{
+				FBBoxParams Box = FBarrageBounder::GenerateBoxBounds(FVector3d(
+					(Index % Side - Side / 2 + 0.5) * SpacingCm, (Index / Side - Side / 2 + 0.5) * SpacingCm, BoxCm / 2), BoxCm, BoxCm, BoxCm);
+				Settings.Add(World.MakeBodySettings(Box, Layers::MOVING, false, true));
+			}
+			TArray<FBarrageKey> Keys;
+			World.CreateAndAddBodies(Settings, Keys);
+			for (int32 Index = 1; Index < Keys.Num(); ++Index)
+			{
+				BodyID Box;
+				if (World.GetBodyIDOrDefault(Keys[Index], Box))
+				{
+					Boxes.Add(Box);
+				}
+			}
+
+			for (int32 Index = 0; Index < Characters; ++Index)
+			{
+				FBCharParams Params = FBarrageBounder::GenerateCharacterBounds(FVector3d(
+					(Index % Side - Side / 2) * SpacingCm, (Index / Side - Side / 2) * SpacingCm, 10), 30, 90, 6.0);
+				const FBarrageKey Key = World.CreatePrimitive(Params, Layers::MOVING);
+				TSharedPtr<FBCharacter> Walker = StaticCastSharedPtr<FBCharacter>(World.CharacterToJoltMapping->Find(Key));
+				if (Walker && Walker->mCharacter)
+				{
+					Walker->mThrottleModel = Quat(1, 1, 1, 1);
+					Walkers.Add(Walker);
+				}
+			}
+		}
+
+		//everyone walks at the middle, which only depends on where they are, so a restored tick walks the same way.
+		void Step()
+		{
+			for (const TSharedPtr<FBCharacter>& Walker : Walkers)
+			{
+				const RVec3 At = Walker->GetPosition();
+				Walker->mLocomotionUpdate = Vec3(-At.GetX(), 0, -At.GetZ()).NormalizedOr(Vec3::sZero()) * 3.0f;
+			}
+			World.StepSimulation();
+			World.StepCharacters();
+		}
+
+		FTickState Capture() const
+		{
+			FTickState State;
+			const BodyInterface& Bodies = World.physics_system->GetBodyInterface();
+			for (const BodyID& Box : Boxes)
+			{
+				State.Boxes.Add({Bodies.GetPosition(Box), Bodies.GetRotation(Box), Bodies.GetLinearVelocity(Box), Bodies.GetAngularVelocity(Box)});
+			}
+			for (const TSharedPtr<FBCharacter>& Walker : Walkers)
+			{
+				const CharacterVirtual& Virtual = *Walker->mCharacter;
+				State.Walkers.Add({Virtual.GetPosition(), Virtual.GetRotation(), Virtual.GetLinearVelocity(), Vec3::sZero()});
+			}
+			return State;
+		}
+	};
+
+	static bool SameBits(const FBodyState& A, const FBodyState& B)
+	{
+		return SameBits(A.Position, B.Position) && SameBits(A.Rotation, B.Rotation)
+			&& SameBits(A.Linear, B.Linear) && SameBits(A.Angular, B.Angular);
+	}
+}
+
+//saves every tick while a crowd shoves some boxes around, rolls back partway, steps the rest again, and wants every
+//box and character to land on the same bits they did the first time, every tick.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBarrageRollbackRestoreReplaysBitIdentical, "Barrage.Rollback.RestoreReplaysBitIdentical",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FBarrageRollbackRestoreReplaysBitIdentical::RunTest(const FString& Parameters)
+{
+	using namespace BarrageRollbackTest;
+	IConsoleVariable* Enabled = IConsoleManager::Get().FindConsoleVariable(TEXT("barrage.Rollback.Enabled"));
+	if (!TestNotNull(TEXT("barrage.Rollback.Enabled"), Enabled))
+	{
+		return false;
+	}
+	const int32 WasEnabled = Enabled->GetInt();
+	Enabled->Set(1, ECVF_SetByCode);
+	ON_SCOPE_EXIT
+	{
+		Enabled->Set(WasEnabled, ECVF_SetByCode);
+	};
+
+	FScene Scene;
+	if (!TestEqual(TEXT("characters created"), Scene.Walkers.Num(), Characters) || !TestTrue(TEXT("boxes created"), Scene.Boxes.Num() > 0))
+	{
+		return false;
+	}
+	Scene.World.Rollback.SetWindow(Ticks);
+
+	TArray<FTickState> FirstTime;
+	for (int32 Tick = 0; Tick < Ticks; ++Tick)
+	{
+		TestNotNull(TEXT("tick saved"), Scene.World.SaveTick(FBRollbackTick{static_cast<uint64>(Tick), 0, 0}));
+		Scene.Step();
+		FirstTime.Add(Scene.Capture());
+	}
+
+	TArray<FBRollbackTick> Replay;
+	if (!TestTrue(TEXT("restored"), Scene.World.RestoreTick(RestoreAt, Replay))
+		|| !TestEqual(TEXT("ticks to replay"), Replay.Num(), Ticks - RestoreAt))
+	{
+		return false;
+	}
+	int32 Mismatches = 0;
+	for (const FBRollbackTick& Stepped : Replay)
+	{
+		Scene.World.SaveTick(Stepped);
+		Scene.Step();
+		const FTickState Again = Scene.Capture();
+		const FTickState& Before = FirstTime[Stepped.Tick];
+		for (int32 Index = 0; Index < Again.Boxes.Num() && Mismatches == 0; ++Index)
+		{
+			if (!SameBits(Again.Boxes[Index], Before.Boxes[Index]))
+			{
+				++Mismatches;
+				AddError(FString::Printf(TEXT("tick %llu, box %d: replayed and original disagree"), Stepped.Tick, Index));
+			}
+		}
+		for (int32 Index = 0; Index < Again.Walkers.Num() && Mismatches == 0; ++Index)
+		{
+			if (!SameBits(Again.Walkers[Index], Before.Walkers[Index]))
+			{
+				++Mismatches;
+				AddError(FString::Printf(TEXT("tick %llu, character %d: replayed and original disagree"), Stepped.Tick, Index));
+			}
+		}
+		if (Mismatches)
+		{
+			break;
+		}
+	}
+	TestEqual(TEXT("replayed ticks that disagree with the original"), Mismatches, 0);
+
+	//one more tick pushes the oldest out of the window.
+	Scene.World.SaveTick(FBRollbackTick{static_cast<uint64>(Ticks), 0, 0});
+	Scene.Step();
+	TestFalse(TEXT("a tick out of the window won't restore"), Scene.World.RestoreTick(0, Replay));
+	TestFalse(TEXT("a tick never saved won't restore"), Scene.World.RestoreTick(Ticks * 2, Replay));
+
+	//jolt can't unmake a body, so a tick from before one came won't restore either.
+	TArray<BodyCreationSettings> Late;
+	Late.Add(Scene.World.MakeBodySettings(FBarrageBounder::GenerateBoxBounds(FVector3d(0, 0, 500), BoxCm, BoxCm, BoxCm), Layers::MOVING, false, true));
+	TArray<FBarrageKey> LateKeys;
+	Scene.World.CreateAndAddBodies(Late, LateKeys);
+	TestFalse(TEXT("a tick from before a body was added won't restore"), Scene.World.RestoreTick(Ticks, Replay));
+	return true;
+}
+
+#endif
@@ -0,0 +1,252 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "FWorldSimOwner.h"
+#include "PhysicsCharacter.h"
+#include "CoordinateUtils.h"
+#include "BarragePhaseTimings.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+using namespace JOLT;
+
+//headless: UnrealEditor-Cmd <project> -nullrhi -ExecCmds="Automation RunTests Barrage.Benchmark.Scenes; Quit"
+//drives a scratch FWorldSimOwner through a fixed set of scripted scenes, the same phases in the same order StepWorld
+//runs them, and reports per-phase percentiles. scenes are built from fixed positions and a fixed seed, and every run
+//steps the same number of ticks, so two runs on the same box should only differ by noise. results also land in
+//Saved/Benchmarks/BarrageScenes.csv, one row per scene and phase, for CI to keep and diff.
+//
+//StackUp and ContactEvents belong to UBarrageDispatch, which needs a live world, so they aren't covered here.
+namespace BarrageSceneBenchmark
+{
+	static constexpr int32 WarmupTicks = 32;
+	static constexpr int32 MeasuredTicks = 512;
+	//128hz.
+	static constexpr double BudgetMs = 1000.0 / 128.0;
+	static constexpr int32 Seed = 0x0BA55A6E;
+
+	struct FScene
+	{
+		const TCHAR* Name;
+		int32 Projectiles;
+		int32 Characters;
+		int32 Searches;
+		//dynamic spheres dropped on the level, so searches have something to find and the solver has islands to chew on.
+		int32 Props;
+	};
+
+	static const FScene Scenes[] = {
+		{TEXT("LevelOnly"), 0, 0, 0, 0},
+		{TEXT("Projectiles100"), 100, 0, 0, 0},
+		{TEXT("Projectiles1000"), 1000, 0, 0, 0},
+		{TEXT("Characters100"), 0, 100, 0, 0},
+		{TEXT("Characters1000"), 0, 1000, 0, 0},
+		{TEXT("Searches100"), 0, 0, 100, 256},
+		{TEXT("Searches1000"), 0, 0, 1000, 256},
+		{TEXT("Mixed"), 500, 200, 500, 256},
+	};
+
+	static constexpr EBarragePhase ReportedPhases[] = {
+		EBarragePhase::Optimize, EBarragePhase::Physics, EBarragePhase::Characters, EBarragePhase::TransformExport,
+		EBarragePhase::Queries
+	};
+
+	//a rolling 64x64 grid of quads, 100m on a side, standing in for a level's static mesh.
+	static void AddLevelMesh(FWorldSimOwner& World)
+	{
+		constexpr int32 Cells = 64;
+		constexpr float CellSize = 100.0f / Cells;
+		VertexList Verts;
+		for (int32 Z = 0; Z <= Cells; ++Z)
+		{
+			for (int32 X = 0; X <= Cells; ++X)
+			{
+				const float Height = 0.5f * FMath::Sin(X * 0.4f) * FMath::Cos(Z * 0.3f);
+				Verts.push_back(Float3((X - Cells / 2) * CellSize, Height, (Z - Cells / 2) * CellSize));
+			}
+		}
+		IndexedTriangleList Tris;
+		for (int32 Z = 0; Z < Cells; ++Z)
+		{
+			for (int32 X = 0; X < Cells; ++X)
+			{
+				const uint32 Corner = Z * (Cells + 1) + X;
+				Tris.push_back(IndexedTriangle(Corner, Corner + Cells + 1, Corner + 1));
+				Tris.push_back(IndexedTriangle(Corner + 1, Corner + Cells + 1, Corner + Cells + 2));
+			}
+		}
+		MeshShapeSettings Settings(Verts, Tris);
+		Shape::ShapeResult Mesh = Settings.Create();
+		check(!Mesh.HasError());
+		TArray<BodyCreationSettings> Level;
+		Level.Add(BodyCreationSettings(Mesh.Get(), RVec3::sZero(), Quat::sIdentity(), EMotionType::Static, Layers::NON_MOVING));
+		TArray<FBarrageKey> Keys;
+		World.CreateAndAddBodies(Level, Keys);
+	}
+
+	//kinematic, like the real ones, fired across the level from around its edge at a few heights.
+	static void AddProjectiles(FWorldSimOwner& World, FRandomStream& Random, int32 Count)
+	{
+		TArray<BodyCreationSettings> Settings;
+		Settings.Reserve(Count);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const double Angle = Random.FRandRange(0, UE_DOUBLE_TWO_PI);
+			const FVector3d From(FMath::Cos(Angle) * 4000.0, FMath::Sin(Angle) * 4000.0, Random.FRandRange(50, 400));
+			FBSphereParams Sphere = FBarrageBounder::GenerateSphereBounds(From, 10);
+			BodyCreationSettings& Projectile = Settings.Add_GetRef(World.MakeBodySettings(Sphere, Layers::PROJECTILE));
+			Projectile.mLinearVelocity = CoordinateUtils::ToJoltCoordinates(-From.GetSafeNormal2D() * 3000.0);
+		}
+		TArray<FBarrageKey> Keys;
+		World.CreateAndAddBodies(Settings, Keys);
+	}
+
+	static void AddProps(FWorldSimOwner& World, FRandomStream& Random, int32 Count)
+	{
+		TArray<BodyCreationSettings> Settings;
+		Settings.Reserve(Count);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FVector3d At(Random.FRandRange(-4000, 4000), Random.FRandRange(-4000, 4000), Random.FRandRange(100, 600));
+			FBSphereParams Sphere = FBarrageBounder::GenerateSphereBounds(At, 40);
+			Settings.Add(World.MakeBodySettings(Sphere, Layers::MOVING));
+		}
+		TArray<FBarrageKey> Keys;
+		World.CreateAndAddBodies(Settings, Keys);
+	}
+
+	//through CreatePrimitive, same as a spawn.
+	static void AddCharacters(FWorldSimOwner& World, int32 Count, TArray<TSharedPtr<FBCharacter>>& OutCharacters)
+	{
+		const int32 Side = FMath::CeilToInt32(FMath::Sqrt(static_cast<double>(Count)));
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			FBCharParams Params = FBarrageBounder::GenerateCharacterBounds(FVector3d(
+				(Index % Side - Side / 2) * 150.0, (Index / Side - Side / 2) * 150.0, 150), 30, 90, 6.0);
+			const FBarrageKey Key = World.CreatePrimitive(Params, Layers::MOVING);
+			TSharedPtr<FBCharacter> Character = StaticCastSharedPtr<FBCharacter>(World.CharacterToJoltMapping->Find(Key));
+			if (Character && Character->mCharacter)
+			{
+				Character->mThrottleModel = Quat(1, 1, 1, 1);
+				OutCharacters.Add(Character);
+			}
+		}
+	}
+
+	//a fixed spread of search centers, each one drifting a little every tick like a moving perceiver would.
+	static void FillSearches(FBQueryBatch& Batch, int32 Count, int32 Tick)
+	{
+		Batch.Reset();
+		const int32 Side = FMath::Max(1, FMath::CeilToInt32(FMath::Sqrt(static_cast<double>(Count))));
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FVector3d At((Index % Side - Side / 2) * (8000.0 / Side) + (Tick % 64) * 5.0,
+			                   (Index / Side - Side / 2) * (8000.0 / Side), 100);
+			Batch.AddSphereSearch(At, 1500);
+		}
+	}
+
+	static void Run(const FScene& Scene, FBarragePhaseTimings& Timings, double& OutTickP99Ms)
+	{
+		FWorldSimOwner World(1.0f / 128.0f, [](int) {});
+		FRandomStream Random(Seed);
+		AddLevelMesh(World);
+		AddProjectiles(World, Random, Scene.Projectiles);
+		AddProps(World, Random, Scene.Props);
+		TArray<TSharedPtr<FBCharacter>> Characters;
+		AddCharacters(World, Scene.Characters, Characters);
+		FBQueryBatch Searches(FBQueryArena::Capacity);
+		TArray<TransformUpdate> Exported;
+		TArray<double> TickMs;
+		TickMs.Reserve(MeasuredTicks);
+		//timing into a throwaway during warmup keeps the window to measured ticks only.
+		TUniquePtr<FBarragePhaseTimings> Warmup = MakeUnique<FBarragePhaseTimings>();
+
+		for (int32 Tick = 0; Tick < WarmupTicks + MeasuredTicks; ++Tick)
+		{
+			//everyone walks at the middle, so they crowd, same as the character benchmark.
+			for (const TSharedPtr<FBCharacter>& Character : Characters)
+			{
+				const RVec3 At = Character->GetPosition();
+				Character->mLocomotionUpdate = Vec3(-At.GetX(), 0, -At.GetZ()).NormalizedOr(Vec3::sZero()) * 3.0f;
+			}
+			FillSearches(Searches, Scene.Searches, Tick);
+
+			FBarragePhaseTimings& Into = Tick < WarmupTicks ? *Warmup : Timings;
+			const uint64 TickStart = FPlatformTime::Cycles64();
+			if (World.BroadphaseMaintenance.ShouldOptimize(Tick))
+			{
+				FBarragePhaseTimings::FScope Timed(Into, EBarragePhase::Optimize);
+				const uint64 Started = FPlatformTime::Cycles64();
+				World.OptimizeBroadPhase();
+				World.BroadphaseMaintenance.NoteOptimized(Tick, FPlatformTime::Cycles64() - Started);
+			}
+			{
+				FBarragePhaseTimings::FScope Timed(Into, EBarragePhase::Physics);
+				World.StepSimulation();
+			}
+			if (Scene.Characters > 0)
+			{
+				FBarragePhaseTimings::FScope Timed(Into, EBarragePhase::Characters);
+				World.StepCharacters();
+			}
+			{
+				FBarragePhaseTimings::FScope Timed(Into, EBarragePhase::TransformExport);
+				Exported.Reset();
+				World.GatherMovedBodyTransforms(Tick, Exported);
+			}
+			if (Scene.Searches > 0)
+			{
+				FBarragePhaseTimings::FScope Timed(Into, EBarragePhase::Queries);
+				World.RunQueryBatch(Searches);
+			}
+			if (Tick >= WarmupTicks)
+			{
+				TickMs.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - TickStart));
+			}
+		}
+
+		TickMs.Sort();
+		OutTickP99Ms = TickMs.IsEmpty() ? 0 : TickMs[FMath::Clamp(FMath::CeilToInt32(0.99 * TickMs.Num()) - 1, 0, TickMs.Num() - 1)];
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBarrageSceneBenchmark, "Barrage.Benchmark.Scenes",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::PerfFilter)
+
+bool FBarrageSceneBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace BarrageSceneBenchmark;
+	FString Csv = TEXT("scene,phase,samples,p50_us,p95_us,p99_us,max_us\n");
+	for (const FScene& Scene : Scenes)
+	{
+		//heap, not stack. it's a few dozen kilobytes of samples.
+		TUniquePtr<FBarragePhaseTimings> Timings = MakeUnique<FBarragePhaseTimings>();
+		double TickP99Ms = 0;
+		Run(Scene, *Timings, TickP99Ms);
+		for (const EBarragePhase Phase : ReportedPhases)
+		{
+			const FBarragePhaseStats Stats = Timings->GetStats(Phase);
+			if (Stats.Count == 0)
+			{
+				continue;
+			}
+			AddInfo(FString::Printf(TEXT("Barrage: %-16s %-16s n=%4d p50=%6uus p95=%6uus p99=%6uus max=%6uus"),
+				Scene.Name, FBarragePhaseTimings::PhaseName(Phase), Stats.Count, Stats.P50, Stats.P95, Stats.P99, Stats.Max));
+			Csv += FString::Printf(TEXT("%s,%s,%d,%u,%u,%u,%u\n"),
+				Scene.Name, FBarragePhaseTimings::PhaseName(Phase), Stats.Count, Stats.P50, Stats.P95, Stats.P99, Stats.Max);
+		}
+		AddInfo(FString::Printf(TEXT("Barrage: %-16s whole tick p99 %.3fms of %.3fms"), Scene.Name, TickP99Ms, BudgetMs));
+		//a warning rather than a failure. CI boxes vary too much for a hard line, but this is the line to watch.
+		if (TickP99Ms > BudgetMs)
+		{
+			AddWarning(FString::Printf(TEXT("%s: p99 tick %.3fms is over the 128hz budget"), Scene.Name, TickP99Ms));
+		}
+	}
+	const FString CsvPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("BarrageScenes.csv");
+	TestTrue(TEXT("wrote the csv"), FFileHelper::SaveStringToFile(Csv, *CsvPath));
+	return true;
+}
+
+#endif
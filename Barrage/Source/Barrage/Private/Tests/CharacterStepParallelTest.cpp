@@ -0,0 +1,169 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "FWorldSimOwner.h"
+#include "PhysicsCharacter.h"
+
+using namespace JOLT;
+
+namespace BarrageCharacterParallelTest
+{
+	static constexpr int32 Characters = 64;
+	static constexpr int32 Ticks = 128;
+	//a bit over a capsule's width apart, so everyone starts with neighbours.
+	static constexpr double SpacingCm = 80.0;
+	static constexpr double BoxCm = 30.0;
+
+	static bool SameBits(float A, float B)
+	{
+		return FMemory::Memcmp(&A, &B, sizeof(float)) == 0;
+	}
+
+	static bool SameBits(Vec3Arg A, Vec3Arg B)
+	{
+		return SameBits(A.GetX(), B.GetX()) && SameBits(A.GetY(), B.GetY()) && SameBits(A.GetZ(), B.GetZ());
+	}
+
+	static bool SameBits(QuatArg A, QuatArg B)
+	{
+		return SameBits(A.GetXYZ(), B.GetXYZ()) && SameBits(A.GetW(), B.GetW());
+	}
+
+	//a floor, a square of characters, and a loose box in every other gap between them, all made in the same order
+	//every time, so two of these only differ in how their characters get stepped.
+	struct FScene
+	{
+		FWorldSimOwner World{1.0f / 128.0f, [](int) {}};
+		TArray<TSharedPtr<FBCharacter>> Walkers;
+		TArray<BodyID> Boxes;
+		int32 Pushes = 0;
+
+		FScene()
+		{
+			FBBoxParams Floor = FBarrageBounder::GenerateBoxBounds(FVector3d(0, 0, -50), 100000, 100000, 100);
+			TArray<BodyCreationSettings> Settings;
+			Settings.Add(World.MakeBodySettings(Floor, Layers::NON_MOVING));
+
+			const int32 Side = FMath::CeilToInt32(FMath::Sqrt(static_cast<double>(Characters)));
+			for (int32 Index = 0; Index < Characters; Index += 2)
+			{
+				FBBoxParams Box = FBarrageBounder::GenerateBoxBounds(FVector3d(
+					(Index % Side - Side / 2 + 0.5) * SpacingCm, (Index / Side - Side / 2 + 0.5) * SpacingCm, BoxCm / 2), BoxCm, BoxCm, BoxCm);
+				Settings.Add(World.MakeBodySettings(Box, Layers::MOVING, false, true));
+			}
+			TArray<FBarrageKey> Keys;
+			World.CreateAndAddBodies(Settings, Keys);
+			for (int32 Index = 1; Index < Keys.Num(); ++Index)
+			{
+				BodyID Box;
+				if (World.GetBodyIDOrDefault(Keys[Index], Box))
+				{
+					Boxes.Add(Box);
+				}
+			}
+
+			for (int32 Index = 0; Index < Characters; ++Index)
+			{
+				FBCharParams Params = FBarrageBounder::GenerateCharacterBounds(FVector3d(
+					(Index % Side - Side / 2) * SpacingCm, (Index / Side - Side / 2) * SpacingCm, 10), 30, 90, 6.0);
+				const FBarrageKey Key = World.CreatePrimitive(Params, Layers::MOVING);
+				TSharedPtr<FBCharacter> Walker = StaticCastSharedPtr<FBCharacter>(World.CharacterToJoltMapping->Find(Key));
+				if (Walker && Walker->mCharacter)
+				{
+					Walker->mThrottleModel = Quat(1, 1, 1, 1);
+					Walkers.Add(Walker);
+				}
+			}
+		}
+
+		//everyone walks at the middle, so they crowd each other and shove the boxes.
+		void Step(int32 MinPerJob)
+		{
+			for (const TSharedPtr<FBCharacter>& Walker : Walkers)
+			{
+				const RVec3 At = Walker->GetPosition();
+				Walker->mLocomotionUpdate = Vec3(-At.GetX(), 0, -At.GetZ()).NormalizedOr(Vec3::sZero()) * 3.0f;
+			}
+			World.StepSimulation();
+			World.StepCharacters(MinPerJob);
+			for (const TSharedPtr<FBCharacter>& Walker : Walkers)
+			{
+				Pushes += Walker->DeferredPushes.Num();
+			}
+		}
+	};
+}
+
+//steps the same crowd twice, once with every character on the calling thread and once split as finely as the job
+//system will take it, and wants every character and every box it pushed around to agree to the bit, every tick.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBarrageCharacterStepParallelMatchesSerial, "Barrage.Characters.ParallelMatchesSerial",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FBarrageCharacterStepParallelMatchesSerial::RunTest(const FString& Parameters)
+{
+	using namespace BarrageCharacterParallelTest;
+	FScene Serial;
+	FScene Parallel;
+	if (!TestEqual(TEXT("characters created"), Serial.Walkers.Num(), Characters)
+		|| !TestEqual(TEXT("both scenes match"), Parallel.Walkers.Num(), Serial.Walkers.Num())
+		|| !TestEqual(TEXT("boxes match"), Parallel.Boxes.Num(), Serial.Boxes.Num()))
+	{
+		return false;
+	}
+
+	BodyInterface& SerialBodies = Serial.World.physics_system->GetBodyInterface();
+	BodyInterface& ParallelBodies = Parallel.World.physics_system->GetBodyInterface();
+	TArray<RVec3> BoxesAtStart;
+	for (const BodyID& Box : Serial.Boxes)
+	{
+		BoxesAtStart.Add(SerialBodies.GetPosition(Box));
+	}
+
+	int32 Mismatches = 0;
+	for (int32 Tick = 0; Tick < Ticks && Mismatches == 0; ++Tick)
+	{
+		Serial.Step(MAX_int32);
+		Parallel.Step(1);
+		for (int32 Index = 0; Index < Serial.Walkers.Num(); ++Index)
+		{
+			const CharacterVirtual& Ours = *Parallel.Walkers[Index]->mCharacter;
+			const CharacterVirtual& Theirs = *Serial.Walkers[Index]->mCharacter;
+			if (!SameBits(Ours.GetPosition(), Theirs.GetPosition()) || !SameBits(Ours.GetLinearVelocity(), Theirs.GetLinearVelocity()))
+			{
+				++Mismatches;
+				AddError(FString::Printf(TEXT("tick %d, character %d: parallel at (%.9g, %.9g, %.9g), serial at (%.9g, %.9g, %.9g)"),
+					Tick, Index, Ours.GetPosition().GetX(), Ours.GetPosition().GetY(), Ours.GetPosition().GetZ(),
+					Theirs.GetPosition().GetX(), Theirs.GetPosition().GetY(), Theirs.GetPosition().GetZ()));
+				break;
+			}
+		}
+		for (int32 Index = 0; Index < Serial.Boxes.Num() && Mismatches == 0; ++Index)
+		{
+			const BodyID Ours = Parallel.Boxes[Index];
+			const BodyID Theirs = Serial.Boxes[Index];
+			if (!SameBits(ParallelBodies.GetPosition(Ours), SerialBodies.GetPosition(Theirs))
+				|| !SameBits(ParallelBodies.GetRotation(Ours), SerialBodies.GetRotation(Theirs))
+				|| !SameBits(ParallelBodies.GetLinearVelocity(Ours), SerialBodies.GetLinearVelocity(Theirs)))
+			{
+				++Mismatches;
+				AddError(FString::Printf(TEXT("tick %d, box %d: parallel and serial disagree"), Tick, Index));
+			}
+		}
+	}
+
+	//a crowd that never touched a box would agree without the deferred pushes doing anything.
+	float Furthest = 0;
+	for (int32 Index = 0; Index < Serial.Boxes.Num(); ++Index)
+	{
+		const Vec3 Moved = SerialBodies.GetPosition(Serial.Boxes[Index]) - BoxesAtStart[Index];
+		Furthest = FMath::Max(Furthest, Vec3(Moved.GetX(), 0, Moved.GetZ()).Length());
+	}
+	AddInfo(FString::Printf(TEXT("%d pushes deferred, furthest box moved %.3fm."), Serial.Pushes, Furthest));
+	TestEqual(TEXT("pushes deferred, parallel against serial"), Parallel.Pushes, Serial.Pushes);
+	TestTrue(TEXT("characters pushed boxes"), Serial.Pushes > 0 && Furthest > 0.01f);
+	TestEqual(TEXT("ticks where parallel and serial stepping disagree"), Mismatches, 0);
+	return true;
+}
+
+#endif
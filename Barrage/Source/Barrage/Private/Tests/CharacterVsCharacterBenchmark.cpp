@@ -0,0 +1,131 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "FWorldSimOwner.h"
+#include "PhysicsCharacter.h"
+#include "CoordinateUtils.h"
+
+using namespace JOLT;
+
+//headless: UnrealEditor-Cmd <project> -nullrhi -ExecCmds="Automation RunTests Barrage.Benchmark.CharacterVsCharacter; Quit"
+//builds a scratch world with a floor and N characters packed into a square, walks them all at the middle so they crowd,
+//and times the character step (grid rebuild included) per tick. runs each count against the grid, and against jolt's
+//n² CharacterVsCharacterCollisionSimple for comparison.
+namespace BarrageCharacterBenchmark
+{
+	static constexpr int32 WarmupTicks = 32;
+	static constexpr int32 MeasuredTicks = 256;
+	//a bit over a capsule's width apart, so everyone starts with neighbours.
+	static constexpr double SpacingCm = 80.0;
+
+	struct FResult
+	{
+		double MeanMs = 0;
+		double P50Ms = 0;
+		double P99Ms = 0;
+		bool bStayedFinite = true;
+		int32 Created = 0;
+	};
+
+	static double Percentile(const TArray<double>& Sorted, double P)
+	{
+		return Sorted.IsEmpty() ? 0 : Sorted[FMath::Clamp(FMath::FloorToInt32(P * (Sorted.Num() - 1)), 0, Sorted.Num() - 1)];
+	}
+
+	static FResult Run(int32 Count, bool bUseGrid)
+	{
+		FWorldSimOwner World(1.0f / 128.0f, [](int) {});
+		CharacterVsCharacterCollisionSimple Simple;
+
+		FBBoxParams Floor = FBarrageBounder::GenerateBoxBounds(FVector3d(0, 0, -50), 100000, 100000, 100);
+		TArray<BodyCreationSettings> FloorSettings;
+		FloorSettings.Add(World.MakeBodySettings(Floor, Layers::NON_MOVING));
+		TArray<FBarrageKey> FloorKeys;
+		World.CreateAndAddBodies(FloorSettings, FloorKeys);
+
+		//through CreatePrimitive, same as a spawn. the simple variant then swaps each one over to jolt's n² collider
+		//before the grid has ever been rebuilt with it.
+		const int32 Side = FMath::CeilToInt32(FMath::Sqrt(static_cast<double>(Count)));
+		TArray<TSharedPtr<FBCharacter>> Characters;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			FBCharParams Params = FBarrageBounder::GenerateCharacterBounds(FVector3d(
+				(Index % Side - Side / 2) * SpacingCm, (Index / Side - Side / 2) * SpacingCm, 10), 30, 90, 6.0);
+			const FBarrageKey Key = World.CreatePrimitive(Params, Layers::MOVING);
+			TSharedPtr<FBCharacter> Character = StaticCastSharedPtr<FBCharacter>(World.CharacterToJoltMapping->Find(Key));
+			if (!Character || !Character->mCharacter)
+			{
+				continue;
+			}
+			Character->mThrottleModel = Quat(1, 1, 1, 1);
+			if (!bUseGrid)
+			{
+				World.CharacterVsCharacterCollision.Remove(Character->mCharacter);
+				Simple.Add(Character->mCharacter);
+				Character->mCharacter->SetCharacterVsCharacterCollision(&Simple);
+			}
+			Characters.Add(Character);
+		}
+
+		TArray<double> Samples;
+		Samples.Reserve(MeasuredTicks);
+		for (int32 Tick = 0; Tick < WarmupTicks + MeasuredTicks; ++Tick)
+		{
+			for (const TSharedPtr<FBCharacter>& Character : Characters)
+			{
+				const RVec3 At = Character->GetPosition();
+				Character->mLocomotionUpdate = Vec3(-At.GetX(), 0, -At.GetZ()).NormalizedOr(Vec3::sZero()) * 3.0f;
+			}
+			World.StepSimulation();
+			const uint64 Start = FPlatformTime::Cycles64();
+			//jolt's simple collider reads the other characters live, so only the grid can step them in parallel.
+			World.StepCharacters(bUseGrid ? FWorldSimOwner::MinCharactersPerJob : MAX_int32);
+			const uint64 End = FPlatformTime::Cycles64();
+			if (Tick >= WarmupTicks)
+			{
+				Samples.Add(FPlatformTime::ToMilliseconds64(End - Start));
+			}
+		}
+
+		FResult Result;
+		Result.Created = Characters.Num();
+		for (const TSharedPtr<FBCharacter>& Character : Characters)
+		{
+			Result.bStayedFinite &= !Character->GetPosition().IsNaN();
+		}
+		Samples.Sort();
+		double Total = 0;
+		for (double Sample : Samples)
+		{
+			Total += Sample;
+		}
+		Result.MeanMs = Samples.IsEmpty() ? 0 : Total / Samples.Num();
+		Result.P50Ms = Percentile(Samples, 0.5);
+		Result.P99Ms = Percentile(Samples, 0.99);
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBarrageCharacterVsCharacterBenchmark, "Barrage.Benchmark.CharacterVsCharacter",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::PerfFilter)
+
+bool FBarrageCharacterVsCharacterBenchmark::RunTest(const FString& Parameters)
+{
+	for (const int32 Count : {10, 100, 1000})
+	{
+		for (const bool bUseGrid : {true, false})
+		{
+			const BarrageCharacterBenchmark::FResult Result = BarrageCharacterBenchmark::Run(Count, bUseGrid);
+			AddInfo(FString::Printf(TEXT("Barrage: %4d characters, %-6s step per tick mean %.3fms  p50 %.3fms  p99 %.3fms"),
+				Count, bUseGrid ? TEXT("grid") : TEXT("simple"), Result.MeanMs, Result.P50Ms, Result.P99Ms));
+			TestEqual(FString::Printf(TEXT("%d characters all created (%s)"), Count, bUseGrid ? TEXT("grid") : TEXT("simple")),
+				Result.Created, Count);
+			TestTrue(FString::Printf(TEXT("%d characters stay finite (%s)"), Count, bUseGrid ? TEXT("grid") : TEXT("simple")),
+				Result.bStayedFinite);
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,160 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CoordinateUtils.h"
+#include "Math/RandomStream.h"
+#include <cmath>
+
+using namespace JOLT;
+
+namespace BarrageCoordinateUtilsTest
+{
+	static constexpr int32 RandomSamples = 4096;
+
+	struct FElement
+	{
+		FVector3d In = FVector3d::ZeroVector;
+		FVector3f Position = FVector3f::ZeroVector;
+		FQuat4f Rotation = FQuat4f::Identity;
+	};
+
+	static bool SameBits(float A, float B)
+	{
+		return FMemory::Memcmp(&A, &B, sizeof(float)) == 0;
+	}
+
+	//what going into jolt means, written out longhand rather than through anything in CoordinateUtils.
+	static float JoltAxis(double UnrealAxis)
+	{
+		const double Meters = UnrealAxis / 100.0;
+		return static_cast<float>(Meters);
+	}
+
+	//anywhere from denormal up to where a hundred times it still fits, either sign, so every rounding path gets a go.
+	//the single version narrows from double, and narrowing anything bigger is undefined.
+	static float AnyFloat(FRandomStream& Random)
+	{
+		const float Mantissa = Random.FRandRange(1.0f, 2.0f);
+		const float Value = FMath::Pow(2.0f, static_cast<float>(Random.RandRange(-149, 119))) * Mantissa;
+		return Random.RandBool() ? -Value : Value;
+	}
+
+	//same again going the other way, where it's a hundredth that has to fit.
+	static double AnyDouble(FRandomStream& Random)
+	{
+		const double Mantissa = Random.FRandRange(1.0, 2.0);
+		const double Value = FMath::Pow(2.0, static_cast<double>(Random.RandRange(-140, 133))) * Mantissa;
+		return Random.RandBool() ? -Value : Value;
+	}
+
+	static TArray<float> FloatCases(FRandomStream& Random)
+	{
+		TArray<float> Cases = {0.0f, -0.0f, 1.0f, 0.1f, -0.01f, 1e-45f, -1e-40f, 1.17549435e-38f, 3.0e36f, -3.0e36f};
+		for (int32 i = 0; i < RandomSamples; ++i)
+		{
+			Cases.Add(AnyFloat(Random));
+		}
+		return Cases;
+	}
+
+	static TArray<double> DoubleCases(FRandomStream& Random)
+	{
+		//the last few sit on or right next to a halfway point once divided by 100.
+		TArray<double> Cases = {0.0, -0.0, 1.0, 0.1, -12345.678, 1e-43, 1e40, -1e40,
+		                        100.0 * (1.0 + FLT_EPSILON / 2), 100.0 * (1.0 + FLT_EPSILON * 1.5),
+		                        std::nextafter(100.0 * (1.0 + FLT_EPSILON / 2), 0.0)};
+		for (int32 i = 0; i < RandomSamples; ++i)
+		{
+			Cases.Add(AnyDouble(Random));
+		}
+		return Cases;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBarrageCoordinateUtilsBatch, "Barrage.CoordinateUtils.Batch",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FBarrageCoordinateUtilsBatch::RunTest(const FString& Parameters)
+{
+	using namespace BarrageCoordinateUtilsTest;
+	FRandomStream Random(0x0BA77A6E);
+
+	const TArray<float> Floats = FloatCases(Random);
+	TArray<Vec3> JoltPositions;
+	TArray<Quat> JoltRotations;
+	for (int32 i = 0; i < Floats.Num(); ++i)
+	{
+		//rolled through every slot, so each value gets a turn as x, y, z and w.
+		const float A = Floats[i];
+		const float B = Floats[(i + 1) % Floats.Num()];
+		const float C = Floats[(i + 2) % Floats.Num()];
+		const float D = Floats[(i + 3) % Floats.Num()];
+		JoltPositions.Add(Vec3(A, B, C));
+		JoltRotations.Add(Quat(A, B, C, D));
+	}
+	TArray<FElement> Elements;
+	Elements.SetNum(Floats.Num());
+	CoordinateUtils::FromJoltCoordinates<FElement>(JoltPositions, Elements, &FElement::Position);
+	CoordinateUtils::FromJoltRotations<FElement>(JoltRotations, Elements, &FElement::Rotation);
+
+	int32 PositionMismatches = 0;
+	int32 RotationMismatches = 0;
+	for (int32 i = 0; i < Elements.Num(); ++i)
+	{
+		const FVector3f Single = CoordinateUtils::FromJoltCoordinates(JoltPositions[i]);
+		const FVector3f& Batch = Elements[i].Position;
+		if (!SameBits(Single.X, Batch.X) || !SameBits(Single.Y, Batch.Y) || !SameBits(Single.Z, Batch.Z))
+		{
+			if (PositionMismatches++ == 0)
+			{
+				AddError(FString::Printf(TEXT("from jolt position %d: single %s, batch %s"), i, *Single.ToString(), *Batch.ToString()));
+			}
+		}
+		const FQuat4f SingleRotation = CoordinateUtils::FromJoltRotation(JoltRotations[i]);
+		const FQuat4f& BatchRotation = Elements[i].Rotation;
+		if (!SameBits(SingleRotation.X, BatchRotation.X) || !SameBits(SingleRotation.Y, BatchRotation.Y)
+			|| !SameBits(SingleRotation.Z, BatchRotation.Z) || !SameBits(SingleRotation.W, BatchRotation.W))
+		{
+			if (RotationMismatches++ == 0)
+			{
+				AddError(FString::Printf(TEXT("from jolt rotation %d: single %s, batch %s"), i, *SingleRotation.ToString(), *BatchRotation.ToString()));
+			}
+		}
+	}
+	TestEqual(TEXT("batched positions from jolt match the single version bit for bit"), PositionMismatches, 0);
+	TestEqual(TEXT("batched rotations from jolt match the single version bit for bit"), RotationMismatches, 0);
+
+	const TArray<double> Doubles = DoubleCases(Random);
+	TArray<FElement> Ins;
+	Ins.SetNum(Doubles.Num());
+	for (int32 i = 0; i < Doubles.Num(); ++i)
+	{
+		Ins[i].In = FVector3d(Doubles[i], Doubles[(i + 1) % Doubles.Num()], Doubles[(i + 2) % Doubles.Num()]);
+	}
+	TArray<Vec3> ToJolt;
+	ToJolt.SetNum(Ins.Num());
+	CoordinateUtils::ToJoltCoordinates<FElement>(Ins, &FElement::In, ToJolt);
+	int32 ToJoltMismatches = 0;
+	for (int32 i = 0; i < Ins.Num(); ++i)
+	{
+		const FVector3d& In = Ins[i].In;
+		const float X = JoltAxis(In.X);
+		const float Y = JoltAxis(In.Z);
+		const float Z = JoltAxis(In.Y);
+		//and jolt's own vec3 invariant, which the batch writes by hand.
+		const float W = reinterpret_cast<const float*>(&ToJolt[i])[3];
+		if (!SameBits(X, ToJolt[i].GetX()) || !SameBits(Y, ToJolt[i].GetY()) || !SameBits(Z, ToJolt[i].GetZ()) || !SameBits(Z, W))
+		{
+			if (ToJoltMismatches++ == 0)
+			{
+				AddError(FString::Printf(TEXT("to jolt %d: %s gave (%.9g, %.9g, %.9g, %.9g), wanted (%.9g, %.9g, %.9g, %.9g)"),
+					i, *In.ToString(), ToJolt[i].GetX(), ToJolt[i].GetY(), ToJolt[i].GetZ(), W, X, Y, Z, Z));
+			}
+		}
+	}
+	TestEqual(TEXT("batched positions into jolt match dividing in double and rounding once, bit for bit"), ToJoltMismatches, 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "FWorldSimOwner.h"
+#include "MeshShapeCache.h"
+#include "Engine/StaticMesh.h"
+
+using namespace JOLT;
+
+namespace BarrageMeshShapeCacheTest
+{
+	//a closed tetrahedron, lopsided so a flipped winding or a dropped vertex would show up in the bounds.
+	static ShapeRefC MakeMesh()
+	{
+		VertexList Verts;
+		Verts.push_back(Float3(0, 0, 0));
+		Verts.push_back(Float3(2, 0, 0));
+		Verts.push_back(Float3(0, 3, 0));
+		Verts.push_back(Float3(0, 0, 5));
+		IndexedTriangleList Tris;
+		Tris.push_back(IndexedTriangle(0, 2, 1));
+		Tris.push_back(IndexedTriangle(0, 1, 3));
+		Tris.push_back(IndexedTriangle(0, 3, 2));
+		Tris.push_back(IndexedTriangle(1, 2, 3));
+		MeshShapeSettings Settings(Verts, Tris);
+		Shape::ShapeResult Result = Settings.Create();
+		return Result.HasError() ? nullptr : Result.Get();
+	}
+
+	static float FirstHit(const Shape& Mesh, Vec3 From, Vec3 Direction)
+	{
+		RayCastResult Hit;
+		return Mesh.CastRay(RayCast(From, Direction), SubShapeIDCreator(), Hit) ? Hit.mFraction : -1.0f;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBarrageMeshShapeCacheRoundTrip, "Barrage.MeshShapeCache.RoundTrip",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FBarrageMeshShapeCacheRoundTrip::RunTest(const FString& Parameters)
+{
+	using namespace BarrageMeshShapeCacheTest;
+	//only here to hold jolt's type registry open, which restoring a shape needs.
+	FWorldSimOwner Scratch(1.0f / 128.0f, [](int) {});
+
+	const ShapeRefC Original = MakeMesh();
+	if (!TestNotNull(TEXT("jolt cooks the test mesh"), Original.GetPtr()))
+	{
+		return false;
+	}
+	TArray<uint8> Bytes;
+	FBMeshShapeCache::SaveShape(*Original, Bytes);
+	const ShapeRefC Restored = FBMeshShapeCache::LoadShape(Bytes);
+	if (!TestNotNull(TEXT("saved shape loads back"), Restored.GetPtr()))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("same shape subtype"), static_cast<int32>(Restored->GetSubType()), static_cast<int32>(Original->GetSubType()));
+	const AABox OriginalBounds = Original->GetLocalBounds();
+	const AABox RestoredBounds = Restored->GetLocalBounds();
+	TestTrue(TEXT("same bounds"), OriginalBounds.mMin == RestoredBounds.mMin && OriginalBounds.mMax == RestoredBounds.mMax);
+	TestEqual(TEXT("same triangle count"), static_cast<int32>(Restored->GetStats().mNumTriangles), static_cast<int32>(Original->GetStats().mNumTriangles));
+	const Vec3 Rays[][2] = {
+		{Vec3(0.5f, 0.5f, -10), Vec3(0, 0, 20)},
+		{Vec3(-10, 0.5f, 0.5f), Vec3(20, 0, 0)},
+		{Vec3(0.2f, -10, 0.2f), Vec3(0, 20, 0)},
+		{Vec3(5, 5, 5), Vec3(-10, -10, -10)},
+	};
+	for (const Vec3* Ray : Rays)
+	{
+		TestEqual(TEXT("same ray hit"), FirstHit(*Restored, Ray[0], Ray[1]), FirstHit(*Original, Ray[0], Ray[1]));
+	}
+
+	//anything that isn't exactly what we wrote has to read as a miss, never as a half-built shape.
+	TArray<uint8> Truncated = Bytes;
+	Truncated.SetNum(Bytes.Num() / 2);
+	TestNull(TEXT("truncated bytes are a miss"), FBMeshShapeCache::LoadShape(Truncated).GetPtr());
+	TArray<uint8> WrongMagic = Bytes;
+	WrongMagic[0] ^= 0xFF;
+	TestNull(TEXT("wrong magic is a miss"), FBMeshShapeCache::LoadShape(WrongMagic).GetPtr());
+	TestNull(TEXT("nothing is a miss"), FBMeshShapeCache::LoadShape(TArray<uint8>()).GetPtr());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBarrageMeshShapeCacheEviction, "Barrage.MeshShapeCache.Eviction",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FBarrageMeshShapeCacheEviction::RunTest(const FString& Parameters)
+{
+	using namespace BarrageMeshShapeCacheTest;
+	FWorldSimOwner Scratch(1.0f / 128.0f, [](int) {});
+	//only used for its key. the shape comes from the cook below, not from the mesh.
+	const UStaticMesh* Mesh = NewObject<UStaticMesh>();
+	FBMeshShapeCache Cache(false);
+	int32 Cooks = 0;
+	auto Cook = [&Cooks]()
+	{
+		++Cooks;
+		return MakeMesh();
+	};
+
+	ShapeRefC Unit = Cache.FindOrScale(FObjectKey(Mesh), Vec3::sOne(), Cook);
+	ShapeRefC Doubled = Cache.FindOrScale(FObjectKey(Mesh), Vec3::sReplicate(2.0f), Cook);
+	if (!TestNotNull(TEXT("unit scale cooks"), Unit.GetPtr()) || !TestNotNull(TEXT("double scale cooks"), Doubled.GetPtr()))
+	{
+		return false;
+	}
+	TestEqual(TEXT("one cook for both scales"), Cooks, 1);
+	TestTrue(TEXT("unit scale is the same shape again"), Cache.FindOrScale(FObjectKey(Mesh), Vec3::sOne(), Cook) == Unit);
+	//the base, and the one scaled shape. unit scale isn't a second entry.
+	TestEqual(TEXT("two shapes cached"), Cache.Num(), 2);
+	TestEqual(TEXT("nothing trimmed while both are held"), Cache.TrimUnused(), 0);
+
+	Doubled = nullptr;
+	TestEqual(TEXT("the scaled shape goes once it's let go"), Cache.TrimUnused(), 1);
+	TestEqual(TEXT("the base stays while unit scale holds it"), Cache.Num(), 1);
+
+	Unit = nullptr;
+	TestEqual(TEXT("unit scale goes once it's let go"), Cache.TrimUnused(), 1);
+	TestEqual(TEXT("nothing cached"), Cache.Num(), 0);
+	Unit = Cache.FindOrScale(FObjectKey(Mesh), Vec3::sOne(), Cook);
+	TestEqual(TEXT("a trimmed shape cooks again"), Cooks, 2);
+	return true;
+}
+
+#endif
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SkeletonTypes.h"
+#include "BarrageContactEvent.h"
+#include <atomic>
+
+//contact events used to go to every subscriber one at a time, and every subscriber threw most of them away. dense combat
+//spent its contact budget in delegate calls that returned immediately, and overflowed the pump with persisted events
+//nobody was listening to.
+//
+//subscribers now say which layer pairs, key types and event types they want. the router keeps a layer-pair interest
+//table that the contact listener checks before it enqueues anything, so uninteresting contacts never hit the pump.
+//on drain, events are deduplicated per body pair per tick (jolt reports one per manifold) and handed to each matching
+//subscriber as one batch.
+struct FBContactFilter
+{
+	static constexpr uint32 AnyLayer = ~0u;
+	//over EBarrageContactEventType.
+	static constexpr uint8 Added = 1 << static_cast<uint8>(EBarrageContactEventType::ADDED);
+	static constexpr uint8 Persisted = 1 << static_cast<uint8>(EBarrageContactEventType::PERSISTED);
+	//removed events have no bodies left to ask, so they carry no layer. only AnyLayer on both sides sees them.
+	static constexpr uint8 Removed = 1 << static_cast<uint8>(EBarrageContactEventType::REMOVED);
+
+	static constexpr uint32 Layer(Layers::EJoltPhysicsLayer InLayer)
+	{
+		return 1u << InLayer;
+	}
+
+	//an event matches if one body is in LayersA and the other in LayersB.
+	uint32 LayersA = AnyLayer;
+	uint32 LayersB = AnyLayer;
+	//SKELLY infixes for the bodies matched to A and B. SFIX_NONE takes any key. costs a lifecycle lookup per event.
+	uint64 KeyTypeA = SKELLY::SFIX_NONE;
+	uint64 KeyTypeB = SKELLY::SFIX_NONE;
+	uint8 EventTypes = Added;
+};
+
+using FBContactSubscription = int32;
+DECLARE_DELEGATE_OneParam(FOnBarrageContactBatch, TArrayView<const BarrageContactEvent>);
+
+class BARRAGE_API FBarrageContactRouter
+{
+public:
+	static constexpr FBContactSubscription InvalidSubscription = 0;
+
+	//any thread. takes effect from the next contact on. not from inside a delivery, though: that holds the read lock.
+	FBContactSubscription Subscribe(const FBContactFilter& Filter, FOnBarrageContactBatch Deliver);
+	void Unsubscribe(FBContactSubscription Subscription);
+
+	//contact listener, so any jolt job thread. lock free.
+	bool Wants(EBarrageContactEventType Type, uint8 LayerOne, uint8 LayerTwo) const
+	{
+		const uint8 TypeIndex = static_cast<uint8>(Type);
+		if (TypeIndex >= TypeCount)
+		{
+			return false;
+		}
+		return (Interest[TypeIndex][FMath::Min<uint8>(LayerOne, Layers::NUM_LAYERS)].load(std::memory_order_relaxed)
+			& FBContactFilter::Layer(static_cast<Layers::EJoltPhysicsLayer>(FMath::Min<uint8>(LayerTwo, Layers::NUM_LAYERS)))) != 0;
+	}
+
+	//drain side, busy worker only. Stage drops repeats of a pair and type already staged this tick.
+	void Stage(const BarrageContactEvent& Event);
+	//hands every subscriber its matching staged events in one call, then clears the stage.
+	//ResolveKey only gets called when some subscriber filters on key type.
+	void Route(TFunctionRef<FSkeletonKey(FBarrageKey)> ResolveKey);
+
+private:
+	static constexpr int32 TypeCount = 3;
+	static constexpr int32 LayerSlots = Layers::NUM_LAYERS + 1;
+
+	struct FSubscriber
+	{
+		FBContactSubscription Handle = InvalidSubscription;
+		FBContactFilter Filter;
+		FOnBarrageContactBatch Deliver;
+		TArray<BarrageContactEvent> Batch;
+	};
+
+	struct FPairKey
+	{
+		uint64 Low = 0;
+		uint64 High = 0;
+		uint8 Type = 0;
+
+		bool operator==(const FPairKey& Other) const
+		{
+			return Low == Other.Low && High == Other.High && Type == Other.Type;
+		}
+
+		friend uint32 GetTypeHash(const FPairKey& Key)
+		{
+			return HashCombineFast(HashCombineFast(::GetTypeHash(Key.Low), ::GetTypeHash(Key.High)), Key.Type);
+		}
+	};
+
+	//write lock only to change subscribers.
+	void RebuildInterest();
+	static bool SideMatches(uint32 LayerMask, uint64 KeyType, const BarrageContactEntity& Entity, FSkeletonKey Resolved);
+
+	FRWLock SubscriberLock;
+	TArray<FSubscriber> Subscribers;
+	FBContactSubscription NextHandle = 1;
+	//bit j of Interest[type][i] is set if anyone wants that type of contact between layer i and layer j.
+	std::atomic<uint32> Interest[TypeCount][LayerSlots] = {};
+
+	TArray<BarrageContactEvent> Staged;
+	TSet<FPairKey> StagedPairs;
+};
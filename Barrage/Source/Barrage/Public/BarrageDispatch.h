@@ -11,7 +11,15 @@
 #include "FBarragePrimitive.h"
 #include "FBPhysicsInput.h"
 #include "Containers/CircularQueue.h"
+#include "Containers/Queue.h"
 #include "FBShapeParams.h"
+#include "BarrageQueryBatch.h"
+#include "BarrageSearch.h"
+#include "BarragePhaseTimings.h"
+#include "BarrageContactRouter.h"
+#include "BroadphaseMaintenance.h"
+#include "BarrageRollback.h"
+#include "PhysicsInputBatch.h"
 #include "KeyedConcept.h"
 #include "ORDIN.h"
 #include "TransformDispatch.h"
@@ -21,7 +29,7 @@
 #define HERTZ_OF_BARRAGE 128
 #endif
 
-static constexpr uint32 MAX_FOUND_OBJECTS = 1024;
+static constexpr uint32 MAX_FOUND_OBJECTS = FBQueryArena::Capacity;
 
 class BARRAGE_API FBarrageBounder
 {
@@ -75,6 +83,7 @@ public:
 	uint8 ThreadAccTicker = 0;
 	TSharedPtr<TransformUpdatesForGameThread> GameTransformPump;
 	TSharedPtr<TCircularQueue<BarrageContactEvent>> ContactEventPump;
+	TSharedPtr<FBarrageContactRouter> ContactRouter;
 	 //this value indicates you have none.
 	mutable FCriticalSection GrowOnlyAccLock;
 	uint8 WorkerThreadAccTicker = 0;
@@ -92,8 +101,13 @@ public:
 	
 	virtual void SphereCast(double Radius, double Distance, FVector3d CastFrom, FVector3d Direction, TSharedPtr<FHitResult> OutHit, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, uint64_t timestamp = 0);
 	virtual void SphereSearch(FBarrageKey ShapeSource, FVector3d Location, double Radius, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, uint32* OutFoundObjectCount, TArray<uint32>& OutFoundObjects);
+	//no allocation. the span points into this thread's FBQueryArena and is good until this thread searches again.
+	TArrayView<const FBFoundBody> SphereSearch(FVector3d Location, double Radius, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, const FBSearchParams& Params = FBSearchParams()) const;
 
 	virtual void CastRay(FVector3d CastFrom, FVector3d Direction, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, TSharedPtr<FHitResult> OutHit);
+	//fill a batch with sphere casts, searches and rays, then run them all at once. results land in Batch.Results.
+	//reuse the batch across ticks and this stops allocating. see BarrageQueryBatch.h.
+	void RunQueryBatch(FBQueryBatch& Batch) const;
 	
 	//and viola [sic] actually pretty elegant even without type polymorphism by using overloading polymorphism.
 	FBLet CreatePrimitive(FBBoxParams& Definition, FSkeletonKey Outkey, uint16 Layer, bool IsSensor = false, bool forceDynamic = false);
@@ -101,6 +115,14 @@ public:
 	FBLet CreatePrimitive(FBSphereParams& Definition, FSkeletonKey OutKey, uint16 Layer, bool IsSensor = false);
 	FBLet CreatePrimitive(FBCapParams& Definition, FSkeletonKey OutKey, uint16 Layer, bool IsSensor = false, FMassByCategory::BMassCategories MassClass = FMassByCategory::MostEnemies);
 	FBLet CreateProjectile(FBBoxParams& Definition, FSkeletonKey OutKey, uint16_t Layer);
+
+	//Batched creation, for waves and bursts. Every body in the batch is added to the broadphase in one operation instead
+	//of one at a time. Definitions and OutKeys must be the same length. The result is index-aligned with them, and
+	//holds nullptr wherever jolt could not create a body. Characters aren't bodies, so they don't batch.
+	TArray<FBLet> CreatePrimitives(TArray<FBBoxParams>& Definitions, const TArray<FSkeletonKey>& OutKeys, uint16 Layer, bool IsSensor = false, bool forceDynamic = false);
+	TArray<FBLet> CreatePrimitives(TArray<FBSphereParams>& Definitions, const TArray<FSkeletonKey>& OutKeys, uint16 Layer, bool IsSensor = false);
+	TArray<FBLet> CreatePrimitives(TArray<FBCapParams>& Definitions, const TArray<FSkeletonKey>& OutKeys, uint16 Layer, bool IsSensor = false, FMassByCategory::BMassCategories MassClass = FMassByCategory::MostEnemies);
+	TArray<FBLet> CreateProjectiles(TArray<FBBoxParams>& Definitions, const TArray<FSkeletonKey>& OutKeys, uint16 Layer);
 	FBLet LoadComplexStaticMesh(FBTransform& MeshTransform, const UStaticMeshComponent* StaticMeshComponent, FSkeletonKey OutKey) const;
 	FBLet GetShapeRef(FBarrageKey Existing) const;
 	FBLet GetShapeRef(FSkeletonKey Existing) const;
@@ -119,6 +141,12 @@ public:
 		if (FBarragePrimitive::IsNotNull(Target))
 		{
 			Target->tombstone = TombstoneInitialMinimum + TombOffset;
+			//StepWorld used to find these by walking every primitive we own. now they report in.
+			TSharedPtr<TQueue<FBLet, EQueueMode::Mpsc>> HoldOpen = PendingTombs;
+			if (HoldOpen)
+			{
+				HoldOpen->Enqueue(Target);
+			}
 			return Target->tombstone;
 		}
 		return 1;
@@ -131,16 +159,44 @@ public:
 	//StackUp should be called before StepWorld and from the same thread. anything can be done between them.
 	//Returns rather than applies the FBPhysicsInputs that affect Primitives of Types: Character
 	//This list may expand. Failure to handle these will result in catastrophic bugs.
+	//inputs are folded to one per body and type before they're applied. see PhysicsInputBatch.h.
 	void StackUp() const;
 	bool UpdateCharacters(TSharedPtr<TArray<FBPhysicsInput>> CharacterInputs) const;
 	bool UpdateCharacter(FBPhysicsInput& CharacterInput) const;
 	
 	//ONLY call this from a thread OTHER than gamethread, or you will experience untold sorrow.
-	void StepWorld(uint64 Time, uint64_t TickCount);
+	//a replay steps the physics and characters and exports transforms, but sends no contacts, moves no tombs and
+	//never optimizes. see ReplayTick.
+	void StepWorld(uint64 Time, uint64_t TickCount, bool bReplay = false);
+
+	//rollback. see BarrageRollback.h. busy worker only, and nothing at all with barrage.Rollback.Enabled off.
+	void SetRollbackWindow(int32 Ticks) const;
+	//right before StackUp, with what StepWorld's about to get and whatever the caller wants back if it's replayed.
+	void SaveRollbackTick(uint64 TickCount, uint64 Time, uint64 Cookie) const;
+	//puts the world back how it was before TickCount's inputs went in. OutReplay gets every saved tick from there on,
+	//oldest first, and each should go through ReplayTick once the caller has redone what it feeds us for it.
+	//false, and nothing's touched, if that tick's gone or bodies have come or gone since.
+	bool RestoreRollbackTick(uint64 TickCount, TArray<FBRollbackTick>& OutReplay) const;
+	//SaveRollbackTick, StackUp and StepWorld for a restored tick. the other threads' inputs are the ones recorded for
+	//it the first time. the busy worker's own are whatever it's fed since the last StepWorld.
+	void ReplayTick(const FBRollbackTick& Stepped);
 
 	//TODO: oh dear I'm doing the same thing as the TransformQueue... Also probably want to check back on this.
 	bool BroadcastContactEvents() const;
+
+	//per-phase timings for StackUp, StepWorld and BroadcastContactEvents. see barrage.PhaseTimings.Report.
+	mutable FBarragePhaseTimings PhaseTimings;
+	//what's changed in the broadphase since it was last optimized. any thread. see barrage.Broadphase.Report.
+	FBBroadphaseChurn GetBroadphaseChurn() const;
+	//drained, coalesced and dropped physics input counts. any thread. see barrage.Input.Report.
+	FBPhysicsInputStats GetPhysicsInputStats() const;
 	
+	//prefer this to the delegates below. you get only the layer pairs and key types you asked for, once per body pair
+	//per tick, in one batch on the busy worker. see BarrageContactRouter.h.
+	FBContactSubscription SubscribeToContacts(const FBContactFilter& Filter, FOnBarrageContactBatch Deliver) const;
+	void UnsubscribeFromContacts(FBContactSubscription Subscription) const;
+
+	//the old per-event delegates still get everything, so binding any of them turns contact filtering off.
 	FOnBarrageContactAdded OnBarrageContactAddedDelegate;
 	void HandleContactAdded(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold,
 	                        JPH::ContactSettings& ioSettings);
@@ -173,7 +229,21 @@ private:
 	TSharedPtr<KeyToFBLet> JoltBodyLifecycleMapping;
 	
 	TSharedPtr<KeyToKey> TranslationMapping;
+	//tombstoned primitives waiting to be moved into Tombs. any thread can suggest a tombstone, only StepWorld drains.
+	TSharedPtr<TQueue<FBLet, EQueueMode::Mpsc>> PendingTombs;
+	//sampled once a step, before jolt runs, so the contact listener doesn't read the delegates from job threads.
+	std::atomic<bool> bLegacyContactListeners{false};
+	//set while a replay's stepping, so contacts that already went out once don't go out again.
+	std::atomic<bool> bReplaying{false};
+	bool WantsContact(EBarrageContactEventType Type, uint8 LayerOne, uint8 LayerTwo) const;
+	//Replayed is the rollback slot to take the other threads' inputs from instead of their feeds, or null to drain.
+	void StackUpFrom(const FBRollbackRing::FSlot* Replayed) const;
+	//resolves, locks and applies a whole batch in one pass. busy worker only.
+	void ApplyPhysicsInputs(FBPhysicsInputBatch& Batch) const;
+	//reused every step so the export doesn't allocate. only touched from StepWorld.
+	TArray<TransformUpdate> TransformExportScratch;
 	FBLet ManagePointers(FSkeletonKey OutKey, FBarrageKey temp, FBShape form) const;
+	TArray<FBLet> ManagePointers(const TArray<FSkeletonKey>& OutKeys, const TArray<FBarrageKey>& Created, FBShape form) const;
 	uint32 TombOffset = 0; //ticks up by one every world step.
 	//this is a little hard to explain. so keys are inserted as 
 
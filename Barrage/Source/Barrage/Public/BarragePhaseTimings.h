@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+//the busy worker has a 7.8ms budget at 128hz, and insights only helps if someone is looking at the right moment.
+//this keeps the last SampleWindow timings for each phase of the barrage tick, and logs percentiles on request or on a
+//fixed interval, so a headless server or a CI run can tell you where the budget went without a profiler attached.
+//
+//everything except RequestReport is busy worker only, so no locks and no atomics on the hot path.
+enum class EBarragePhase : uint8
+{
+	StackUp,
+	Optimize,
+	Physics,
+	Characters,
+	TransformExport,
+	Tombstones,
+	ContactEvents,
+	//the tick itself never records this one. query batches run off the busy worker, so only the scene harness fills it.
+	Queries,
+	Count
+};
+
+//microseconds, over whatever's still in the window.
+struct FBarragePhaseStats
+{
+	int32 Count = 0;
+	uint32 P50 = 0;
+	uint32 P95 = 0;
+	uint32 P99 = 0;
+	uint32 Max = 0;
+};
+
+class BARRAGE_API FBarragePhaseTimings
+{
+public:
+	//about eight seconds at 128hz.
+	static constexpr int32 SampleWindow = 1024;
+	static constexpr int32 PhaseCount = static_cast<int32>(EBarragePhase::Count);
+
+	FBarragePhaseTimings();
+
+	void Record(EBarragePhase Phase, uint64 Cycles);
+	//any thread. the report happens at the end of the next tick, on the busy worker.
+	void RequestReport()
+	{
+		bReportRequested.store(true, std::memory_order_relaxed);
+	}
+	//call once a tick, after the last phase. logs if asked to, or if barrage.PhaseTimings.LogInterval ticks have passed.
+	void EndTick();
+	void Report() const;
+	FBarragePhaseStats GetStats(EBarragePhase Phase) const;
+	static const TCHAR* PhaseName(EBarragePhase Phase);
+
+	//times its own scope into a phase.
+	class FScope
+	{
+	public:
+		FScope(FBarragePhaseTimings& InTimings, EBarragePhase InPhase)
+			: Timings(InTimings), Phase(InPhase), Start(FPlatformTime::Cycles64())
+		{
+		}
+
+		~FScope()
+		{
+			Timings.Record(Phase, FPlatformTime::Cycles64() - Start);
+		}
+
+	private:
+		FBarragePhaseTimings& Timings;
+		EBarragePhase Phase;
+		uint64 Start;
+	};
+
+private:
+	//microseconds. a uint32 of those is over an hour, which would be its own problem.
+	uint32 Samples[PhaseCount][SampleWindow];
+	uint64 Recorded[PhaseCount];
+	uint64 TicksSinceReport = 0;
+	std::atomic<bool> bReportRequested{false};
+};
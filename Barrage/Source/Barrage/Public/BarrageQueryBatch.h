@@ -0,0 +1,114 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FBarrageKey.h"
+#include "EPhysicsLayer.h"
+#include "IsolatedJoltIncludes.h"
+
+//hundreds of sight checks and sphere cast ticklites a tick were each paying for a shared FHitResult, a collector
+//allocation, and their own trip through the dispatch. a batch is filled in, run in one go across the physics job
+//system, and then read back. keep one around and Reset it each tick, and after the first few ticks it stops allocating.
+enum class EBQueryType : uint8
+{
+	SphereCast,
+	SphereSearch,
+	Ray
+};
+
+//everything here is in UE space. the filters are the ones every caller was building by hand anyway: the default
+//filters for QueryLayer, plus ignoring the caster's own body when IgnoreBody is set.
+struct FBQuery
+{
+	EBQueryType Type = EBQueryType::Ray;
+	FVector3d From = FVector3d::ZeroVector;
+	//sphere casts take a unit direction and a distance. rays take the whole ray as the direction, same as CastRay.
+	FVector3d Direction = FVector3d::ZeroVector;
+	double Radius = 0;
+	double Distance = 0;
+	uint8 QueryLayer = Layers::CAST_QUERY;
+	FBarrageKey IgnoreBody;
+};
+
+struct FBQueryResult
+{
+	bool bHit = false;
+	//same munging as FHitResult::MyItem in the single queries: jolt's index and sequence number.
+	uint32 BodyID = 0;
+	FVector3f Location = FVector3f::ZeroVector;
+	FVector3f Normal = FVector3f::ZeroVector;
+	float Distance = 0;
+	//sphere searches only. a window into FBQueryBatch::Found.
+	int32 FoundStart = 0;
+	int32 FoundCount = 0;
+};
+
+class FBQueryBatch
+{
+public:
+	explicit FBQueryBatch(int32 InMaxFoundPerSearch = 256) : MaxFoundPerSearch(InMaxFoundPerSearch)
+	{
+	}
+
+	void Reset()
+	{
+		Queries.Reset();
+		Results.Reset();
+		Found.Reset();
+	}
+
+	int32 AddSphereCast(const FVector3d& From, const FVector3d& Direction, double Radius, double Distance,
+	                    FBarrageKey IgnoreBody = FBarrageKey(), uint8 QueryLayer = Layers::CAST_QUERY)
+	{
+		FBQuery& Query = Queries.AddDefaulted_GetRef();
+		Query.Type = EBQueryType::SphereCast;
+		Query.From = From;
+		Query.Direction = Direction;
+		Query.Radius = Radius;
+		Query.Distance = Distance;
+		Query.IgnoreBody = IgnoreBody;
+		Query.QueryLayer = QueryLayer;
+		return Queries.Num() - 1;
+	}
+
+	int32 AddSphereSearch(const FVector3d& Location, double Radius,
+	                      FBarrageKey IgnoreBody = FBarrageKey(), uint8 QueryLayer = Layers::CAST_QUERY)
+	{
+		FBQuery& Query = Queries.AddDefaulted_GetRef();
+		Query.Type = EBQueryType::SphereSearch;
+		Query.From = Location;
+		Query.Radius = Radius;
+		Query.IgnoreBody = IgnoreBody;
+		Query.QueryLayer = QueryLayer;
+		return Queries.Num() - 1;
+	}
+
+	int32 AddRay(const FVector3d& From, const FVector3d& Direction,
+	             FBarrageKey IgnoreBody = FBarrageKey(), uint8 QueryLayer = Layers::CAST_QUERY)
+	{
+		FBQuery& Query = Queries.AddDefaulted_GetRef();
+		Query.Type = EBQueryType::Ray;
+		Query.From = From;
+		Query.Direction = Direction;
+		Query.IgnoreBody = IgnoreBody;
+		Query.QueryLayer = QueryLayer;
+		return Queries.Num() - 1;
+	}
+
+	TArrayView<const uint32> GetFound(int32 QueryIndex) const
+	{
+		const FBQueryResult& Result = Results[QueryIndex];
+		return TArrayView<const uint32>(Found.GetData() + Result.FoundStart, Result.FoundCount);
+	}
+
+	TArray<FBQuery> Queries;
+	//index-aligned with Queries once the batch has run.
+	TArray<FBQueryResult> Results;
+	//every sphere search gets MaxFoundPerSearch slots here, so searches never contend while writing.
+	TArray<uint32> Found;
+	int32 MaxFoundPerSearch;
+
+	//RunQueryBatch's jolt-space copies of the inputs and hits. overwritten every run and never shrunk, same as the rest.
+	TArray<JPH::Vec3> JoltFroms;
+	TArray<JPH::Vec3> JoltDirections;
+	TArray<JPH::Vec3> JoltHits;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FBPhysicsInput.h"
+#include "IsolatedJoltIncludes.h"
+
+//late input used to be dropped or applied late, because there was nothing to go back to. with barrage.Rollback.Enabled
+//on, the busy worker saves the whole world right before each tick's inputs go in: jolt's bodies, contacts and
+//constraints, every character, and the inputs the other threads fed that tick. restoring a tick puts all of that back,
+//and the ticks after it can be stepped again with the inputs corrected. off, nothing is saved and none of this costs
+//more than the check.
+//
+//jolt can restore bodies but can't unmake or remake them, so a tick from before any body or character came or went
+//won't restore. the busy worker carries on without the rollback when that happens.
+//
+//busy worker only.
+
+//what a saved tick was stepped with, so it can be stepped again the same way.
+struct FBRollbackTick
+{
+	uint64 Tick = 0;
+	uint64 Time = 0;
+	//whatever the caller saved with it. the busy worker keeps the input index the tick started at.
+	uint64 Cookie = 0;
+};
+
+//jolt's state recorder over a TArray we keep, so a slot stops allocating once it's seen the world at its biggest.
+class BARRAGE_API FBStateStream final : public JPH::StateRecorder
+{
+public:
+	explicit FBStateStream(TArray<uint8>& InBytes) : Bytes(InBytes)
+	{
+	}
+	virtual void WriteBytes(const void* inData, size_t inNumBytes) override
+	{
+		Bytes.Append(static_cast<const uint8*>(inData), static_cast<int32>(inNumBytes));
+	}
+	virtual void ReadBytes(void* outData, size_t inNumBytes) override
+	{
+		if (ReadAt + static_cast<int64>(inNumBytes) > Bytes.Num())
+		{
+			FMemory::Memzero(outData, inNumBytes);
+			bOverran = true;
+			return;
+		}
+		FMemory::Memcpy(outData, Bytes.GetData() + ReadAt, inNumBytes);
+		ReadAt += inNumBytes;
+	}
+	virtual bool IsEOF() const override
+	{
+		return bOverran;
+	}
+	virtual bool IsFailed() const override
+	{
+		return bOverran;
+	}
+	//true if everything written was read back, and no more.
+	bool ReadAll() const
+	{
+		return !bOverran && ReadAt == Bytes.Num();
+	}
+
+private:
+	TArray<uint8>& Bytes;
+	int64 ReadAt = 0;
+	bool bOverran = false;
+};
+
+class BARRAGE_API FBRollbackRing
+{
+public:
+	//barrage.Rollback.Enabled. a relaxed load, and all the hot path pays when it's off.
+	static bool IsEnabled();
+
+	struct FSlot
+	{
+		FBRollbackTick Stepped;
+		//what the world looked like before the tick's inputs went in.
+		TArray<uint8> State;
+		//every body and character that was there, so we can tell if that's still true.
+		uint64 BodiesAddedOrRemoved = 0;
+		TArray<uint64> Characters;
+		//the inputs drained from every feed but the busy worker's own, in drain order. FeedEnds[i] is one past the last
+		//one from feed i. the busy worker's feed isn't kept, since replaying makes those again from the input streams.
+		TArray<FBPhysicsInput> Inputs;
+		TArray<int32> FeedEnds;
+	};
+
+	//how many ticks back we can go. the ring is made the first time it's used after this.
+	void SetWindow(int32 Ticks);
+	int32 GetWindow() const
+	{
+		return Window;
+	}
+	//a slot for Tick, reusing the oldest. if Tick was already saved, which happens while replaying, it's that slot,
+	//with the inputs it was saved with left alone. null if rollback's off, which also lets go of everything saved.
+	FSlot* Open(const FBRollbackTick& Stepped);
+	//the slot Open last gave out, while it's still the one being stepped. null between ticks.
+	FSlot* Current() const
+	{
+		return CurrentSlot;
+	}
+	void Close()
+	{
+		CurrentSlot = nullptr;
+	}
+	FSlot* Find(uint64 Tick);
+	//every saved tick from Tick on, oldest first.
+	void TicksFrom(uint64 Tick, TArray<FBRollbackTick>& Out) const;
+	//forgets every saved tick, and lets go of the memory.
+	void Empty();
+	int32 Num() const
+	{
+		return Count;
+	}
+
+private:
+	int32 IndexOf(int32 Age) const
+	{
+		return (Newest - Age + Slots.Num()) % Slots.Num();
+	}
+
+	TArray<FSlot> Slots;
+	int32 Window = 0;
+	//Newest is the slot the last new tick went in. Count are in use, going back from there.
+	int32 Newest = -1;
+	int32 Count = 0;
+	FSlot* CurrentSlot = nullptr;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//perception and area damage run sphere searches constantly, and each one used to allocate a MAX_FOUND_OBJECTS array
+//for its collector and then copy out of it. searches now land in a fixed buffer that belongs to the calling thread, and
+//come back as a span over it. nothing on the way allocates.
+//
+//the span is only good until the next search on the same thread. copy out anything you want to keep.
+enum class EBSearchMode : uint8
+{
+	//everything in range, up to MaxResults, in whatever order the broadphase found it.
+	All,
+	//the MaxResults closest, closest first.
+	Nearest,
+	//stop at the first body that passes the filters. for "is anyone there" checks.
+	Any
+};
+
+struct FBSearchParams
+{
+	EBSearchMode Mode = EBSearchMode::All;
+	//clamped to FBQueryArena::Capacity.
+	uint32 MaxResults = UINT32_MAX;
+	//bit per jolt object layer. checked on top of the usual layer filters, for when one query layer is too coarse.
+	uint32 LayerMask = ~0u;
+};
+
+struct FBFoundBody
+{
+	//jolt's index and sequence number, same as everywhere else a body id comes back out of barrage.
+	uint32 BodyID;
+	//from the search center to the body's position, in jolt units. only Nearest sorts on it, but it's always set.
+	float SqDistance;
+};
+
+class BARRAGE_API FBQueryArena
+{
+public:
+	static constexpr uint32 Capacity = 1024;
+
+	static FBQueryArena& ForThisThread();
+
+	FBFoundBody Found[Capacity];
+};
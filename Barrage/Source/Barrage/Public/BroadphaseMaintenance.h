@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+//jolt's broadphase degrades as bodies come, go and get teleported, and OptimizeBroadPhase rebuilds it. that rebuild
+//isn't free, and running it every tick was eating a real slice of the busy worker. never running it is worse, since
+//every query slows down. so we count the churn as it happens and only optimize once there's been enough of it,
+//and never more often than every so many ticks. the decision only looks at sim ticks and churn, never the clock, so
+//a slow machine optimizes on the same ticks as a fast one. what a pass cost is kept for the report and nothing else.
+//
+//the Note functions and GetChurn are safe from any thread. the rest is busy worker only.
+struct FBBroadphaseChurn
+{
+	//since the last pass.
+	uint64 Added = 0;
+	uint64 Removed = 0;
+	uint64 Teleported = 0;
+	uint64 Passes = 0;
+	uint64 LastPassTick = 0;
+	//reporting only.
+	double LastPassMs = 0;
+};
+
+class BARRAGE_API FBBroadphaseMaintenance
+{
+public:
+	void NoteAdded(uint64 Count = 1)
+	{
+		Added.fetch_add(Count, std::memory_order_relaxed);
+	}
+	void NoteRemoved(uint64 Count = 1)
+	{
+		Removed.fetch_add(Count, std::memory_order_relaxed);
+	}
+	void NoteTeleported(uint64 Count = 1)
+	{
+		Teleported.fetch_add(Count, std::memory_order_relaxed);
+	}
+
+	//true once churn crosses barrage.Broadphase.ChurnThreshold, or any churn at all has sat for
+	//barrage.Broadphase.MaxIntervalTicks. either way, not within barrage.Broadphase.MinIntervalTicks of the last pass.
+	bool ShouldOptimize(uint64 Tick) const;
+	//call right after optimizing, with the tick and what it cost.
+	void NoteOptimized(uint64 Tick, uint64 Cycles);
+	FBBroadphaseChurn GetChurn() const;
+	//every body ever added or removed. it only goes up, so two reads that match saw the same set of bodies.
+	uint64 GetBodiesAddedOrRemoved() const
+	{
+		return Added.load(std::memory_order_relaxed) + Removed.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<uint64> Added{0};
+	std::atomic<uint64> Removed{0};
+	std::atomic<uint64> Teleported{0};
+	//the counts as of the last pass. subtracting rather than zeroing keeps anything noted mid-pass.
+	//only the busy worker writes these. they're atomic so GetChurn can be called from anywhere.
+	std::atomic<uint64> AddedAtPass{0};
+	std::atomic<uint64> RemovedAtPass{0};
+	std::atomic<uint64> TeleportedAtPass{0};
+	std::atomic<uint64> Passes{0};
+	std::atomic<uint64> LastPassCycles{0};
+	std::atomic<uint64> LastPassTick{0};
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include "IsolatedJoltIncludes.h"
+#include "BarrageSearch.h"
+#include <algorithm>
+
+//one collector for every sphere search mode. it writes into storage the caller hands it, usually this thread's
+//FBQueryArena, and never grows it. Nearest keeps a max heap on distance so a full buffer only takes closer bodies.
+class BoundedBodyCollector : public JPH::CollideShapeBodyCollector
+{
+public:
+	BoundedBodyCollector(const JPH::BodyLockInterface &inBodyLockInterface, const JPH::BodyFilter &inBodyFilter,
+	                     JPH::Vec3Arg inCenter, const FBSearchParams &inParams, FBFoundBody* inFound, uint32 inCapacity)
+		: mBodyLockInterface(inBodyLockInterface), mBodyFilter(inBodyFilter), mCenter(inCenter), mMode(inParams.Mode),
+		  mLayerMask(inParams.LayerMask), mFound(inFound), mCapacity(FMath::Min(inCapacity, inParams.MaxResults))
+	{
+	}
+
+	virtual void AddHit(const ResultType &inResult) override
+	{
+		if (mCapacity == 0 || !mBodyFilter.ShouldCollide(inResult))
+		{
+			return;
+		}
+		JPH::BodyLockRead lock(mBodyLockInterface, inResult);
+		if (!lock.SucceededAndIsInBroadPhase())
+		{
+			return;
+		}
+		const JPH::Body &body = lock.GetBody();
+		if (!(mLayerMask & (1u << body.GetObjectLayer())) || !mBodyFilter.ShouldCollideLocked(body))
+		{
+			return;
+		}
+
+		const FBFoundBody Hit = {inResult.GetIndexAndSequenceNumber(), (body.GetPosition() - mCenter).LengthSq()};
+		if (mMode != EBSearchMode::Nearest)
+		{
+			mFound[BodyCount++] = Hit;
+			if (mMode == EBSearchMode::Any || BodyCount >= mCapacity)
+			{
+				ForceEarlyOut();
+			}
+		}
+		else if (BodyCount < mCapacity)
+		{
+			mFound[BodyCount++] = Hit;
+			std::push_heap(mFound, mFound + BodyCount, CloserFirst);
+		}
+		else if (Hit.SqDistance < mFound[0].SqDistance)
+		{
+			std::pop_heap(mFound, mFound + BodyCount, CloserFirst);
+			mFound[BodyCount - 1] = Hit;
+			std::push_heap(mFound, mFound + BodyCount, CloserFirst);
+		}
+	}
+
+	//call once the query is done. puts Nearest results closest first.
+	void Finish()
+	{
+		if (mMode == EBSearchMode::Nearest)
+		{
+			std::sort_heap(mFound, mFound + BodyCount, CloserFirst);
+		}
+	}
+
+	// Physics data handlers
+	const JPH::BodyLockInterface& mBodyLockInterface;
+	const JPH::BodyFilter& mBodyFilter;
+	JPH::Vec3 mCenter;
+	EBSearchMode mMode;
+	uint32 mLayerMask;
+
+	// Hit results
+	FBFoundBody* mFound;
+	uint32 mCapacity;
+	uint32 BodyCount = 0;
+
+private:
+	static bool CloserFirst(const FBFoundBody& A, const FBFoundBody& B)
+	{
+		return A.SqDistance < B.SqDistance;
+	}
+};
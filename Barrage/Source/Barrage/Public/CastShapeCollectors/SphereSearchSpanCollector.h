@@ -0,0 +1,40 @@
+#pragma once
+#include "IsolatedJoltIncludes.h"
+
+//SphereSearchCollector, but it writes body ids into storage the caller already owns instead of allocating its own.
+//used by query batches, where every search gets a fixed window of the batch's found buffer.
+class SphereSearchSpanCollector : public JPH::CollideShapeBodyCollector
+{
+public:
+	SphereSearchSpanCollector(const JPH::BodyLockInterface &inBodyLockInterface, const JPH::BodyFilter &inBodyFilter, uint32* inFound, uint32 inCapacity)
+		: mBodyLockInterface(inBodyLockInterface), mBodyFilter(inBodyFilter), mFound(inFound), mCapacity(inCapacity)
+	{
+	}
+
+	virtual void AddHit(const ResultType &inResult) override
+	{
+		if (BodyCount >= mCapacity)
+		{
+			ForceEarlyOut();
+			return;
+		}
+		if (mBodyFilter.ShouldCollide(inResult))
+		{
+			JPH::BodyLockRead lock(mBodyLockInterface, inResult);
+			if (lock.SucceededAndIsInBroadPhase() && mBodyFilter.ShouldCollideLocked(lock.GetBody()))
+			{
+				mFound[BodyCount] = inResult.GetIndexAndSequenceNumber();
+				BodyCount++;
+			}
+		}
+	}
+
+	// Physics data handlers
+	const JPH::BodyLockInterface& mBodyLockInterface;
+	const JPH::BodyFilter& mBodyFilter;
+
+	// Hit results
+	uint32* mFound;
+	uint32 mCapacity;
+	uint32 BodyCount = 0;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FBarrageKey.h"
+#include "IsolatedJoltIncludes.h"
+#include "Containers/Queue.h"
+#include <atomic>
+
+class FBCharacterBase;
+typedef TPair<FBarrageKey, TSharedPtr<FBCharacterBase>> FBCharacterEntry;
+
+//characters get spawned and killed from whatever thread gameplay is on, and stepped on the busy worker mid-sim.
+//lookups go through a cuckoo map, same as BarrageToJoltMapping, so nobody takes a registry-wide lock.
+//every character also gets a dense slot index that's stable for its whole life, and the busy worker walks the slots
+//instead of the map.
+//
+//a removed character's slot isn't reused straight away. it stays dead, still holding its ref, until the busy worker
+//reclaims it between ticks, so a step that's already looking at it never has it freed underneath it.
+class BARRAGE_API FBCharacterRegistry
+{
+public:
+	static constexpr uint32 PageSize = 256;
+	static constexpr uint32 MaxPages = 64;
+	static constexpr uint32 InvalidIndex = ~0u;
+
+	FBCharacterRegistry();
+	~FBCharacterRegistry();
+
+	//any thread. returns the character's slot index, or InvalidIndex if the key is taken or we're full.
+	uint32 Add(FBarrageKey Key, TSharedPtr<FBCharacterBase> Character);
+	//any thread. the character stays alive until the reclaim after this.
+	bool Remove(FBarrageKey Key);
+	//any thread.
+	TSharedPtr<FBCharacterBase> Find(FBarrageKey Key) const;
+	uint32 IndexOf(FBarrageKey Key) const;
+	int32 Num() const
+	{
+		return LiveCount.load(std::memory_order_relaxed);
+	}
+
+	//the rest is busy worker only.
+
+	//walks live characters in slot order.
+	template <typename FuncType>
+	void ForEachLive(FuncType&& Func) const
+	{
+		const uint32 End = HighWater.load(std::memory_order_acquire);
+		for (uint32 Index = 0; Index < End; ++Index)
+		{
+			const FSlot* Slot = SlotAt(Index);
+			if (Slot && Slot->State.load(std::memory_order_acquire) == Live)
+			{
+				Func(Index, Slot->Key, Slot->Character);
+			}
+		}
+	}
+	void Snapshot(TArray<FBCharacterEntry>& Out) const;
+
+	//reclaiming is two steps so that whatever else holds raw character pointers (the character grid) can drop them
+	//in between. BeginReclaim takes the characters removed so far; FinishReclaim releases them and frees their slots.
+	void BeginReclaim();
+	void FinishReclaim();
+
+private:
+	enum : uint8
+	{
+		Free,
+		Claimed,
+		Live,
+		Dead
+	};
+
+	struct FSlot
+	{
+		std::atomic<uint8> State{Free};
+		//only written while Claimed, or by the busy worker while reclaiming.
+		FBarrageKey Key;
+		TSharedPtr<FBCharacterBase> Character;
+	};
+
+	struct FRecord
+	{
+		uint32 Index = InvalidIndex;
+		TSharedPtr<FBCharacterBase> Character;
+	};
+
+	FSlot* SlotAt(uint32 Index) const
+	{
+		FSlot* Page = Pages[Index / PageSize].load(std::memory_order_acquire);
+		return Page ? Page + (Index % PageSize) : nullptr;
+	}
+	FSlot* EnsureSlot(uint32 Index);
+	uint32 ClaimSlot();
+
+	libcuckoo::cuckoohash_map<FBarrageKey, FRecord> KeyToRecord;
+	std::atomic<FSlot*> Pages[MaxPages] = {};
+	//one past the highest slot ever claimed, so walks stop early.
+	std::atomic<uint32> HighWater{0};
+	//no free slot below this. only a hint; claiming still CASes.
+	std::atomic<uint32> FirstMaybeFree{0};
+	//slots that aren't Free, counting ones reserved by a claim still looking for theirs. a claim that can't reserve
+	//fails without walking anything.
+	std::atomic<uint32> Occupied{0};
+	std::atomic<int32> LiveCount{0};
+	TQueue<uint32, EQueueMode::Mpsc> Removed;
+	TArray<uint32> Reclaiming;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IsolatedJoltIncludes.h"
+
+//Jolt ships CharacterVsCharacterCollisionSimple, which tests every character against every other character.
+//That's fine for a few players, but we run hundreds of enemies as virtual characters, and n² gets ugly fast.
+//This buckets characters into a uniform grid once per tick, and a query only looks at the cells its bounds overlap.
+//
+//Rebuild happens on the busy worker before characters step. It also takes a frozen copy of every character, and the
+//narrow phase hands jolt the copy rather than the character. jolt keeps reading whatever it was handed for the rest of
+//the step (velocity, transform, padding), so a step only ever sees the others as they were at the rebuild, never
+//half way through their own step. That's what lets characters step in parallel and still agree. The copies share
+//their character's ID, so contacts sort and persist exactly as they would against the real thing.
+//Characters move during the step, so insertion bounds are padded by MoveMargin. Anything that moves further than that
+//in a tick (teleports, mostly) is caught at the next rebuild.
+class BARRAGE_API FBCharacterVsCharacterGrid : public JPH::CharacterVsCharacterCollision
+{
+public:
+	//sizes are in jolt units (meters). the default cell fits a couple of standing characters.
+	explicit FBCharacterVsCharacterGrid(float InCellSize = 2.0f, float InMoveMargin = 0.5f);
+
+	//membership changes are safe from any thread and take effect at the next Rebuild.
+	//the character must stay alive until the Rebuild after it is removed.
+	void Add(JPH::CharacterVirtual* Character);
+	void Remove(const JPH::CharacterVirtual* Character);
+
+	//busy worker only. call once per tick, before any character steps, and not while one is.
+	void Rebuild();
+	int32 NumInGrid() const
+	{
+		return Snapshot.Num();
+	}
+
+	virtual void CollideCharacter(const JPH::CharacterVirtual* inCharacter, JPH::RMat44Arg inCenterOfMassTransform,
+	                              const JPH::CollideShapeSettings& inCollideShapeSettings, JPH::RVec3Arg inBaseOffset,
+	                              JPH::CollideShapeCollector& ioCollector) const override;
+	virtual void CastCharacter(const JPH::CharacterVirtual* inCharacter, JPH::RMat44Arg inCenterOfMassTransform,
+	                           JPH::Vec3Arg inDirection, const JPH::ShapeCastSettings& inShapeCastSettings,
+	                           JPH::RVec3Arg inBaseOffset, JPH::CastShapeCollector& ioCollector) const override;
+
+private:
+	struct FCellRange
+	{
+		int32 MinX, MinY, MinZ;
+		int32 MaxX, MaxY, MaxZ;
+	};
+
+	//a long cast can cover a silly number of cells. past this, walking the snapshot is cheaper than walking the grid.
+	static constexpr int64 MaxCellsPerQuery = 512;
+
+	FCellRange ToCellRange(const JPH::AABox& Bounds) const;
+	static uint64 CellKey(int32 X, int32 Y, int32 Z);
+	static JPH::Ref<JPH::CharacterVirtual> MakeFrozen(const JPH::CharacterVirtual* Character);
+
+	//calls Visit(Index) once for every other character whose grid cells overlap QueryBounds.
+	template <typename VisitorType>
+	void ForEachCandidate(const JPH::CharacterVirtual* Self, const JPH::AABox& QueryBounds, VisitorType&& Visit) const;
+
+	float CellSize;
+	float InverseCellSize;
+	float MoveMargin;
+
+	FCriticalSection MembershipLock;
+	TArray<JPH::CharacterVirtual*> Characters;
+
+	//everything below is rebuilt by Rebuild and read-only until the next one.
+	TArray<JPH::CharacterVirtual*> Snapshot;
+	//index-aligned with Snapshot.
+	TArray<JPH::CharacterVirtual*> Frozen;
+	TArray<FCellRange> SnapshotRanges;
+	//sorted by cell key, so a cell's occupants are contiguous and found with a binary search.
+	TArray<TPair<uint64, int32>> Cells;
+	//the copies themselves, by character ID, kept from one rebuild to the next. two maps so the swap doesn't allocate.
+	TMap<uint32, JPH::Ref<JPH::CharacterVirtual>> FrozenById;
+	TMap<uint32, JPH::Ref<JPH::CharacterVirtual>> FrozenByIdNext;
+};
@@ -75,4 +75,69 @@ public:
 {
 		return FQuat4f(-In.GetX(), -In.GetZ(), -In.GetY(), In.GetW());
 }
+
+	//batch forms. the member pointer overloads read or write one field of each element, so AoS data doesn't need a
+	//staging array. each element's swap and scale is one vector op rather than three scalar ones, and still lands on
+	//the same bits as the single versions. coming out of jolt, a float times 100 is exact in double, so rounding it to
+	//float once gives what the float multiply gives. going in, the divide happens in double lanes, which is correctly
+	//rounded same as the scalar divide, then each lane narrows once to nearest same as the scalar cast. that's UE's
+	//narrowing, not jolt's DVec3 to Vec3, which rounds to odd on NEON. Barrage.CoordinateUtils.Batch holds all of them
+	//to an independent scalar reference.
+	static inline void FromJoltCoordinates(JPH::Vec3Arg In, FVector3f& Out)
+	{
+		(In.Swizzle<JPH::SWIZZLE_X, JPH::SWIZZLE_Z, JPH::SWIZZLE_Y>() * 100.0f).StoreFloat3(reinterpret_cast<JPH::Float3*>(&Out));
+	}
+
+	static inline void FromJoltRotation(JPH::QuatArg In, FQuat4f& Out)
+	{
+		const JPH::Vec4 Flipped = In.GetXYZW().Swizzle<JPH::SWIZZLE_X, JPH::SWIZZLE_Z, JPH::SWIZZLE_Y, JPH::SWIZZLE_W>() * JPH::Vec4(-1.0f, -1.0f, -1.0f, 1.0f);
+		Flipped.StoreFloat4(reinterpret_cast<JPH::Float4*>(&Out));
+	}
+
+	//jolt wants a vec3's w to match its z, so z goes in twice.
+	static inline void ToJoltCoordinates(const FVector3d& In, JPH::Vec3& Out)
+	{
+		const VectorRegister4Double Swapped = VectorSwizzle(VectorLoadFloat3(&In.X), 0, 2, 1, 1);
+		const VectorRegister4Double Scaled = VectorDivide(Swapped, MakeVectorRegisterDouble(100.0, 100.0, 100.0, 100.0));
+		VectorStoreAligned(MakeVectorRegisterFloatFromDouble(Scaled), reinterpret_cast<float*>(&Out));
+	}
+
+	template <typename ElementType>
+	static void FromJoltCoordinates(TArrayView<const JPH::Vec3> In, TArrayView<ElementType> Out, FVector3f ElementType::* Field)
+	{
+		check(In.Num() == Out.Num());
+		for (int32 i = 0; i < In.Num(); ++i)
+		{
+			FromJoltCoordinates(In[i], Out[i].*Field);
+		}
+	}
+
+	template <typename ElementType>
+	static void FromJoltRotations(TArrayView<const JPH::Quat> In, TArrayView<ElementType> Out, FQuat4f ElementType::* Field)
+	{
+		check(In.Num() == Out.Num());
+		for (int32 i = 0; i < In.Num(); ++i)
+		{
+			FromJoltRotation(In[i], Out[i].*Field);
+		}
+	}
+
+	template <typename ElementType>
+	static void ToJoltCoordinates(TArrayView<const ElementType> In, FVector3d ElementType::* Field, TArrayView<JPH::Vec3> Out)
+	{
+		check(In.Num() == Out.Num());
+		for (int32 i = 0; i < In.Num(); ++i)
+		{
+			ToJoltCoordinates(In[i].*Field, Out[i]);
+		}
+	}
+
+	static void FromJoltCoordinates(TArrayView<const JPH::Vec3> In, TArrayView<FVector3f> Out)
+	{
+		check(In.Num() == Out.Num());
+		for (int32 i = 0; i < In.Num(); ++i)
+		{
+			FromJoltCoordinates(In[i], Out[i]);
+		}
+	}
 };
@@ -14,6 +14,14 @@
 #include "SkeletonTypes.h"
 #include "EPhysicsLayer.h"
 #include "IsolatedJoltIncludes.h"
+#include "CharacterVsCharacterGrid.h"
+#include "CharacterRegistry.h"
+#include "MeshShapeCache.h"
+#include "PrimitiveShapeCache.h"
+#include "BroadphaseMaintenance.h"
+#include "PhysicsInputBatch.h"
+#include "BarrageQueryBatch.h"
+#include "BarrageRollback.h"
 
 // All Jolt symbols are in the JPH namespace
 
@@ -42,7 +50,8 @@ static bool AssertFailedImpl(const char* inExpression, const char* inMessage, co
 
 #endif // JPH_ENABLE_ASSERTS
 
-class FBCharacterBase
+//also the character's contact listener, which is how it holds off pushing bodies until StepCharacters says so.
+class FBCharacterBase : public JPH::CharacterContactListener
 {
 public:
 	virtual ~FBCharacterBase() = default;
@@ -62,16 +71,87 @@ public:
 	JPH::Quat mCapsuleRotationUpdate = JPH::Quat::sIdentity();
 	JPH::Ref<JPH::CharacterVirtual> mCharacter = JPH::Ref<JPH::CharacterVirtual>();
 	float mDeltaTime = 0.01; //set this yourself or have a bad time.
+	//set before the character is registered and never after. what characters push on is applied in this order, so every
+	//peer agrees on it.
+	FSkeletonKey OutKey;
 
 	// Calculated effective velocity after a step
 	JPH::Vec3 mEffectiveVelocity = JPH::Vec3::sZero();
 	virtual void IngestUpdate(FBPhysicsInput& input) = 0;
 	virtual void StepCharacter() = 0;
+
+	//for rollback. jolt's SaveState doesn't know about virtual characters, and what's been ingested but not stepped
+	//yet is ours, so both go in.
+	void SaveState(JPH::StateRecorder& Stream) const
+	{
+		Stream.Write(mThrottleModel);
+		Stream.Write(mLocomotionUpdate);
+		Stream.Write(mForcesUpdate);
+		Stream.Write(mGravity);
+		Stream.Write(mCapsuleRotationUpdate);
+		Stream.Write(mEffectiveVelocity);
+		if (mCharacter)
+		{
+			mCharacter->SaveState(Stream);
+		}
+	}
+	void RestoreState(JPH::StateRecorder& Stream)
+	{
+		Stream.Read(mThrottleModel);
+		Stream.Read(mLocomotionUpdate);
+		Stream.Read(mForcesUpdate);
+		Stream.Read(mGravity);
+		Stream.Read(mCapsuleRotationUpdate);
+		Stream.Read(mEffectiveVelocity);
+		if (mCharacter)
+		{
+			mCharacter->RestoreState(Stream);
+		}
+	}
+
+	//a body this step would have pushed, and how fast we were going when we hit it. see StepCharacters.
+	struct FDeferredPush
+	{
+		JPH::BodyID Body;
+		JPH::RVec3 Position;
+		//as the listener gets it, pointing into the body.
+		JPH::Vec3 Normal;
+		JPH::Vec3 CharacterVelocity;
+	};
+	TArray<FDeferredPush> DeferredPushes;
+	//what standing on the ground pushes it down by this step. invalid body if nothing.
+	JPH::BodyID DeferredGroundBody;
+	JPH::RVec3 DeferredGroundPosition = JPH::RVec3::sZero();
+	JPH::Vec3 DeferredGroundImpulse = JPH::Vec3::sZero();
+
+	virtual void OnContactAdded(const JPH::CharacterVirtual* inCharacter, const JPH::BodyID& inBodyID2, const JPH::SubShapeID& inSubShapeID2,
+	                            JPH::RVec3Arg inContactPosition, JPH::Vec3Arg inContactNormal, JPH::CharacterContactSettings& ioSettings) override
+	{
+		DeferPush(inCharacter, inBodyID2, inContactPosition, inContactNormal, ioSettings);
+	}
+	virtual void OnContactPersisted(const JPH::CharacterVirtual* inCharacter, const JPH::BodyID& inBodyID2, const JPH::SubShapeID& inSubShapeID2,
+	                                JPH::RVec3Arg inContactPosition, JPH::Vec3Arg inContactNormal, JPH::CharacterContactSettings& ioSettings) override
+	{
+		DeferPush(inCharacter, inBodyID2, inContactPosition, inContactNormal, ioSettings);
+	}
 	
 	TSharedPtr<JPH::PhysicsSystem, ESPMode::ThreadSafe> World;
 protected:
 	friend class FWorldSimOwner;
 	TWeakPtr<FWorldSimOwner> Machine;
+
+private:
+	//jolt would push the body right here, mid-step, and two characters stepping at once could push the same one.
+	//being pushed is left alone: bodies don't move while characters step, and other characters are frozen copies.
+	void DeferPush(const JPH::CharacterVirtual* Character, const JPH::BodyID& Body, JPH::RVec3Arg Position, JPH::Vec3Arg Normal,
+	               JPH::CharacterContactSettings& ioSettings)
+	{
+		if (ioSettings.mCanReceiveImpulses)
+		{
+			ioSettings.mCanReceiveImpulses = false;
+			DeferredPushes.Add({Body, Position, Normal, Character->GetLinearVelocity()});
+		}
+	}
 };
 
 class BARRAGE_API FWorldSimOwner
@@ -83,12 +163,19 @@ class BARRAGE_API FWorldSimOwner
 	
 public:
 	mutable bool Optimized = false;
+	//counts what's been added, removed and teleported, so StepWorld only optimizes the broadphase when it's worth it.
+	FBBroadphaseMaintenance BroadphaseMaintenance;
+	//counts and polices what happens when an input feed fills up. see EnqueueInput.
+	FBPhysicsInputPressure InputPressure;
+	//StackUp's scratch. busy worker only.
+	FBPhysicsInputBatch InputBatch;
 	//members are destructed first in, last out.
 	//https://stackoverflow.com/questions/2254263/order-of-member-constructor-and-destructor-calls
 	//BodyId is actually a freaking 4byte struct, so it's _worse_ potentially to have a pointer to it than just copy it.
 	TSharedPtr<KeyToBody> BarrageToJoltMapping;
-	TSharedPtr<BoundsToShape> BoxCache;
-	TSharedPtr<TMap<FBarrageKey, TSharedPtr<FBCharacterBase>>> CharacterToJoltMapping;
+	TSharedPtr<FBPrimitiveShapeCache> PrimitiveShapeCache;
+	TSharedPtr<FBMeshShapeCache> MeshShapeCache;
+	TSharedPtr<FBCharacterRegistry> CharacterToJoltMapping;
 
 	/**
 	 * 
@@ -108,9 +195,9 @@ public:
 	TSharedPtr<JPH::TempAllocatorImpl> Allocator;
 	// List of active characters in the scene so they can collide
 	//https://github.com/jrouwe/JoltPhysics/blob/e3ed3b1d33f3a0e7195fbac8b45b30f0a5c8a55b/Jolt/Physics/Character/CharacterVirtual.h#L143
-	//note this is the only extant character collision handler, and it is not very efficient since it doesn't use a BSP.
-	//This will need to go as soon as we have more than three characters or so.
-	JPH::CharacterVsCharacterCollisionSimple CharacterVsCharacterCollisionSimple;
+	//jolt's CharacterVsCharacterCollisionSimple is n², so we bucket characters into a grid instead.
+	//rebuilt once a tick, before characters step.
+	FBCharacterVsCharacterGrid CharacterVsCharacterCollision;
 	// Each broadphase layer results in a separate bounding volume tree in the broad phase. You at least want to have
 	// a layer for non-moving and moving objects to avoid having to update a tree full of static objects every frame.
 	// You can have a 1-on-1 mapping between object layers and broadphase layers (like in this case) but if you have
@@ -256,6 +343,13 @@ public:
 	using FBInputFeed = FeedMap<FBPhysicsInput>;
 	FBOutputFeed WorkerAcc[ALLOWED_THREADS_FOR_BARRAGE_PHYSICS];
 	FBInputFeed ThreadAcc[ALLOWED_THREADS_FOR_BARRAGE_PHYSICS];
+	//every physics input should go in through here, so a full feed gets counted instead of silently eating it.
+	//false if it was dropped.
+	bool EnqueueInput(uint32 ThreadIndex, const FBPhysicsInput& Input)
+	{
+		const TSharedPtr<FBInputFeed::ThreadFeed, ESPMode::ThreadSafe> HoldOpen = ThreadAcc[ThreadIndex].Queue;
+		return HoldOpen && InputPressure.Enqueue(*HoldOpen, Input);
+	}
 
 	TSharedPtr<JPH::JobSystemThreadPool> job_system;
 	// Create mapping table from object layer to broadphase layer
@@ -328,20 +422,44 @@ public:
 		const JPH::BodyFilter& BodiesFilter,
 		uint32* OutFoundObjectCount,
 		TArray<uint32>& OutFoundObjectIDs) const;
+	TArrayView<const FBFoundBody> SphereSearch(
+		const FVector3d& Location,
+		double Radius,
+		const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+		const JPH::ObjectLayerFilter& ObjectFilter,
+		const JPH::BodyFilter& BodiesFilter,
+		const FBSearchParams& Params) const;
 
 	// Cast a ray at something and get the first thing it hits
 	void CastRay(FVector3d CastFrom, FVector3d Direction, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, TSharedPtr<FHitResult> OutHit) const;
 
-	JPH::Ref<JPH::Shape> AttemptBoxCache(double JoltX, double JoltY, double JoltZ, float HEReduceMin);
+	//runs every query in the batch across the job system and fills Batch.Results. safe from any thread but jolt's own
+	//workers. the calling thread holds BroadPhaseLock for reading across the whole batch, so every query sees one step.
+	void RunQueryBatch(FBQueryBatch& Batch) const;
+	static constexpr int32 MinQueriesPerJob = 32;
+	//a character step is a few sweeps and a solve, so it doesn't take many to be worth a job.
+	static constexpr int32 MinCharactersPerJob = 4;
+	//taken for writing by anything that moves or rebuilds the broadphase wholesale: the step, optimize, and batch adds.
+	//single bodies coming and going only need jolt's own query locks, so they don't bother.
+	mutable FRWLock BroadPhaseLock;
+
 	//we could use type indirection or inheritance, but the fact of the matter is that this is much easier
 	//to understand and vastly vastly faster. it's also easier to optimize out allocations, and it's very
 	//very easy to read for people who are probably already drowning in new types.
 	//finally, it allows FBShapeParams to be a POD and so we can reason about it really easily.
 	FBarrageKey CreatePrimitive(FBBoxParams& ToCreate, uint16 Layer, bool IsSensor = false, bool forceDynamic = false);
-	FBarrageKey CreatePrimitive(FBCharParams& ToCreate, uint16 Layer);
+	FBarrageKey CreatePrimitive(FBCharParams& ToCreate, uint16 Layer, FSkeletonKey OutKey = FSkeletonKey());
 	FBarrageKey CreatePrimitive(FBSphereParams& ToCreate, uint16 Layer, bool IsSensor = false);
 	FBarrageKey CreatePrimitive(FBCapParams& ToCreate, uint16 Layer, bool IsSensor = false, FMassByCategory::BMassCategories MassClass = FMassByCategory::BMassCategories::MostEnemies);
 
+	//the settings each CreatePrimitive builds, exposed so that batches can be assembled from the same definitions.
+	JPH::BodyCreationSettings MakeBodySettings(FBBoxParams& ToCreate, uint16 Layer, bool IsSensor = false, bool forceDynamic = false);
+	JPH::BodyCreationSettings MakeBodySettings(FBSphereParams& ToCreate, uint16 Layer, bool IsSensor = false);
+	JPH::BodyCreationSettings MakeBodySettings(FBCapParams& ToCreate, uint16 Layer, bool IsSensor = false, FMassByCategory::BMassCategories MassClass = FMassByCategory::BMassCategories::MostEnemies);
+	//creates every body, then adds them all to the broadphase in one prepare/finalize. OutKeys is index-aligned with
+	//Settings, and holds the invalid key (0) wherever jolt ran out of bodies.
+	void CreateAndAddBodies(const TArray<JPH::BodyCreationSettings>& Settings, TArray<FBarrageKey>& OutKeys);
+
 	FBLet LoadComplexStaticMesh(FBTransform& MeshTransform, const UStaticMeshComponent* StaticMeshComponent, FSkeletonKey Outkey);
 
 	//This'll be trouble.
@@ -353,8 +471,73 @@ public:
 	//Generally, as we add and remove objects, we'll want to perform this, but we really don't want to run it every tick. We can either use trigger logic or a cadenced ticklite
 	bool OptimizeBroadPhase();
 
+	//splits [0, Count) into runs of at least MinPerJob and hands them to the physics job system, then waits.
+	//the calling thread works through the runs too. small counts, or a job system that's out of barriers, run inline.
+	template <typename BodyType>
+	void ForEachBatched(const char* JobName, int32 Count, int32 MinPerJob, BodyType&& Body) const
+	{
+		TSharedPtr<JPH::JobSystemThreadPool> JobHoldOpen = job_system;
+		const int32 PerJob = JobHoldOpen
+			? FMath::Max(MinPerJob, FMath::DivideAndRoundUp(Count, JobHoldOpen->GetMaxConcurrency() * 2))
+			: Count;
+		JPH::JobSystem::Barrier* Barrier = Count > PerJob ? JobHoldOpen->CreateBarrier() : nullptr;
+		if (Barrier == nullptr)
+		{
+			if (Count > 0)
+			{
+				Body(0, Count);
+			}
+			return;
+		}
+		for (int32 Start = 0; Start < Count; Start += PerJob)
+		{
+			const int32 End = FMath::Min(Start + PerJob, Count);
+			JPH::JobHandle Run = JobHoldOpen->CreateJob(JobName, JPH::Color::sGreen, [&Body, Start, End]()
+			{
+				Body(Start, End);
+			});
+			Barrier->AddJob(Run);
+		}
+		JobHoldOpen->WaitForJobs(Barrier);
+		JobHoldOpen->DestroyBarrier(Barrier);
+	}
+
+	//steps every character across the job system, then applies what they pushed on, serially and in skeleton key
+	//order. a step only sees the other characters as the grid froze them and pushes nothing itself, so how the steps
+	//are split up can't change the answer. the pushes are what's order dependent. registry order is slot order, and
+	//slots go to whichever spawn wins the race for them, so it can't be trusted for this.
+	//MinPerJob past the character count steps them all on the calling thread, which gives the same result.
+	//busy worker only. returns the characters it stepped, which stays valid until the next call.
+	const TArray<FBCharacterEntry>& StepCharacters(int32 MinPerJob = MinCharactersPerJob);
+	TArray<FBCharacterEntry> CharacterStepScratch;
+
+	//see BarrageRollback.h. the ring, and what's below, are busy worker only.
+	FBRollbackRing Rollback;
+	//saves the world as it is now under Stepped.Tick, if barrage.Rollback.Enabled. call before the tick's inputs go in.
+	//returns the slot, which StackUp keeps the other threads' inputs in. null if rollback's off.
+	FBRollbackRing::FSlot* SaveTick(const FBRollbackTick& Stepped);
+	//puts the world back as it was when Tick was saved, and lists every saved tick from there on in OutReplay, oldest
+	//first. false, having touched nothing, if Tick isn't saved or any body or character has come or gone since.
+	bool RestoreTick(uint64 Tick, TArray<FBRollbackTick>& OutReplay);
+	TArray<FBCharacterEntry> RollbackCharacterScratch;
+
 	void FinalizeReleasePrimitive(FBarrageKey BarrageKey)
 	{
+		//characters own their inner body through the CharacterVirtual, so we must not destroy it here as well.
+		//the character itself lives until the busy worker reclaims it at the start of a step.
+		//out of the grid before it's out of the registry, or a reclaim could free it while the grid still has it.
+		TSharedPtr<FBCharacterRegistry> HoldOpenCharacters = CharacterToJoltMapping;
+		TSharedPtr<FBCharacterBase> Character = HoldOpenCharacters ? HoldOpenCharacters->Find(BarrageKey) : nullptr;
+		if (Character)
+		{
+			if (Character->mCharacter)
+			{
+				CharacterVsCharacterCollision.Remove(Character->mCharacter);
+			}
+			HoldOpenCharacters->Remove(BarrageKey);
+			BarrageToJoltMapping->erase(BarrageKey);
+			return;
+		}
 		//TODO return owned Joltstuff to pool or dealloc
 		JPH::BodyID result;
 		auto bID = BarrageToJoltMapping->find(BarrageKey, result);
@@ -363,11 +546,32 @@ public:
 		{
 			body_interface->RemoveBody(result);
 			body_interface->DestroyBody(result);
+			BroadphaseMaintenance.NoteRemoved();
 		}
 		BarrageToJoltMapping->erase(BarrageKey);
 	}
 	FBarrageKey GenerateBarrageKeyFromBodyId(const JPH::BodyID& Input) const;
 	FBarrageKey GenerateBarrageKeyFromBodyId(const uint32 RawIndexAndSequenceNumberInput) const;
+	//characters have no body of their own to key off, so they're numbered instead. any thread.
+	FBarrageKey GenerateCharacterKey();
+	std::atomic<uint32> NextCharacterSerial{0};
+
+	//Jolt already knows which bodies the solver moved, so transform export reads its active list instead of walking
+	//every body we own. Bodies shoved around by StackUp (teleports, rotations on kinematics) may never go active, so
+	//StackUp marks them here as well. All of this is only touched from the busy worker, same as StackUp and StepWorld.
+	JPH::BodyIDVector ActiveBodiesScratch;
+	TArray<JPH::Vec3> ExportPositionsScratch;
+	TArray<JPH::Quat> ExportRotationsScratch;
+	TArray<JPH::BodyID> ChangedBodiesThisTick;
+	void MarkBodyChanged(const JPH::BodyID& Changed)
+	{
+		ChangedBodiesThisTick.Add(Changed);
+	}
+	//the skeleton key rides along in the jolt body's user data, so export never has to touch the cuckoo maps.
+	//binding the invalid key hides a body from export, which is what we do when it gets tombstoned.
+	void BindSkeletonKey(FBarrageKey Key, FSkeletonKey OutKey);
+	//appends one update per moved rigid body. returns how many it appended.
+	uint32 GatherMovedBodyTransforms(uint64 Time, TArray<TransformUpdate>& OutUpdates);
 	~FWorldSimOwner();
 	bool UpdateCharacter(FBPhysicsInput& Update);
 	bool UpdateCharacters(TSharedPtr<TArray<FBPhysicsInput>> Array);
@@ -14,6 +14,8 @@ PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 #include "Jolt/Core/Factory.h"
 #include "Jolt/Core/TempAllocator.h"
 #include "Jolt/Core/JobSystemThreadPool.h"
+#include "Jolt/Core/StreamIn.h"
+#include "Jolt/Core/StreamOut.h"
 #include "Jolt/Physics/PhysicsSettings.h"
 #include "Jolt/Physics/Collision/Shape/BoxShape.h"
 #include "Jolt/Physics/Collision/Shape/SphereShape.h"
@@ -30,12 +32,13 @@ PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 #include "Jolt/Physics/Character/Character.h"
 #include "Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h"
 #include "Jolt/Physics/Collision/CastResult.h"
+#include "Jolt/Physics/Collision/CollisionDispatch.h"
+#include "Jolt/Geometry/RayAABox.h"
 #include "Jolt/ConfigurationString.h"
 #include "libcuckoo/cuckoohash_map.hh"
 
 typedef libcuckoo::cuckoohash_map<FSkeletonKey, FBarrageKey> KeyToKey;
 
-typedef libcuckoo::cuckoohash_map<uint64_t, JPH::Ref<JPH::Shape>> BoundsToShape;
 typedef libcuckoo::cuckoohash_map<FBarrageKey, JPH::BodyID> KeyToBody;
 // Disable common warnings triggered by Jolt, you can use JPH_SUPPRESS_WARNING_PUSH / JPH_SUPPRESS_WARNING_POP to store and restore the warning state
 JPH_SUPPRESS_WARNINGS
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "IsolatedJoltIncludes.h"
+
+class UStaticMesh;
+class UBodySetup;
+
+//converting chaos trimeshes into jolt mesh shapes is slow, and we were doing it once per placed instance.
+//cooked shapes are shared per mesh asset and scale, so every instance of a rock points at the same ShapeRefC.
+//scale is rounded to 1/ScaleQuantum and the shape is built from the rounded scale, so which instance asked first
+//never changes the shape anyone gets.
+//the unscaled cook also goes to Saved/Barrage/MeshShapes in jolt's binary shape format, so later loads skip the
+//conversion entirely. files are named by body setup guid, and recooking collision in the editor gives a new guid.
+class BARRAGE_API FBMeshShapeCache
+{
+public:
+	explicit FBMeshShapeCache(bool bInPersistToDisk = true);
+
+	//null if the mesh has no usable complex collision. safe from any thread, but cooking holds the cache lock.
+	JPH::ShapeRefC FindOrCook(const UStaticMesh* Mesh, JPH::Vec3Arg Scale);
+	//the same, with the unscaled shape coming from Cook instead of the mesh's chaos collision. Cook only runs on a miss,
+	//under the cache lock.
+	JPH::ShapeRefC FindOrScale(FObjectKey Mesh, JPH::Vec3Arg Scale, TFunctionRef<JPH::ShapeRefC()> Cook);
+	//scaled and unscaled both.
+	int32 Num() const;
+	void Empty();
+	//drops every shape nothing outside the cache holds anymore. returns how many went.
+	//this also happens on its own whenever a cook takes the cache past SoftLimit.
+	int32 TrimUnused();
+
+	//jolt's binary shape stream with a small header of ours in front, so a jolt upgrade or a format change on our side
+	//just reads as a cache miss.
+	static void SaveShape(const JPH::Shape& Shape, TArray<uint8>& OutBytes);
+	static JPH::ShapeRefC LoadShape(const TArray<uint8>& Bytes);
+
+private:
+	static constexpr uint32 CacheMagic = 0x534D4A42; //BJMS
+	static constexpr uint32 CacheVersion = 1;
+	//scales closer together than this share a shape.
+	static constexpr double ScaleQuantum = 10000.0;
+	static constexpr int32 SoftLimit = 1024;
+
+	struct FScaledKey
+	{
+		FObjectKey Mesh;
+		FIntVector Scale;
+
+		bool operator==(const FScaledKey& Other) const
+		{
+			return Mesh == Other.Mesh && Scale == Other.Scale;
+		}
+
+		friend uint32 GetTypeHash(const FScaledKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.Mesh), GetTypeHash(Key.Scale));
+		}
+	};
+
+	//from disk if it's there, from chaos and then to disk if not.
+	JPH::ShapeRefC CookUnscaled(const UStaticMesh* Mesh, const UBodySetup* Body) const;
+	int32 TrimUnusedLocked();
+	static JPH::ShapeRefC CookFromChaos(const UBodySetup* Body);
+	static FString CachePathFor(const UStaticMesh* Mesh, const UBodySetup* Body);
+
+	bool bPersistToDisk;
+	mutable FCriticalSection CacheLock;
+	TMap<FObjectKey, JPH::ShapeRefC> Unscaled;
+	//never unit scale. that's just the entry in Unscaled.
+	TMap<FScaledKey, JPH::ShapeRefC> Scaled;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/CircularQueue.h"
+#include "FBPhysicsInput.h"
+#include <atomic>
+#include <thread>
+
+//StackUp used to apply inputs one at a time as they came off the feeds, taking a body lock for every one. a projectile
+//that gets its velocity set three times a tick paid for three locks and two wasted writes. now the feeds are drained
+//into one batch, sorted by body then action, and folded down so each body gets at most one input of each kind:
+//forces sum, and everything else is last one wins. the sort is stable, so "last" still means what it meant before.
+//
+//busy worker only. the arrays are kept between ticks, so this stops allocating once it's seen a big tick.
+class BARRAGE_API FBPhysicsInputBatch
+{
+public:
+	void Reset()
+	{
+		Inputs.Reset();
+		Bodies.Reset();
+		Distinct.Reset();
+	}
+	//takes everything the feed has. this is the consumer end, so only one thread may ever drain a given feed.
+	void Drain(TCircularQueue<FBPhysicsInput>& Feed)
+	{
+		FBPhysicsInput Input;
+		while (Feed.Dequeue(Input))
+		{
+			Inputs.Add(Input);
+		}
+	}
+	void Append(TArrayView<const FBPhysicsInput> More)
+	{
+		Inputs.Append(More.GetData(), More.Num());
+	}
+	//sorts and folds. off with barrage.Input.Coalesce 0, which applies everything in arrival order like it used to.
+	void Coalesce();
+	//looks up the body for each input, once per distinct target.
+	void Resolve(TFunctionRef<JPH::BodyID(FBarrageKey)> Find);
+
+	int32 Num() const
+	{
+		return Inputs.Num();
+	}
+	TArrayView<const FBPhysicsInput> GetInputs() const
+	{
+		return Inputs;
+	}
+	//parallel to GetInputs after Resolve. invalid where the target has no body.
+	TArrayView<const JPH::BodyID> GetBodies() const
+	{
+		return Bodies;
+	}
+	//each valid body once, for locking.
+	TArrayView<const JPH::BodyID> GetDistinctBodies() const
+	{
+		return Distinct;
+	}
+
+private:
+	enum class EFold : uint8
+	{
+		Keep,
+		Sum,
+		LastWins
+	};
+	static EFold HowToFold(PhysicsInputType Action);
+
+	TArray<FBPhysicsInput> Inputs;
+	TArray<JPH::BodyID> Bodies;
+	TArray<JPH::BodyID> Distinct;
+};
+
+static constexpr int32 NUM_PHYSICS_INPUT_TYPES = PhysicsInputType::Throttle + 1;
+
+struct FBPhysicsInputStats
+{
+	//taken off the feeds, and what was left of them after coalescing.
+	uint64 Drained = 0;
+	uint64 Applied = 0;
+	//enqueues that found their feed full and had to wait for room.
+	uint64 Waited = 0;
+	uint64 Dropped = 0;
+	uint64 DroppedByType[NUM_PHYSICS_INPUT_TYPES] = {};
+};
+
+//each feed is a fixed 8192 deep, and Enqueue on a full one used to just return false into the void. the input was gone
+//and nobody knew. every enqueue comes through here now, and a full feed either drops the new input or waits a little
+//for the busy worker to make room, per barrage.Input.OverflowPolicy. either way, it's counted.
+//
+//Enqueue and GetStats are safe from any thread. NoteDrained is busy worker only.
+class BARRAGE_API FBPhysicsInputPressure
+{
+public:
+	enum class EOverflow : int32
+	{
+		//drop the new input. the old behavior, but counted.
+		Drop = 0,
+		//spin for up to barrage.Input.OverflowWaitMs, then drop.
+		Wait = 1
+	};
+
+	//false if the input was dropped.
+	bool Enqueue(TCircularQueue<FBPhysicsInput>& Feed, const FBPhysicsInput& Input);
+	void NoteDrained(uint64 Drained, uint64 Applied);
+	FBPhysicsInputStats GetStats() const;
+
+private:
+	void NoteDropped(PhysicsInputType Action);
+
+	std::atomic<uint64> Drained{0};
+	std::atomic<uint64> Applied{0};
+	std::atomic<uint64> Waited{0};
+	std::atomic<uint64> DroppedByType[NUM_PHYSICS_INPUT_TYPES] = {};
+	std::atomic<uint64> LastWarnedAt{0};
+	//waiting on ourselves would just burn the whole timeout, so the draining thread never waits.
+	std::atomic<std::thread::id> Drainer{std::thread::id()};
+};
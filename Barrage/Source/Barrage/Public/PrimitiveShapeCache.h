@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IsolatedJoltIncludes.h"
+
+//every box, sphere and capsule used to get its own jolt shape, and projectiles spawn thousands of identical boxes.
+//shapes are immutable once made, so bodies with the same dimensions can all point at one. this interns them by kind,
+//quantized dimensions and offset.
+//
+//jolt shapes are refcounted, and every body using one holds a ref. the cache holds one more, so a shape whose count
+//has dropped to one is held by nothing but us, and EvictUnused lets it go.
+class BARRAGE_API FBPrimitiveShapeCache
+{
+public:
+	//dimensions closer together than a tenth of a millimeter share a shape. it's built from the rounded dimensions, not
+	//whichever caller missed first, so the shape a body gets doesn't depend on spawn order.
+	static constexpr double Quantum = 10000.0;
+
+	//safe from any thread.
+	JPH::ShapeRefC FindOrCreateBox(JPH::Vec3Arg HalfExtent, float ConvexRadius, JPH::Vec3Arg Offset);
+	JPH::ShapeRefC FindOrCreateSphere(float Radius);
+	JPH::ShapeRefC FindOrCreateCapsule(float HalfHeightOfCylinder, float Radius);
+
+	//drops every shape no body is using. locks the whole table while it runs, so call it occasionally, not per tick.
+	int32 EvictUnused();
+	int32 Num() const
+	{
+		return static_cast<int32>(Shapes.size());
+	}
+
+private:
+	enum class EKind : uint8
+	{
+		Box,
+		Sphere,
+		Capsule
+	};
+
+	struct FShapeKey
+	{
+		EKind Kind = EKind::Box;
+		FIntVector Dimensions = FIntVector::ZeroValue;
+		FIntVector Offset = FIntVector::ZeroValue;
+		int32 ConvexRadius = 0;
+
+		bool operator==(const FShapeKey& Other) const
+		{
+			return Kind == Other.Kind && Dimensions == Other.Dimensions && Offset == Other.Offset
+				&& ConvexRadius == Other.ConvexRadius;
+		}
+	};
+
+	struct FShapeKeyHasher
+	{
+		std::size_t operator()(const FShapeKey& Key) const noexcept
+		{
+			return HashCombineFast(HashCombineFast(GetTypeHash(Key.Dimensions), GetTypeHash(Key.Offset)),
+			                       HashCombineFast(GetTypeHash(Key.ConvexRadius), static_cast<uint32>(Key.Kind)));
+		}
+	};
+
+	static int32 Quantize(float Value)
+	{
+		return FMath::RoundToInt32(Value * Quantum);
+	}
+	static FIntVector Quantize(JPH::Vec3Arg Value)
+	{
+		return FIntVector(Quantize(Value.GetX()), Quantize(Value.GetY()), Quantize(Value.GetZ()));
+	}
+	static float Dequantize(int32 Value)
+	{
+		return static_cast<float>(Value / Quantum);
+	}
+	static JPH::Vec3 Dequantize(const FIntVector& Value)
+	{
+		return JPH::Vec3(Dequantize(Value.X), Dequantize(Value.Y), Dequantize(Value.Z));
+	}
+
+	JPH::ShapeRefC FindOrCreate(const FShapeKey& Key, TFunctionRef<JPH::ShapeRefC()> Create);
+
+	libcuckoo::cuckoohash_map<FShapeKey, JPH::ShapeRefC, FShapeKeyHasher> Shapes;
+};
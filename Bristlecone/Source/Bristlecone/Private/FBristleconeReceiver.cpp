@@ -23,7 +23,12 @@ FBristleconeReceiver::~FBristleconeReceiver() {
 }
 
 void FBristleconeReceiver::SetLocalSocket(const TSharedPtr<FSocket, ESPMode::ThreadSafe>& new_socket) {
-	receiver_socket = new_socket;
+	receiver_sockets.Reset();
+	receiver_sockets.Add(new_socket);
+}
+
+void FBristleconeReceiver::SetLocalSockets(const TArray<TSharedPtr<FSocket, ESPMode::ThreadSafe>>& new_sockets) {
+	receiver_sockets = new_sockets;
 }
 
 bool FBristleconeReceiver::Init() {
@@ -37,7 +42,6 @@ bool FBristleconeReceiver::Init() {
 
 uint32 FBristleconeReceiver::Run() {
 	UE_LOG(LogTemp, Display, TEXT("Bristlecone:Receiver: Running receiver thread"));
-	const TSharedRef<FInternetAddr> targetAddr = socket_subsystem->CreateInternetAddr();
 	FString localNID = FGenericPlatformMisc::GetLoginId();
 
 	//if you use a system like this, the reflector will need the unhashed ids AND the session id.
@@ -48,23 +52,22 @@ uint32 FBristleconeReceiver::Run() {
 	//first K binary digits to help remove jitter's effect.
 	uint32_t ThinHash = FTextLocalizationResource::HashString(localNID, TheCone::DummyGetBristleconeSessionID());
 	MySeen = TheCone::CycleTracking(ThinHash);
-	const FTimespan Period(100000); //we wait 10ms at a stop. we don't have anything to do while we aren't waiting, but I don't trust it.
-	while (running && receiver_socket) {
-		TheCone::Packet_tpl receiving_state;
-	
-		uint32 socket_data_size;
-		while (receiver_socket.IsValid() && receiver_socket->HasPendingData(socket_data_size)) {
-			int32 bytes_read = 0;
-
-			received_data.SetNumUninitialized(FMath::Min(socket_data_size, 65507u));
-			receiver_socket->RecvFrom(received_data.GetData(), received_data.Num(), bytes_read, *targetAddr);
-
-			memcpy(&receiving_state, received_data.GetData(), bytes_read);
+	//this is only how often we look up to see if we've been stopped. packets wake us the moment they land.
+	const FTimespan Period(100000);
+	SocketDrain.SetSockets(receiver_sockets);
+	while (running && SocketDrain.HasSockets()) {
+		if (!SocketDrain.WaitForReadable(Period))
+		{
+			continue;
+		}
+		for (const TheCone::Packet_tpl& receiving_state : SocketDrain.Drain())
+		{
 			//this & logging are VERY slow, like potentially reordering our perceived timings slow. We need to be careful as hell interacting
 			//with time and logging, since we're now operating in the lock-sensitive time regime. we'll need a solution.
 			const uint64_t cycle = receiving_state.GetCycleMeta();
 			//we keep a mask of the 64 cycles before the highest seen to make sure we don't emit more than once.
 			//if it's higher, we slide forwards and don't need to check the mask. That's handled in the BitTracker
+			//with the clones spread over three sockets, this is also where the copies from the other two get dropped.
 			if (!MySeen.Update(cycle))
 			{
 				continue;
@@ -75,14 +78,11 @@ uint32 FBristleconeReceiver::Run() {
 				TheCone::CycleTimestamp v = TheCone::CycleTimestamp(lsbTime - receiving_state.GetTransferTime(), receiving_state.GetCycleMeta());
 				PacketStats->Enqueue(v); // p sure this doesn't leak memory? @Eliza, TODO: please sanity check me?
 			}
-			Queue.Get()->Enqueue(receiving_state);//this actually provokes a copy, which can be removed, I think, by not doing the mcpy
-			
-
+			Queue.Get()->Enqueue(receiving_state);
 		}
-	
-		receiver_socket.IsValid() ? receiver_socket.Get()->Wait(ESocketWaitConditions::WaitForRead, Period) : 0;
 	}
-	receiver_socket = nullptr;//revise this, it's not super safe even with threadsafe smart pointers, but it'll hold for now.
+	SocketDrain.SetSockets({});
+	receiver_sockets.Reset();//revise this, it's not super safe even with threadsafe smart pointers, but it'll hold for now.
 	return 0;
 }
 
@@ -0,0 +1,146 @@
+﻿#include "FBristleconeSocketDrain.h"
+
+//same shading as the sender. these stay out of the header.
+#if PLATFORM_HAS_BSD_SOCKET_FEATURE_WINSOCKETS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+typedef int32 SOCKLEN;
+
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+#include <Runtime/Sockets/Private/BSDSockets/SocketsBSD.h>
+#include "SocketSubsystem.h"
+
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+#define BRISTLECONE_HAS_RECVMMSG 1
+#else
+#define BRISTLECONE_HAS_RECVMMSG 0
+#endif
+
+FBristleconeSocketDrain::FBristleconeSocketDrain()
+{
+	//one spare on the end, so a read into the last slot has room to run a byte over.
+	Slots.SetNum(MaxBatch + 1);
+}
+
+void FBristleconeSocketDrain::SetSockets(const TArray<SocketPtr>& NewSockets)
+{
+	Sockets.Reset();
+	for (const SocketPtr& Socket : NewSockets)
+	{
+		//the three priority sockets can end up being the same one during debug. don't wait on it twice.
+		if (Socket.IsValid() && !Sockets.Contains(Socket))
+		{
+			Sockets.Add(Socket);
+		}
+	}
+}
+
+bool FBristleconeSocketDrain::WaitForReadable(const FTimespan& Timeout)
+{
+	if (Sockets.IsEmpty())
+	{
+		return false;
+	}
+	const int TimeoutMs = static_cast<int>(Timeout.GetTotalMilliseconds());
+#if PLATFORM_HAS_BSD_SOCKET_FEATURE_WINSOCKETS
+	WSAPOLLFD Polling[8];
+	const int32 Count = FMath::Min(Sockets.Num(), 8);
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Polling[i].fd = static_cast<FSocketBSD*>(Sockets[i].Get())->GetNativeSocket();
+		Polling[i].events = POLLRDNORM;
+		Polling[i].revents = 0;
+	}
+	return WSAPoll(Polling, Count, TimeoutMs) > 0;
+#else
+	pollfd Polling[8];
+	const int32 Count = FMath::Min(Sockets.Num(), 8);
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Polling[i].fd = static_cast<FSocketBSD*>(Sockets[i].Get())->GetNativeSocket();
+		Polling[i].events = POLLIN;
+		Polling[i].revents = 0;
+	}
+	return poll(Polling, Count, TimeoutMs) > 0;
+#endif
+}
+
+TArrayView<const TheCone::Packet_tpl> FBristleconeSocketDrain::Drain()
+{
+	int32 Filled = 0;
+	for (const SocketPtr& Socket : Sockets)
+	{
+		if (Filled >= MaxBatch)
+		{
+			break;
+		}
+		Filled += DrainSocket(Socket.Get(), Filled);
+	}
+	return TArrayView<const TheCone::Packet_tpl>(Slots.GetData(), Filled);
+}
+
+int32 FBristleconeSocketDrain::DrainSocket(FSocket* Socket, int32 FirstSlot)
+{
+	constexpr int32 PacketBytes = sizeof(TheCone::Packet_tpl);
+	const int32 Room = MaxBatch - FirstSlot;
+	int32 Kept = 0;
+#if BRISTLECONE_HAS_RECVMMSG
+	//the iovecs are one byte longer than a packet so anything bigger than a packet comes back truncated, which we can see.
+	uint8 Overflow[MaxBatch];
+	iovec Vectors[MaxBatch * 2];
+	mmsghdr Headers[MaxBatch];
+	FMemory::Memzero(Headers, sizeof(mmsghdr) * Room);
+	for (int32 i = 0; i < Room; ++i)
+	{
+		Vectors[i * 2].iov_base = &Slots[FirstSlot + i];
+		Vectors[i * 2].iov_len = PacketBytes;
+		Vectors[i * 2 + 1].iov_base = &Overflow[i];
+		Vectors[i * 2 + 1].iov_len = 1;
+		Headers[i].msg_hdr.msg_iov = &Vectors[i * 2];
+		Headers[i].msg_hdr.msg_iovlen = 2;
+	}
+	const int Received = recvmmsg(static_cast<FSocketBSD*>(Socket)->GetNativeSocket(), Headers, Room, MSG_DONTWAIT, nullptr);
+	for (int i = 0; i < Received; ++i)
+	{
+		if (Headers[i].msg_len == PacketBytes && !(Headers[i].msg_hdr.msg_flags & MSG_TRUNC))
+		{
+			//compact down over anything we threw away. nothing to move most of the time.
+			if (Kept != i)
+			{
+				Slots[FirstSlot + Kept] = Slots[FirstSlot + i];
+			}
+			++Kept;
+		}
+	}
+#else
+	//pending is everything queued on the socket, not the size of the next datagram, so it can't tell us what's ours.
+	//like the recvmmsg path, read one byte past a packet and go by what actually came back. the byte over lands in the
+	//next slot, which is either unused or about to be overwritten.
+	uint32 Pending = 0;
+	while (Kept < Room && Socket->HasPendingData(Pending))
+	{
+		int32 BytesRead = 0;
+		if (!Socket->Recv(reinterpret_cast<uint8*>(&Slots[FirstSlot + Kept]), PacketBytes + 1, BytesRead))
+		{
+			//winsock won't truncate a datagram that doesn't fit. it drops it and says so, and we move on to the next.
+			if (ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() == SE_EMSGSIZE)
+			{
+				continue;
+			}
+			break;
+		}
+		if (BytesRead == PacketBytes)
+		{
+			++Kept;
+		}
+	}
+#endif
+	return Kept;
+}
@@ -0,0 +1,90 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "FBristleconeSocketDrain.h"
+#include "Common/UdpSocketBuilder.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "SocketSubsystem.h"
+
+namespace BristleconeSocketDrainTest
+{
+	typedef FBristleconeSocketDrain::SocketPtr SocketPtr;
+
+	static bool SendBytes(FSocket& From, const FInternetAddr& To, const uint8* Bytes, int32 Count)
+	{
+		int32 Sent = 0;
+		return From.SendTo(Bytes, Count, Sent, To) && Sent == Count;
+	}
+
+	static bool SendPacket(FSocket& From, const FInternetAddr& To, long Tag)
+	{
+		TheCone::Packet_tpl Packet;
+		Packet.UpdateCycleOrMeta(Tag);
+		return SendBytes(From, To, reinterpret_cast<const uint8*>(&Packet), sizeof(Packet));
+	}
+}
+
+//loopback only. a full packet, one too big, one too short, then another full one. the drain should hand back exactly
+//the two full ones, in order, whatever the platform's read path is.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBristleconeSocketDrainLoopback, "Bristlecone.SocketDrain.Loopback",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FBristleconeSocketDrainLoopback::RunTest(const FString& Parameters)
+{
+	using namespace BristleconeSocketDrainTest;
+	constexpr int32 PacketBytes = sizeof(TheCone::Packet_tpl);
+
+	SocketPtr Receiver = MakeShareable(FUdpSocketBuilder(TEXT("Bristlecone.Test.Receiver"))
+	                                   .AsNonBlocking()
+	                                   .BoundToEndpoint(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), 0))
+	                                   .WithReceiveBufferSize(PacketBytes * 64)
+	                                   .Build());
+	SocketPtr Sender = MakeShareable(FUdpSocketBuilder(TEXT("Bristlecone.Test.Sender")).AsNonBlocking().Build());
+	if (!TestTrue(TEXT("loopback sockets open"), Receiver.IsValid() && Sender.IsValid()))
+	{
+		return false;
+	}
+	const TSharedRef<FInternetAddr> To = FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), Receiver->GetPortNo()).ToInternetAddr();
+
+	uint8 Junk[PacketBytes + 32];
+	FMemory::Memset(Junk, 0xAB, sizeof(Junk));
+	TestTrue(TEXT("sent first packet"), SendPacket(*Sender, *To, 1));
+	TestTrue(TEXT("sent oversize datagram"), SendBytes(*Sender, *To, Junk, sizeof(Junk)));
+	TestTrue(TEXT("sent short datagram"), SendBytes(*Sender, *To, Junk, PacketBytes / 2));
+	TestTrue(TEXT("sent second packet"), SendPacket(*Sender, *To, 2));
+
+	FBristleconeSocketDrain Drain;
+	Drain.SetSockets({Receiver});
+	TArray<long> Tags;
+	const double GiveUpAt = FPlatformTime::Seconds() + 2.0;
+	while (Tags.Num() < 2 && FPlatformTime::Seconds() < GiveUpAt)
+	{
+		if (Drain.WaitForReadable(FTimespan::FromMilliseconds(100)))
+		{
+			for (const TheCone::Packet_tpl& Packet : Drain.Drain())
+			{
+				Tags.Add(Packet.GetCycleMeta());
+			}
+		}
+	}
+	//anything else that was still on its way would have shown up by now.
+	if (Drain.WaitForReadable(FTimespan::FromMilliseconds(50)))
+	{
+		for (const TheCone::Packet_tpl& Packet : Drain.Drain())
+		{
+			Tags.Add(Packet.GetCycleMeta());
+		}
+	}
+
+	TestEqual(TEXT("only the two full packets come back"), Tags.Num(), 2);
+	if (Tags.Num() == 2)
+	{
+		TestEqual(TEXT("first packet first"), static_cast<int64>(Tags[0]), 1ll);
+		TestEqual(TEXT("second packet second"), static_cast<int64>(Tags[1]), 2ll);
+	}
+	Drain.SetSockets({});
+	return true;
+}
+
+#endif
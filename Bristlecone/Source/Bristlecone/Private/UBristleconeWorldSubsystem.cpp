@@ -82,7 +82,7 @@ bool UBristleconeWorldSubsystem::RegistrationImplementation()
 	ReceiveTimes = MakeShareable(new TimestampQ(140));
 	receiver_runner.BindStatsSink(ReceiveTimes);
 	receiver_runner.LogOnReceive = LogOnReceive;
-	receiver_runner.SetLocalSocket(socketHigh);
+	receiver_runner.SetLocalSockets({socketHigh, socketLow, socketBackground});
 	receiver_runner.BindSink(QueueOfReceived);
 
 	receiver_thread.Reset(FRunnableThread::Create(&receiver_runner, TEXT("Bristlecone.Receiver")));
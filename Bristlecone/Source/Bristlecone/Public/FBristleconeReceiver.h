@@ -6,6 +6,7 @@
 #include "SocketSubsystem.h"
 #include "Common/UdpSocketBuilder.h"
 #include "BristleconeCommonTypes.h"
+#include "FBristleconeSocketDrain.h"
 
 class FBristleconeReceiver : public FRunnable {
 public:
@@ -16,6 +17,8 @@ public:
 	virtual ~FBristleconeReceiver() override;
 
 	void SetLocalSocket(const TSharedPtr<FSocket, ESPMode::ThreadSafe>& new_socket);
+	//waits on all of these at once. clones come in across every priority, so listening to just one loses redundancy.
+	void SetLocalSockets(const TArray<TSharedPtr<FSocket, ESPMode::ThreadSafe>>& new_sockets);
 	
 	virtual bool Init() override;
 	virtual uint32 Run() override;
@@ -30,8 +33,8 @@ private:
 	void Cleanup();
 	int64 SeenCycles;
 	int64 HighestSeen;
-	TSharedPtr<FSocket, ESPMode::ThreadSafe> receiver_socket;
-	TArray<uint8> received_data;
+	TArray<TSharedPtr<FSocket, ESPMode::ThreadSafe>> receiver_sockets;
+	FBristleconeSocketDrain SocketDrain;
 	TheCone::RecvQueue Queue;
 	TheCone::TimestampQueue PacketStats;
 	TheCone::CycleTracking MySeen;
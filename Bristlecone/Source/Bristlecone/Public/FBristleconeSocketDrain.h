@@ -0,0 +1,32 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "Sockets.h"
+#include "BristleconeCommonTypes.h"
+
+//waits on every receive socket at once and pulls packets off them in batches, straight into slots that live as long
+//as the drain does. on linux that's one recvmmsg per socket per wake, elsewhere it's a RecvFrom per packet but still
+//with no staging buffer or extra copy. only the receiver thread should touch one of these.
+class FBristleconeSocketDrain
+{
+public:
+	typedef TSharedPtr<FSocket, ESPMode::ThreadSafe> SocketPtr;
+	static constexpr int32 MaxBatch = 64;
+
+	FBristleconeSocketDrain();
+
+	void SetSockets(const TArray<SocketPtr>& NewSockets);
+	bool HasSockets() const { return !Sockets.IsEmpty(); }
+
+	//blocks until any socket has something to read, or Timeout passes. returns false on timeout.
+	bool WaitForReadable(const FTimespan& Timeout);
+
+	//reads whatever is already waiting, up to MaxBatch packets. only full-size packets are kept, anything else is
+	//dropped on the floor. the result points into slots that get reused on the next call.
+	TArrayView<const TheCone::Packet_tpl> Drain();
+
+private:
+	int32 DrainSocket(FSocket* Socket, int32 FirstSlot);
+
+	TArray<SocketPtr> Sockets;
+	TArray<TheCone::Packet_tpl> Slots;
+};
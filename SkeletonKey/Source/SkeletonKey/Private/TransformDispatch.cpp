@@ -7,6 +7,7 @@
 UTransformDispatch::UTransformDispatch()
 {
 	ObjectToTransformMapping = MakeShareable(new KineLookup());
+	SwarmManagersWithPendingMoves = MakeShareable(new FSwarmKinePendingManagers());
 }
 
 UTransformDispatch::~UTransformDispatch()
@@ -30,7 +31,7 @@ void UTransformDispatch::RegisterSceneCompToShadowTransform(FBoneKey Target,
 void UTransformDispatch::RegisterObjectToShadowTransform(FSkeletonKey Target, USwarmKineManager* Manager) const
 {
 	//explicitly cast to parent type.
-	TSharedPtr<Kine> kine = MakeShareable<SwarmKine>(new SwarmKine(Manager, Target));
+	TSharedPtr<Kine> kine = MakeShareable<SwarmKine>(new SwarmKine(Manager, Target, SwarmManagersWithPendingMoves));
 	ObjectToTransformMapping->insert_or_assign(Target, kine);
 }
 
@@ -15,6 +15,9 @@ THIRD_PARTY_INCLUDES_END
 #include "SwarmKine.generated.h"
 
 class UObject;
+class USwarmKineManager;
+//managers with moves queued since their last flush. each transform dispatch keeps its own.
+typedef TArray<TWeakObjectPtr<USwarmKineManager>> FSwarmKinePendingManagers;
 
 //interface that adds support for owning swarm kines. used for managing many many meshes at a time.
 //generally, 
@@ -68,6 +71,60 @@ public:
 		return false;
 	};
 	
+	//game thread only. holds the move until FlushPendingTransforms, so a frame's worth of updates goes to the ISM in
+	//a handful of batched calls with one render state dirty, rather than one update per instance.
+	//repeat moves of the same instance in a frame just overwrite each other. the first move since a flush puts us on
+	//Pending, which whoever's queuing is expected to flush.
+	bool QueueLocationAndRotation(FSkeletonKey Target, FVector3d Loc, FQuat4d Rot, FSwarmKinePendingManagers& Pending)
+	{
+		int32 m;
+		if (!KeyToMesh->find(Target, m))
+		{
+			return false;
+		}
+		if (!KeyToSceneComponent->IsEmpty())
+		{
+			TObjectPtr<USceneComponent> OptionalLinkedComponent = KeyToSceneComponent->FindRef(Target);
+			if (OptionalLinkedComponent && OptionalLinkedComponent.Get())
+			{
+				OptionalLinkedComponent->SetWorldLocationAndRotationNoPhysics(Loc, Rot.Rotator());
+			}
+		}
+		if (PendingMoves.IsEmpty())
+		{
+			//we may still be on the list if our own tick flushed us first.
+			Pending.AddUnique(this);
+		}
+		int32& Slot = PendingSlotById.FindOrAdd(m, INDEX_NONE);
+		if (Slot == INDEX_NONE)
+		{
+			Slot = PendingMoves.Add({m, Loc, Rot});
+		}
+		else
+		{
+			PendingMoves[Slot].Location = Loc;
+			PendingMoves[Slot].Rotation = Rot;
+		}
+		return true;
+	}
+
+	//pushes everything queued by QueueLocationAndRotation. instances removed since they were queued are skipped.
+	void FlushPendingTransforms();
+
+	//flushes every manager on Pending and empties it. game thread only.
+	static void FlushAllPendingTransforms(FSwarmKinePendingManagers& Pending)
+	{
+		FSwarmKinePendingManagers Flushing = MoveTemp(Pending);
+		Pending.Reset();
+		for (TWeakObjectPtr<USwarmKineManager>& Manager : Flushing)
+		{
+			if (USwarmKineManager* Pin = Manager.Get())
+			{
+				Pin->FlushPendingTransforms();
+			}
+		}
+	}
+
 	virtual FSkeletonKey GetKeyOfInstance(FPrimitiveInstanceId Target)
 	{
 		FSkeletonKey m;
@@ -135,6 +192,8 @@ public:
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override
 	{
 		Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+		//normally already flushed by the transform dispatch, but removal below would strand anything left over.
+		FlushPendingTransforms();
 		int32 Key = 0;
 		while (ToRemove->Dequeue(Key))
 		{
@@ -145,6 +204,18 @@ public:
 	void BeginDestroy() override;
 
 private:
+	struct FPendingMove
+	{
+		IDTYPE Id;
+		FVector3d Location;
+		FQuat4d Rotation;
+	};
+	TArray<FPendingMove> PendingMoves;
+	TMap<IDTYPE, int32> PendingSlotById;
+	//scratch for the flush, kept around so it doesn't allocate every frame.
+	TArray<TPair<int32, int32>> FlushOrder;
+	TArray<FTransform> FlushRun;
+
 	TSharedPtr<LibCFSKInt> KeyToMesh;
 	TSharedPtr<LibCIntFSK> MeshToKey;
 	TSharedPtr<TMap<FSkeletonKey, TObjectPtr<USceneComponent>>> KeyToSceneComponent;
@@ -154,6 +225,56 @@ inline USwarmKineManager::~USwarmKineManager()
 {
 }
 
+inline void USwarmKineManager::FlushPendingTransforms()
+{
+	if (PendingMoves.IsEmpty())
+	{
+		return;
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Swarm Kine Flush");
+	//ids to current indices, then sorted so neighbouring instances go over in a single batch call.
+	FlushOrder.Reset();
+	for (int32 i = 0; i < PendingMoves.Num(); ++i)
+	{
+		const int32 Index = GetInstanceIndexForId(FPrimitiveInstanceId(PendingMoves[i].Id));
+		if (IsValidInstance(Index))
+		{
+			FlushOrder.Add({Index, i});
+		}
+	}
+	FlushOrder.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B) { return A.Key < B.Key; });
+
+	const FTransform& ComponentTransform = GetComponentTransform();
+	bool bApplied = false;
+	int32 RunStart = 0;
+	while (RunStart < FlushOrder.Num())
+	{
+		FlushRun.Reset();
+		int32 RunEnd = RunStart;
+		do
+		{
+			const FPendingMove& Move = PendingMoves[FlushOrder[RunEnd].Value];
+			//keep whatever scale the instance already has, same as a single SetLocationAndRotation would.
+			FTransform World = FTransform(PerInstanceSMData[FlushOrder[RunEnd].Key].Transform) * ComponentTransform;
+			World.SetLocation(Move.Location);
+			World.SetRotation(Move.Rotation);
+			FlushRun.Add(World);
+			++RunEnd;
+		}
+		while (RunEnd < FlushOrder.Num() && FlushOrder[RunEnd].Key == FlushOrder[RunEnd - 1].Key + 1);
+
+		bApplied |= BatchUpdateInstancesTransforms(FlushOrder[RunStart].Key, FlushRun, true, false, true);
+		RunStart = RunEnd;
+	}
+	PendingMoves.Reset();
+	PendingSlotById.Reset();
+	//a frame where every queued instance was removed before the flush changed nothing the renderer has.
+	if (bApplied)
+	{
+		MarkRenderStateDirty();
+	}
+}
+
 inline void USwarmKineManager::BeginDestroy()
 {
 	Super::BeginDestroy();
@@ -171,10 +292,13 @@ inline void USwarmKineManager::BeginDestroy()
 class SwarmKine : public Kine
 {
 	TWeakObjectPtr<USwarmKineManager> MyManager;
+	//the registering dispatch's list, shared so a kine that outlives it doesn't queue into freed memory.
+	TSharedPtr<FSwarmKinePendingManagers> PendingManagers;
 
 public:
-	explicit SwarmKine(const TWeakObjectPtr<USwarmKineManager>& MyManager, const FSkeletonKey& MeshInstanceKey)
-		: MyManager(MyManager)
+	explicit SwarmKine(const TWeakObjectPtr<USwarmKineManager>& MyManager, const FSkeletonKey& MeshInstanceKey,
+	                   const TSharedPtr<FSwarmKinePendingManagers>& PendingManagers)
+		: MyManager(MyManager), PendingManagers(PendingManagers)
 	{
 		MyKey  = MeshInstanceKey;
 	}
@@ -195,15 +319,10 @@ public:
 		}	
 	}
 
+	//the scoped path is the transform dispatch's bulk apply, which flushes the manager once it's done with the frame.
 	virtual void SetLocationAndRotationWithScope(FVector3d Loc, FQuat4d Rot) override
 	{
-		TOptional<FTransform> m = MyManager->GetTransformCopy(MyKey);
-		if(m.IsSet())
-		{
-			m->SetLocation(Loc);
-			m->SetRotation(Rot);
-			MyManager->SetTransformOnInstance(MyKey, m.GetValue());
-		}	
+		MyManager->QueueLocationAndRotation(MyKey, Loc, Rot, *PendingManagers);
 	};
 
 	virtual void SetLocation(FVector3d Location) override
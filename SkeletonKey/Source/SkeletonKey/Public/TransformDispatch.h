@@ -62,6 +62,8 @@ public:
 	//get partial record writes, but we ultimately need a way to make that safer than it is.
 	//TODO Can we get away from the actor ref? It's the last real barrier between us and true thread safety.
 	TSharedPtr<KineLookup> ObjectToTransformMapping;
+	//swarm managers that queued moves during ApplyTransformUpdates, flushed at the end of it. game thread only.
+	TSharedPtr<FSwarmKinePendingManagers> SwarmManagersWithPendingMoves;
 	void ReleaseKineByKey(FSkeletonKey Target);
 
 	//right now, this is only a helper method, but if we add the read-only copy in the kine itself, we could conceivably
@@ -117,10 +119,20 @@ bool UTransformDispatch::ApplyTransformUpdates(TransformQueuePTR TransformUpdate
 				}
 				catch (...)
 				{
+					if (!GetWorld()->bPostTickComponentUpdate)
+					{
+						USwarmKineManager::FlushAllPendingTransforms(*SwarmManagersWithPendingMoves);
+					}
 					return false; //we'll be back! we'll be back!!!!
 				}
 			}
 		}
+		//swarm kines queue their moves rather than touching the ISM one instance at a time.
+		//if we got cut off by the post tick update, the managers pick up the rest in their own tick.
+		if (!GetWorld()->bPostTickComponentUpdate)
+		{
+			USwarmKineManager::FlushAllPendingTransforms(*SwarmManagersWithPendingMoves);
+		}
 		return true;
 	}
 	return false;